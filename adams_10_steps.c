@@ -97,6 +97,10 @@ static int hasConverged(double y0, double y1, double epsilon);
 //                the solution y(x).                                          //
 //     int    iterations   The maximum number of iterations for allow for the //
 //                corrector to try to converge within the tolerance above.    //
+//                If tolerance = 0, exactly iterations corrections are made,  //
+//                for a fixed number of evaluations of f(x,y), and the value  //
+//                returned is then iterations + 1, as for a corrector which   //
+//                failed to converge.                                         //
 //                                                                            //
 //  Return Values:                                                            //
 //     The number of iterations performed during the Adams-Moulton correction.//
@@ -191,6 +195,10 @@ double Adams_Bashforth_12_Steps( double y, double h, double f_history[] ) {
 //                the solution y(x).                                          //
 //     int    iterations   The maximum number of iterations for allow for the //
 //                corrector to try to converge within the tolerance above.    //
+//                If tolerance = 0, exactly iterations corrections are made,  //
+//                for a fixed number of evaluations of f(x,y), and the value  //
+//                returned is then iterations + 1, as for a corrector which   //
+//                failed to converge.                                         //
 //                                                                            //
 //  Return Values:                                                            //
 //     The number of iterations performed.  The value of y(x) is stored in    //
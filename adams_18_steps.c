@@ -40,6 +40,14 @@
 //     more specifically, the method requires that f(x[i-k],y[i-k]), ... ,    //
 //     f(x[i],y[i]) are given as well as the initial estimate of y[i+1].      //
 //                                                                            //
+//     The coefficients of the 18 step formulas are integers of up to 21      //
+//     digits and of alternating sign whose sum, the divisor, is about 66000  //
+//     times smaller than the sum of their absolute values.                   //
+//     The sums of the coefficients times the history are therefore formed    //
+//     by a compensated dot product, see Compensated_Dot_Product() below,     //
+//     using the coefficients split exactly into a double and a remainder.    //
+//     Compile with -DADAMS_UNCOMPENSATED for the ordinary sums.              //
+//                                                                            //
 ////////////////////////////////////////////////////////////////////////////////
 #include <math.h>
 
@@ -59,6 +67,17 @@ static const double moulton[] = { 15980174332775873.0, 114329243705491117.0,
       -170761422500096220.0, 31816981024600492.0, -3722582669836627.0,
        205804074290625.0 };
 
+               // The coefficients above are integers which are not   //
+               // all representable as doubles, the remainders are:   //
+
+static const double bashforth_lo[] = { -1.0, -173.0, -428.0, -3876.0, 6192.0,
+   -11448.0, 27956.0, 796.0, 41334.0, -52874.0, -1252.0, -6860.0, -5304.0,
+   -4048.0, 220.0, 84.0, -13.0, -1.0 };
+
+static const double moulton_lo[] = { 1.0, -3.0, -20.0, 36.0, -48.0, 184.0,
+   -308.0, -796.0, -374.0, -374.0, 228.0, 204.0, -72.0, -48.0, 4.0, 0.0, 0.0,
+   0.0 };
+
 static const double divisor = 1.0 / 64023737057280000.0;
 
 #define STEPS sizeof(bashforth)/sizeof(bashforth[0])
@@ -70,6 +89,9 @@ int Adams_Moulton_17_Steps( double (*f)(double, double), double y[], double x,
 
 static int hasConverged(double y0, double y1, double epsilon);
 
+static double Compensated_Dot_Product( const double hi[], const double lo[],
+                                                   const double v[], int m );
+
 ////////////////////////////////////////////////////////////////////////////////
 // int Adams_18_Steps( double (*f)(double, double), double y[], double x0,    //
 //      double h, double f_history[], double *y_bashforth,  double tolerance, //
@@ -106,6 +128,10 @@ static int hasConverged(double y0, double y1, double epsilon);
 //                the solution y(x).                                          //
 //     int    iterations   The maximum number of iterations for allow for the //
 //                corrector to try to converge within the tolerance above.    //
+//                If tolerance = 0, exactly iterations corrections are made,  //
+//                for a fixed number of evaluations of f(x,y), and the value  //
+//                returned is then iterations + 1, as for a corrector which   //
+//                failed to converge.                                         //
 //                                                                            //
 //  Return Values:                                                            //
 //     The number of iterations performed during the Adams-Moulton correction.//
@@ -160,13 +186,11 @@ int Adams_18_Steps( double (*f)(double, double), double y[], double x0,
 //                                                                            //
 double Adams_Bashforth_18_Steps( double y, double h, double f_history[] ) {
 
-   double delta = 0.0;
-   int i;
-   int n = STEPS - 1;
+   double delta;
 
           // Calculate the predictor using the Adams-Bashforth formula 
 
-   for (i = 0; i < STEPS; i++, n--) delta += bashforth[i] * f_history[n];
+   delta = Compensated_Dot_Product( bashforth, bashforth_lo, f_history, STEPS );
 
    return y + h * divisor * delta;
 }
@@ -200,6 +224,10 @@ double Adams_Bashforth_18_Steps( double y, double h, double f_history[] ) {
 //                the solution y(x).                                          //
 //     int    iterations   The maximum number of iterations for allow for the //
 //                corrector to try to converge within the tolerance above.    //
+//                If tolerance = 0, exactly iterations corrections are made,  //
+//                for a fixed number of evaluations of f(x,y), and the value  //
+//                returned is then iterations + 1, as for a corrector which   //
+//                failed to converge.                                         //
 //                                                                            //
 //  Return Values:                                                            //
 //     The number of iterations performed.  The value of y(x) is stored in    //
@@ -211,14 +239,13 @@ int Adams_Moulton_17_Steps( double (*f)(double, double), double y[], double x,
              double h, double f_history[], double tolerance, int iterations ) {
 
    double old_estimate;
-   double delta = 0.0;
+   double delta;
    int i;
-   int n = STEPS - 2;
-   int converged = -1;
 
           // Calculate the corrector using the Adams-Moulton formula 
    
-   for (i = 1; i < STEPS; i++, n--) delta += moulton[i] * f_history[n];
+   delta = Compensated_Dot_Product( moulton + 1, moulton_lo + 1, f_history,
+                                                                  STEPS - 1 );
 
    for (i = 0; i < iterations; i++) {
       old_estimate = y[1];
@@ -296,3 +323,60 @@ static int hasConverged(double y0, double y1, double epsilon) {
    if ( fabs(y0 - y1) < epsilon ) return 1;
    return 0;
 }
+
+
+////////////////////////////////////////////////////////////////////////////////
+// static double Compensated_Dot_Product( const double hi[],                  //
+//                          const double lo[], const double v[], int m )      //
+//                                                                            //
+//  Description:                                                              //
+//     This function returns the sum of (hi[i] + lo[i]) * v[m-1-i] for        //
+//     i = 0,..., m-1, i.e. the coefficients are applied to the history in    //
+//     reverse order, as accurately as if it were computed in twice the       //
+//     working precision and then rounded.  The product hi[i] * v[.] is split //
+//     exactly into its rounded value and its error by a fused multiply-add   //
+//     (TwoProd), the running sum is split into its rounded value and its     //
+//     error by Knuth's TwoSum, and the errors, together with the products of //
+//     the remainders lo[i], are accumulated separately and added at the end  //
+//     (Ogita, Rump and Oishi's Dot2).  The Adams coefficients are large      //
+//     integers of alternating sign whose sum is the much smaller divisor, so //
+//     that the ordinary sum loses about log10(sum |coefficients| / divisor)  //
+//     digits to cancellation.                                                //
+//                                                                            //
+//     Note!  This function must not be compiled with -ffast-math or any      //
+//     other option permitting the compiler to reassociate floating point     //
+//     operations.                                                            //
+//                                                                            //
+//  Arguments:                                                                //
+//     const double hi[]  The coefficients rounded to double.                 //
+//     const double lo[]  The remainders, coefficient - hi[i], exactly.       //
+//     const double v[]   The history.                                        //
+//     int    m           The number of terms.                                //
+//                                                                            //
+//  Return Values:                                                            //
+//     The sum of products described above.                                   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static double Compensated_Dot_Product( const double hi[], const double lo[],
+                                                   const double v[], int m ) {
+
+   double sum = 0.0, error = 0.0;
+   double x, product, t, z;
+   int i;
+
+#ifdef ADAMS_UNCOMPENSATED
+   for (i = 0; i < m; i++) sum += hi[i] * v[m - 1 - i];
+#else
+   for (i = 0; i < m; i++) {
+      x = v[m - 1 - i];
+      product = hi[i] * x;
+      error += fma( hi[i], x, -product ) + lo[i] * x;
+      t = sum + product;
+      z = t - sum;
+      error += (sum - (t - z)) + (product - z);
+      sum = t;
+   }
+#endif
+   return sum + error;
+}
@@ -5,6 +5,8 @@
 //    Adams_Bashforth_20_Steps                                                //
 //    Adams_Moulton_19_Steps                                                  //
 //    Adams_20_Build_History                                                  //
+//    Adams_Bashforth_20_Steps_System                                         //
+//    Adams_Moulton_19_Steps_System                                           //
 ////////////////////////////////////////////////////////////////////////////////
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -40,6 +42,14 @@
 //     more specifically, the method requires that f(x[i-k],y[i-k]), ... ,    //
 //     f(x[i],y[i]) are given as well as the initial estimate of y[i+1].      //
 //                                                                            //
+//     The coefficients of the 20 step formulas are integers of up to 25      //
+//     digits and of alternating sign whose sum, the divisor, is about 260000 //
+//     times smaller than the sum of their absolute values.  The sums of the  //
+//     coefficients times the history are therefore formed by a compensated   //
+//     dot product, see Compensated_Dot_Product() below, using the            //
+//     coefficients split exactly into a double and a remainder.  Compile     //
+//     with -DADAMS_UNCOMPENSATED for the ordinary sums.                      //
+//                                                                            //
 ////////////////////////////////////////////////////////////////////////////////
 #include <math.h>
 
@@ -67,15 +77,39 @@ static const double moulton[] = { 24919383499187492303.0,
         53935307402575440285.0, -5652892248087175675.0,
         281550972898020815.0 }; 
 
+               // The coefficients above are integers which are not   //
+               // all representable as doubles, the remainders are:   //
+
+static const double bashforth_lo[] = { 59953.0, -507397.0, -1298845.0,
+        7767913.0, 27703796.0, -36532612.0, -122094484.0, -98619964.0,
+        248018350.0, 37369274.0, 267269562.0, 188511662.0, 128134596.0,
+        57736300.0, -19231108.0, 1751540.0, 427881.0, -119197.0, 16891.0,
+        -1487.0 };
+
+static const double moulton_lo[] = { 1487.0, 13829.0, 29085.0, -61289.0,
+        -244212.0, 913796.0, 33684.0, -2289092.0, -751022.0, 2882118.0,
+        -2520506.0, 1161810.0, 1167932.0, 476052.0, -69244.0, 116236.0,
+        30871.0, 2461.0, -507.0, 15.0 };
+
 static const double divisor = 1.0 / 102181884343418880000.0;
 
 #define STEPS sizeof(bashforth)/sizeof(bashforth[0])
+#define BLOCK 256
 
 double Adams_Bashforth_20_Steps( double y, double h, double f_history[] );
 int Adams_Moulton_19_Steps( double (*f)(double, double), double y[], double x, 
              double h, double f_history[], double tolerance, int iterations );
 static int hasConverged(double y0, double y1, double epsilon);
 
+static double Compensated_Dot_Product( const double hi[], const double lo[],
+                                                   const double v[], int m );
+static void Compensated_Linear_Combination( double z[], double y[],
+                double scale, const double hi[], const double lo[],
+                                               double *v[], int m, int n );
+void Vector_Linear_Combination( double z[], double y[], double a[],
+                                                 double *v[], int m, int n );
+int Thread_Pool_In_Parallel( void );
+
 ////////////////////////////////////////////////////////////////////////////////
 // int Adams_20_Steps( double (*f)(double, double), double y[], double x0,    //
 //      double h, double f_history[], double *y_bashforth,  double tolerance, //
@@ -113,6 +147,10 @@ static int hasConverged(double y0, double y1, double epsilon);
 //                the solution y(x).                                          //
 //     int    iterations   The maximum number of iterations for allow for the //
 //                corrector to try to converge within the tolerance above.    //
+//                If tolerance = 0, exactly iterations corrections are made,  //
+//                for a fixed number of evaluations of f(x,y), and the value  //
+//                returned is then iterations + 1, as for a corrector which   //
+//                failed to converge.                                         //
 //                                                                            //
 //  Return Values:                                                            //
 //     The number of iterations performed during the Adams-Moulton correction.//
@@ -167,13 +205,11 @@ int Adams_20_Steps( double (*f)(double, double), double y[], double x0,
 //                                                                            //
 double Adams_Bashforth_20_Steps( double y, double h, double f_history[] ) {
 
-   double delta = 0.0;
-   int i;
-   int n = STEPS - 1;
+   double delta;
 
           // Calculate the predictor using the Adams-Bashforth formula 
 
-   for (i = 0; i < STEPS; i++, n--) delta += bashforth[i] * f_history[n];
+   delta = Compensated_Dot_Product( bashforth, bashforth_lo, f_history, STEPS );
 
    return y + h * divisor * delta;
 }
@@ -207,6 +243,10 @@ double Adams_Bashforth_20_Steps( double y, double h, double f_history[] ) {
 //                the solution y(x).                                          //
 //     int    iterations   The maximum number of iterations for allow for the //
 //                corrector to try to converge within the tolerance above.    //
+//                If tolerance = 0, exactly iterations corrections are made,  //
+//                for a fixed number of evaluations of f(x,y), and the value  //
+//                returned is then iterations + 1, as for a corrector which   //
+//                failed to converge.                                         //
 //                                                                            //
 //  Return Values:                                                            //
 //     The number of iterations performed.  The value of y(x) is stored in    //
@@ -218,14 +258,13 @@ int Adams_Moulton_19_Steps( double (*f)(double, double), double y[], double x,
              double h, double f_history[], double tolerance, int iterations ) {
 
    double old_estimate;
-   double delta = 0.0;
+   double delta;
    int i;
-   int n = STEPS - 2;
-   int converged = -1;
 
           // Calculate the corrector using the Adams-Moulton formula 
    
-   for (i = 1; i < STEPS; i++, n--) delta += moulton[i] * f_history[n];
+   delta = Compensated_Dot_Product( moulton + 1, moulton_lo + 1, f_history,
+                                                                  STEPS - 1 );
 
    for (i = 0; i < iterations; i++) {
       old_estimate = y[1];
@@ -303,3 +342,234 @@ static int hasConverged(double y0, double y1, double epsilon) {
    if ( fabs(y0 - y1) < epsilon ) return 1;
    return 0;
 }
+
+
+////////////////////////////////////////////////////////////////////////////////
+// void Adams_Bashforth_20_Steps_System( double y[], double y_next[],         //
+//                               double h, double *f_history[], int n )       //
+//                                                                            //
+//  Description:                                                              //
+//     This function uses the Adams-Bashforth method to approximate the solu- //
+//     tion of the system of differential equations y' = f(x,y), y an         //
+//     n-vector, at x0 + h given y = y(x0) and the history f_history[i] =     //
+//     f( x0-(19-i)*h, y(x0-(19-i)*h) ), i = 0,..., 19, each an n-vector.     //
+//     The twenty history vectors are combined in a single pass by            //
+//     Compensated_Linear_Combination() below.                                //
+//                                                                            //
+//  Arguments:                                                                //
+//     double y[]      The value of y at x0.                                  //
+//     double y_next[] The estimate of y(x0+h).  y_next[] may be y[].         //
+//     double h        Step size                                              //
+//     double *f_history[]  The 20 history vectors as described above.        //
+//     int    n        The number of equations.                               //
+//                                                                            //
+//  Return Values:                                                            //
+//     This routine is of type void and hence does not return a value.        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Adams_Bashforth_20_Steps_System( double y[], double y_next[], double h,
+                                               double *f_history[], int n ) {
+
+   double *v[STEPS];
+   int i;
+   int k = STEPS - 1;
+
+   for (i = 0; i < STEPS; i++, k--) v[i] = f_history[k];
+   Compensated_Linear_Combination( y_next, y, h * divisor, bashforth,
+                                               bashforth_lo, v, STEPS, n );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// int Adams_Moulton_19_Steps_System( void (*f)(double, double[], double[]),  //
+//      double y0[], double y1[], int n, double x, double h,                  //
+//      double *f_history[], double tolerance, int iterations, double work[] )//
+//                                                                            //
+//  Description:                                                              //
+//     This function uses the Adams-Moulton method to iterate for an estimate //
+//     of the solution of the system y' = f(x,y), y an n-vector, at x given   //
+//     y0[] = y(x-h), the initial estimate y1[] of y(x) and the history       //
+//     f_history[i] = f( x-(19-i)*h, y(x-(19-i)*h) ), i = 0,..., 18.  The     //
+//     explicit part of the corrector is formed once by a single pass of      //
+//     Compensated_Linear_Combination().  The iteration stops when each       //
+//     component has converged in the sense of hasConverged() below.          //
+//                                                                            //
+//  Arguments:                                                                //
+//     void (*f)(double x, double y[], double dy[])                           //
+//                Pointer to the function which evaluates the derivatives.    //
+//     double y0[] The value of y at x - h.                                   //
+//     double y1[] On input the prediction of y at x, on output the corrected //
+//                value of y at x.                                            //
+//     int    n   The number of equations.                                    //
+//     double x   The x value for y1[].                                       //
+//     double h   Step size                                                   //
+//     double *f_history[]  The 19 history vectors as described above.        //
+//     double tolerance    The terminating tolerance for the corrector.       //
+//     int    iterations   The maximum number of iterations.  If tolerance is //
+//                0, exactly iterations corrections are made.                 //
+//     double work[]       Working storage of dimension at least 2 * n.       //
+//                                                                            //
+//  Return Values:                                                            //
+//     The number of iterations performed.  If the return value is greater    //
+//     than iterations, the corrector failed to converge; with tolerance = 0  //
+//     the return value is always iterations + 1.                             //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Adams_Moulton_19_Steps_System( void (*f)(double, double[], double[]),
+          double y0[], double y1[], int n, double x, double h,
+          double *f_history[], double tolerance, int iterations,
+                                                              double work[] ) {
+
+   double *v[STEPS];
+   double *base = work;
+   double *dy = work + n;
+   double c0 = h * divisor * moulton[0];
+   double old_estimate;
+   int converged;
+   int i, j;
+   int k = STEPS - 2;
+
+   for (i = 1; i < STEPS; i++, k--) v[i-1] = f_history[k];
+   Compensated_Linear_Combination( base, y0, h * divisor, moulton + 1,
+                                         moulton_lo + 1, v, STEPS - 1, n );
+
+   for (i = 0; i < iterations; i++) {
+      (*f)(x, y1, dy);
+      converged = 1;
+      for (j = 0; j < n; j++) {
+         old_estimate = y1[j];
+         y1[j] = base[j] + c0 * dy[j];
+         if ( converged && !hasConverged(old_estimate, y1[j], tolerance) )
+            converged = 0;
+      }
+      if (converged) break;
+   }
+   return i+1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// static double Compensated_Dot_Product( const double hi[],                  //
+//                          const double lo[], const double v[], int m )      //
+//                                                                            //
+//  Description:                                                              //
+//     This function returns the sum of (hi[i] + lo[i]) * v[m-1-i] for        //
+//     i = 0,..., m-1, i.e. the coefficients are applied to the history in    //
+//     reverse order, as accurately as if it were computed in twice the       //
+//     working precision and then rounded (Ogita, Rump and Oishi's Dot2).     //
+//     Each product hi[i] * v[.] is split exactly into its rounded value and  //
+//     its error by a fused multiply-add, each partial sum into its rounded   //
+//     value and its error by Knuth's TwoSum, and the errors together with    //
+//     the products of the remainders lo[i] are summed separately.            //
+//                                                                            //
+//     Note!  This function must not be compiled with -ffast-math or any      //
+//     other option permitting the compiler to reassociate floating point     //
+//     operations.                                                            //
+//                                                                            //
+//  Arguments:                                                                //
+//     const double hi[]  The coefficients rounded to double.                 //
+//     const double lo[]  The remainders, coefficient - hi[i], exactly.       //
+//     const double v[]   The history.                                        //
+//     int    m           The number of terms.                                //
+//                                                                            //
+//  Return Values:                                                            //
+//     The sum of products described above.                                   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static double Compensated_Dot_Product( const double hi[], const double lo[],
+                                                   const double v[], int m ) {
+
+   double sum = 0.0, error = 0.0;
+   double x, product, t, z;
+   int i;
+
+#ifdef ADAMS_UNCOMPENSATED
+   for (i = 0; i < m; i++) sum += hi[i] * v[m - 1 - i];
+#else
+   for (i = 0; i < m; i++) {
+      x = v[m - 1 - i];
+      product = hi[i] * x;
+      error += fma( hi[i], x, -product ) + lo[i] * x;
+      t = sum + product;
+      z = t - sum;
+      error += (sum - (t - z)) + (product - z);
+      sum = t;
+   }
+#endif
+   return sum + error;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// static void Compensated_Linear_Combination( double z[], double y[],        //
+//                double scale, const double hi[], const double lo[],         //
+//                                             double *v[], int m, int n )    //
+//                                                                            //
+//  Description:                                                              //
+//     This function sets z[j] = y[j] + scale * sum (hi[i] + lo[i]) * v[i][j] //
+//     for j = 0,..., n-1, the sum over i = 0,..., m-1 being formed for each  //
+//     component as in Compensated_Dot_Product().  The components are         //
+//     processed in blocks of BLOCK, the sums and errors of a block being     //
+//     kept in local arrays so that the loop over the components of a block   //
+//     is vectorized.  The blocks are divided among the threads when compiled //
+//     with OpenMP and n is large, unless called from a body of               //
+//     Thread_Pool_Parallel_For(), see thread_pool.c.  z[] may be y[].        //
+//                                                                            //
+//  Arguments:                                                                //
+//     double z[]         The result.                                         //
+//     double y[]         The vector to which the sum is added.               //
+//     double scale       The factor of the sum, h * divisor, where divisor   //
+//                        is the reciprocal of the common denominator of the  //
+//                        coefficients.                                       //
+//     const double hi[]  The coefficients rounded to double.                 //
+//     const double lo[]  The remainders, coefficient - hi[i], exactly.       //
+//     double *v[]        The m vectors.                                      //
+//     int    m           The number of vectors.                              //
+//     int    n           The dimension of the vectors.                       //
+//                                                                            //
+//  Return Values:                                                            //
+//     This routine is of type void and hence does not return a value.        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static void Compensated_Linear_Combination( double z[], double y[],
+                double scale, const double hi[], const double lo[],
+                                              double *v[], int m, int n ) {
+
+   double sum[BLOCK], error[BLOCK];
+   int i, j, k, block;
+
+#ifdef ADAMS_UNCOMPENSATED
+   double a[STEPS];
+
+   for (i = 0; i < m; i++) a[i] = scale * hi[i];
+   Vector_Linear_Combination( z, y, a, v, m, n );
+#else
+   #pragma omp parallel for schedule(static) private(sum, error, i, j, block) \
+                             if (n >= 32768 && !Thread_Pool_In_Parallel())
+   for (k = 0; k < n; k += BLOCK) {
+      block = (n - k < BLOCK) ? n - k : BLOCK;
+      for (j = 0; j < block; j++) { sum[j] = 0.0; error[j] = 0.0; }
+      for (i = 0; i < m; i++) {
+         #pragma omp simd
+         for (j = 0; j < block; j++) {
+            double x = v[i][k + j];
+            double product = hi[i] * x;
+            double t, u;
+
+            error[j] += fma( hi[i], x, -product ) + lo[i] * x;
+            t = sum[j] + product;
+            u = t - sum[j];
+            error[j] += (sum[j] - (t - u)) + (product - u);
+            sum[j] = t;
+         }
+      }
+      #pragma omp simd
+      for (j = 0; j < block; j++)
+         z[k + j] = y[k + j] + scale * (sum[j] + error[j]);
+   }
+#endif
+}
@@ -29,6 +29,10 @@
 //                                                                            //
 //     Richardson extrapolation may be used to increase to increase the       //
 //     order.                                                                 //
+//                                                                            //
+//     For systems of high order, see the Gauss-Jackson (summed Stormer-      //
+//     Cowell) method in gauss_jackson.c, which requires a single evaluation  //
+//     of f per step.                                                         //
 ////////////////////////////////////////////////////////////////////////////////
 
 static const double richardson[] = {  1.0 / 7.0, 1.0 / 15.0, 1.0 / 31.0,
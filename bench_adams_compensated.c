@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: bench_adams_compensated.c                                            //
+// Purpose:                                                                   //
+//    Measure the accuracy and the cost of each step of the 18 and 20 step    //
+//    Adams predictor-corrector methods of the files adams_18_steps.c and     //
+//    adams_20_steps.c.  Compiled with -DADAMS_UNCOMPENSATED, as are the      //
+//    two files, the ordinary sums of the coefficients times the history      //
+//    are used instead of the compensated sums.                               //
+//                                                                            //
+// First compare a single Adams-Bashforth increment from x = 1 with the       //
+// exact integral for the history f(x) = x^3 sampled at multiples of          //
+// h = 2^-4, 2^-7 and 2^-10.  The history is exact and the formulas are       //
+// exact for cubics, so that the error is the rounding error of the sum       //
+// alone.  Then solve y' = y cos(x), y(0) = 1, whose solution is              //
+// y = exp(sin(x)), from x = 0 to x = 40 with step sizes from 0.002 down to   //
+// 0.00025, the history being started from the exact solution.  The 18 step   //
+// method is unstable for this equation for step sizes larger than 0.002, the //
+// 20 step method already for 0.001 and larger, so that the 20 step method is //
+// only run for h <= 0.0005.  Finally time the step of the system versions    //
+// for y' = -y with n = 100000 components.                                    //
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+double Adams_Bashforth_18_Steps( double y, double h, double f_history[] );
+double Adams_Bashforth_20_Steps( double y, double h, double f_history[] );
+int Adams_18_Steps( double (*f)(double, double), double y[], double x0,
+                  double h, double f_history[], double *y_bashforth,
+                  double tolerance, int iterations );
+void Adams_18_Build_History(double (*f)(double,double), double f_history[],
+                                              double y[], double x, double h);
+int Adams_20_Steps( double (*f)(double, double), double y[], double x0,
+                  double h, double f_history[], double *y_bashforth,
+                  double tolerance, int iterations );
+void Adams_20_Build_History(double (*f)(double,double), double f_history[],
+                                              double y[], double x, double h);
+void Adams_Bashforth_20_Steps_System( double y[], double y_next[], double h,
+                                               double *f_history[], int n );
+int Adams_Moulton_19_Steps_System( void (*f)(double, double[], double[]),
+          double y0[], double y1[], int n, double x, double h,
+          double *f_history[], double tolerance, int iterations,
+                                                              double work[] );
+
+static double f(double x, double y) { return y * cos(x); }
+
+static int n = 100000;
+
+static void g(double x, double y[], double dy[]) {
+   int i;
+
+   (void) x;
+   for (i = 0; i < n; i++) dy[i] = -y[i];
+}
+
+// The relative error of the Bashforth increment from x = 1 to 1 + h for the
+// history f(x) = x^3, h a power of 2 so that the history is exact.
+
+static double Increment_Error( int steps, double h ) {
+   double f_history[20], increment, x;
+   long double exact, b = 1.0L + (long double) h;
+   int i;
+
+   for (i = 0; i < steps; i++) {
+      x = 1.0 - (steps - 1 - i) * h;
+      f_history[i] = x * x * x;
+   }
+   if (steps == 18) increment = Adams_Bashforth_18_Steps( 0.0, h, f_history );
+   else increment = Adams_Bashforth_20_Steps( 0.0, h, f_history );
+   exact = (b * b * b * b - 1.0L) / 4.0L;
+   return (double) ((increment - exact) / exact);
+}
+
+static double Seconds( void ) {
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (double) t.tv_sec + 1.e-9 * (double) t.tv_nsec;
+}
+
+// Integrate y' = y cos(x) from 0 to x1 by the 18 or 20 step method, return
+// the error at x1 and set *seconds to the time of each step.
+
+static double Solve( int steps, double h, double x1, double *seconds ) {
+   double f_history[20], y_start[20], y[2];
+   double x, yb, start;
+   int i, number_of_steps;
+
+   for (i = 0; i < steps; i++) y_start[i] = exp(sin(i * h));
+   if (steps == 18) Adams_18_Build_History( f, f_history, y_start, 0.0, h );
+   else Adams_20_Build_History( f, f_history, y_start, 0.0, h );
+   x = (steps - 1) * h;
+   y[0] = y_start[steps - 1];
+   number_of_steps = (int) ((x1 - x) / h + 0.5);
+   start = Seconds();
+   for (i = 0; i < number_of_steps; i++) {
+      if (steps == 18) Adams_18_Steps( f, y, x, h, f_history, &yb, 1.e-15, 8 );
+      else Adams_20_Steps( f, y, x, h, f_history, &yb, 1.e-15, 8 );
+      y[0] = y[1];
+      x += h;
+   }
+   *seconds = (Seconds() - start) / number_of_steps;
+   return y[0] - exp(sin(x));
+}
+
+int main( void )
+{
+   double h, e18, e20, t18, t20, start;
+   double *y, *y1, *work, *history[20];
+   int i, j, repetitions = 20;
+
+#ifdef ADAMS_UNCOMPENSATED
+   printf("ordinary sums\n");
+#else
+   printf("compensated sums\n");
+#endif
+   printf("     h     increment relative error\n");
+   printf("               18 steps        20 steps\n");
+   for (h = 0.0625; h > 0.0005; h *= 0.125)
+      printf("%8.5lf  %+14.4le  %+14.4le\n", h, Increment_Error( 18, h ),
+                                                   Increment_Error( 20, h ));
+   printf("\n     h     error 18 steps  error 20 steps   ns/step 18"
+                                                           "   ns/step 20\n");
+   for (h = 0.002; h > 0.0002; h *= 0.5) {
+      e18 = Solve( 18, h, 40.0, &t18 );
+      printf("%8.5lf  %+14.4le", h, e18);
+      if (h <= 0.0005) {
+         e20 = Solve( 20, h, 40.0, &t20 );
+         printf("  %+14.4le  %11.1lf  %11.1lf\n", e20, 1.e9 * t18, 1.e9 * t20);
+      }
+      else printf("        unstable  %11.1lf\n", 1.e9 * t18);
+   }
+
+   y = (double*) malloc( 24 * n * sizeof(double) );
+   if (y == NULL) { printf("Not enough memory\n"); return 1; }
+   y1 = y + n;
+   work = y + 2 * n;
+   for (i = 0; i < 20; i++) history[i] = y + (4 + i) * n;
+   for (i = 0; i < 20; i++)
+      for (j = 0; j < n; j++) history[i][j] = -exp(-0.01 * (i - 19));
+   for (j = 0; j < n; j++) y[j] = 1.0;
+   start = Seconds();
+   for (i = 0; i < repetitions; i++) {
+      Adams_Bashforth_20_Steps_System( y, y1, 0.01, history, n );
+      Adams_Moulton_19_Steps_System( g, y, y1, n, 0.01, 0.01, history,
+                                                          1.e-15, 1, work );
+   }
+   printf("\nsystem, n = %d: %.3lf ns per component and step\n", n,
+                        1.e9 * (Seconds() - start) / repetitions / n);
+   free(y);
+   return 0;
+}
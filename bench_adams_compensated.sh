@@ -0,0 +1,35 @@
+#  Measure the accuracy and the cost of each step of the 18 and 20 step
+#  Adams methods with the compensated sums of the coefficients times the
+#  history and, for comparison, with the ordinary sums.
+#
+#  Dependent on: adams_18_steps.c, adams_20_steps.c, vector_kernels.c,
+#                thread_pool.c
+#
+#  After downloading change permissions: chmod 744 bench_adams_compensated.sh
+#  Execute as ./bench_adams_compensated.sh
+#
+#  The compensated sums rely on the exact rounding of each operation, do not
+#  add -ffast-math.
+#
+for OPTION in "" "-DADAMS_UNCOMPENSATED"
+do
+
+# Change! if the files are in a different directory.
+gcc -O3 -march=native -fopenmp $OPTION -c -o x1.o adams_18_steps.c
+gcc -O3 -march=native -fopenmp $OPTION -c -o x2.o adams_20_steps.c
+gcc -O3 -march=native -fopenmp -c -o x3.o vector_kernels.c
+gcc -O3 -march=native -fopenmp -pthread -c -o x4.o thread_pool.c
+
+# Change! if bench_adams_compensated.c is in a different directory.
+gcc -O3 -march=native -fopenmp -pthread $OPTION -o badams \
+                           bench_adams_compensated.c x1.o x2.o x3.o x4.o -lm
+
+# Change! if you profile has a PATH set to this directory.
+./badams
+echo
+
+done
+
+# Delete temporary files.
+rm badams
+rm x1.o x2.o x3.o x4.o
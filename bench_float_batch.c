@@ -0,0 +1,188 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: bench_float_batch.c                                                  //
+// Purpose:                                                                   //
+//    Compare the throughput and the accuracy of the double, single and       //
+//    mixed precision batch versions of the Runge-Kutta-Gill, 3/8 and         //
+//    Verner methods and of the 82 point Gauss-Chebyshev formula.             //
+//                                                                            //
+// The ensemble is y' = lambda * (cos(x) - y), y(0) = 1, with m lanes,        //
+// m = 4096 by default or the first command line argument, and lambda         //
+// ranging over [0.5, 2.5), integrated from x = 0 to x = 20 with each of      //
+// the step sizes 0.2, 0.02 and 0.002.  The integrals are those of            //
+// cos(lambda * x) / sqrt(1 - x^2) from -1 to 1, i.e. pi * J0(lambda).        //
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+void Runge_Kutta_Verner_System( void (*f)(double, double[], double[]),
+                 double y[], int n, double x0, double h, int number_of_steps,
+                                                             double work[] );
+void Runge_Kutta_Verner_Batch_Float( void (*f)(float, float[], float[], int),
+                    float y[], int m, double x0, double h, int number_of_steps,
+                                                               float work[] );
+void Runge_Kutta_Verner_Batch_Mixed( void (*f)(float, float[], float[], int),
+                   double y[], int m, double x0, double h, int number_of_steps,
+                                                               float work[] );
+void Runge_Kutta_Gill_Batch_Float( void (*f)(float, float[], float[], int),
+                    float y[], int m, double x0, double h, int number_of_steps,
+                                                               float work[] );
+void Runge_Kutta_Gill_Batch_Mixed( void (*f)(float, float[], float[], int),
+                   double y[], int m, double x0, double h, int number_of_steps,
+                                                               float work[] );
+void Runge_Kutta_3_8_Batch_Float( void (*f)(float, float[], float[], int),
+                    float y[], int m, double x0, double h, int number_of_steps,
+                                                               float work[] );
+void Runge_Kutta_3_8_Batch_Mixed( void (*f)(float, float[], float[], int),
+                   double y[], int m, double x0, double h, int number_of_steps,
+                                                               float work[] );
+double Gauss_Chebyshev_Integration_82pts( double (*f)(double) );
+void Gauss_Chebyshev_Integration_82pts_Batch_Float(
+           void (*f)(float, float[], int), float integral[], float work[],
+                                                                     int m );
+
+static int m = 4096;
+static double *lambda;
+static float *lambda_single;
+static double lambda_current;
+
+static void f_double(double x, double y[], double dy[]) {
+   double c = cos(x);
+   int j;
+
+   for (j = 0; j < m; j++) dy[j] = lambda[j] * (c - y[j]);
+}
+
+static void f_single(float x, float y[], float dy[], int lanes) {
+   float c = cosf(x);
+   int j;
+
+   #pragma omp simd
+   for (j = 0; j < lanes; j++) dy[j] = lambda_single[j] * (c - y[j]);
+}
+
+static double g_double(double x) { return cos(lambda_current * x); }
+
+static void g_single(float x, float fx[], int lanes) {
+   int j;
+
+   for (j = 0; j < lanes; j++) fx[j] = cosf(lambda_single[j] * x);
+}
+
+static double Exact(double l, double x) {
+   double d = l * l + 1.0;
+
+   return (1.0 - l * l / d) * exp(-l * x) + l * (l * cos(x) + sin(x)) / d;
+}
+
+static double Seconds( void ) {
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (double) t.tv_sec + 1.e-9 * (double) t.tv_nsec;
+}
+
+static const char *names[] = { "verner double", "verner float",
+   "verner mixed", "gill float", "gill mixed", "3/8 float", "3/8 mixed" };
+
+#define NUMBER_OF_METHODS (int) (sizeof(names) / sizeof(names[0]))
+
+// Integrate the ensemble from 0 to x1 by the given method and report the
+// throughput in lane-steps per second and the maximum error.
+
+static void Run(int method, double x1, double h, double y[], float ys[],
+                                             double work[], float works[]) {
+   int steps = (int) (x1 / h + 0.5);
+   double start, elapsed, err = 0.0;
+   int j;
+
+   for (j = 0; j < m; j++) { y[j] = 1.0; ys[j] = 1.0f; }
+   start = Seconds();
+   switch (method) {
+      case 0: Runge_Kutta_Verner_System( f_double, y, m, 0.0, h, steps,
+                                                                  work );
+              break;
+      case 1: Runge_Kutta_Verner_Batch_Float( f_single, ys, m, 0.0, h, steps,
+                                                                 works );
+              break;
+      case 2: Runge_Kutta_Verner_Batch_Mixed( f_single, y, m, 0.0, h, steps,
+                                                                 works );
+              break;
+      case 3: Runge_Kutta_Gill_Batch_Float( f_single, ys, m, 0.0, h, steps,
+                                                                 works );
+              break;
+      case 4: Runge_Kutta_Gill_Batch_Mixed( f_single, y, m, 0.0, h, steps,
+                                                                 works );
+              break;
+      case 5: Runge_Kutta_3_8_Batch_Float( f_single, ys, m, 0.0, h, steps,
+                                                                 works );
+              break;
+      case 6: Runge_Kutta_3_8_Batch_Mixed( f_single, y, m, 0.0, h, steps,
+                                                                 works );
+              break;
+   }
+   elapsed = Seconds() - start;
+   if (method == 1 || method == 3 || method == 5)
+      for (j = 0; j < m; j++) y[j] = (double) ys[j];
+   for (j = 0; j < m; j++) err = fmax(err, fabs(y[j] - Exact(lambda[j], x1)));
+   printf("%-14s %7.3lf %12.4le %14.4le\n", names[method], h,
+                                            (double) m * steps / elapsed, err);
+}
+
+int main(int argc, char *argv[])
+{
+   static const double hs[] = { 0.2, 0.02, 0.002 };
+   double *y, *work;
+   float *ys, *works, *integral;
+   double x1 = 20.0, start, elapsed, err;
+   int i, j, k;
+
+   if (argc > 1) m = atoi(argv[1]);
+   lambda = (double*) malloc( m * sizeof(double) );
+   lambda_single = (float*) malloc( m * sizeof(float) );
+   y = (double*) malloc( m * sizeof(double) );
+   work = (double*) malloc( 8 * m * sizeof(double) );
+   ys = (float*) malloc( m * sizeof(float) );
+   works = (float*) malloc( 9 * m * sizeof(float) );
+   integral = (float*) malloc( m * sizeof(float) );
+   if (lambda == NULL || lambda_single == NULL || y == NULL || work == NULL
+                         || ys == NULL || works == NULL || integral == NULL) {
+      printf("Not enough memory\n"); return 1;
+   }
+   for (j = 0; j < m; j++) {
+      lambda[j] = 0.5 + 2.0 * (double) j / (double) m;
+      lambda_single[j] = (float) lambda[j];
+   }
+
+   printf("m = %d lanes, x = 0 to %4.1lf\n", m, x1);
+   printf("method             h  lane-steps/s    max error\n");
+   for (i = 0; i < (int) (sizeof(hs) / sizeof(hs[0])); i++) {
+      for (k = 0; k < NUMBER_OF_METHODS; k++)
+         Run( k, x1, hs[i], y, ys, work, works );
+   }
+
+   printf("\nmethod                   integrals/s    max error\n");
+   start = Seconds();
+   for (j = 0; j < m; j++) {
+      lambda_current = lambda[j];
+      y[j] = Gauss_Chebyshev_Integration_82pts( g_double );
+   }
+   elapsed = Seconds() - start;
+   for (err = 0.0, j = 0; j < m; j++)
+      err = fmax(err, fabs(y[j] - M_PI * j0(lambda[j])));
+   printf("%-22s %14.4le %12.4le\n", "gauss-chebyshev double",
+                                                   m / elapsed, err);
+   start = Seconds();
+   Gauss_Chebyshev_Integration_82pts_Batch_Float( g_single, integral, works,
+                                                                         m );
+   elapsed = Seconds() - start;
+   for (err = 0.0, j = 0; j < m; j++)
+      err = fmax(err, fabs((double) integral[j] - M_PI * j0(lambda[j])));
+   printf("%-22s %14.4le %12.4le\n", "gauss-chebyshev float",
+                                                   m / elapsed, err);
+
+   free(lambda); free(lambda_single); free(y); free(work);
+   free(ys); free(works); free(integral);
+   return 0;
+}
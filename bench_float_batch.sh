@@ -0,0 +1,35 @@
+#  Compare the throughput and the accuracy of the double, single and mixed
+#  precision batch integrators and of the single precision batch
+#  Gauss-Chebyshev formula.
+#
+#  Dependent on: runge_kutta_verner.c, runge_kutta_gill.c, runge_kutta_3_8.c,
+#                gauss_chebyshev_82pts.c, vector_kernels.c,
+#                richardson_adaptive.c, step_size_controller.c,
+#                thread_pool.c
+#
+#  After downloading change permissions: chmod 744 bench_float_batch.sh
+#  Execute as ./bench_float_batch.sh [m]
+#
+#  On a processor with AVX-512 sixteen lanes are processed per instruction
+#  by the single precision routines, eight by the double precision routines.
+#
+# Change! if the files are in a different directory.
+gcc -O3 -march=native -fopenmp -c -o x1.o runge_kutta_verner.c
+gcc -O3 -march=native -fopenmp -c -o x2.o runge_kutta_gill.c
+gcc -O3 -march=native -fopenmp -c -o x3.o runge_kutta_3_8.c
+gcc -O3 -march=native -fopenmp -c -o x4.o gauss_chebyshev_82pts.c
+gcc -O3 -march=native -fopenmp -c -o x5.o vector_kernels.c
+gcc -O3 -march=native -fopenmp -c -o x6.o richardson_adaptive.c
+gcc -O3 -march=native -fopenmp -c -o x7.o step_size_controller.c
+gcc -O3 -march=native -fopenmp -pthread -c -o x8.o thread_pool.c
+
+# Change! if bench_float_batch.c is in a different directory.
+gcc -O3 -march=native -fopenmp -pthread -o bfloat bench_float_batch.c x1.o \
+                                     x2.o x3.o x4.o x5.o x6.o x7.o x8.o -lm
+
+# Change! if you profile has a PATH set to this directory.
+./bfloat $1
+
+# Delete temporary files.
+rm bfloat
+rm x1.o x2.o x3.o x4.o x5.o x6.o x7.o x8.o
@@ -0,0 +1,415 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: bench_latency.c                                                      //
+// Purpose:                                                                   //
+//    Measure the distribution of the latency of a single call of each of     //
+//    the one step solvers, of the solvers of the second order equations      //
+//    y'' = f(x,y) and y'' = f(x,y,y'), a single predictor-corrector step of  //
+//    the 12 step Adams method and a single quadrature, as needed by a        //
+//    control loop which calls a solver once per tick.                        //
+//                                                                            //
+// Each call is timed by the time stamp counter on x86 processors, with the   //
+// counter converted to nanoseconds by calibrating it against                 //
+// clock_gettime(), and by clock_gettime() elsewhere.  The cost of reading    //
+// the timer, measured in the same way, is subtracted.  The process is        //
+// pinned to one processor, the last one or the one given as the first        //
+// command line argument, and before the measurements the processor is kept   //
+// busy for half a second so that it reaches its operating frequency.  The    //
+// frequency can not be fixed by an unprivileged program: for reproducible    //
+// results set the cpufreq governor to performance, and disable turbo, e.g.   //
+//    cpupower frequency-set -g performance                                   //
+// The governor found is reported.                                            //
+//                                                                            //
+// Each solver advances a single step, the second order solvers which use     //
+// Richardson extrapolation with 4 columns.  The implicit central difference  //
+// method is called for 2 steps, the first being its explicit starting step.  //
+//                                                                            //
+// The warm numbers are for 100000 consecutive calls after 1000 calls to      //
+// warm up, the cold numbers for 2000 calls each preceded by writing a 64 MB  //
+// buffer, which evicts the data and the code of the routine from the         //
+// caches.  The minimum, median, 99th and 99.9th percentiles and the maximum  //
+// are reported in nanoseconds.                                               //
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE                                // for sched_setaffinity()
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TIME_STAMP_COUNTER
+#endif
+
+double Eulers_Method( double (*f)(double, double), double y0, double x0,
+                                             double h, int number_of_steps );
+double Trapezoidal_Method( double (*f)(double, double),
+                     double (*g)(double,double,double), double y0, double x0,
+                                             double h, int number_of_steps );
+double Runge_Kutta_Gill( double (*f)(double, double), double y0, double x0,
+                                             double h, int number_of_steps );
+double Runge_Kutta_3_8( double (*f)(double, double), double y0, double x0,
+                                             double h, int number_of_steps );
+double Runge_Kutta_Nystrom( double (*f)(double, double), double y0, double x0,
+                                             double h, int number_of_steps );
+double Runge_Kutta_Verner( double (*f)(double, double), double y0, double x0,
+                                             double h, int number_of_steps );
+void Runge_Kutta_2nd_Order( double (*f)(double, double, double), double x0,
+                        double y[], double c, double h, int number_of_steps );
+void Numerovs_Method( double (*f)(double, double),
+                      double (*g)(double,double,double),
+                      double y[], double x0, double c, double h,
+                      int richardson_columns, int number_of_steps );
+void Explicit_Central_Difference_Method( double (*f)(double, double),
+                    double y[], double x0, double c, double h, int max_columns,
+                                                        int number_of_steps );
+void Implicit_Central_Difference_Method( double f0,
+          double (*g)(double,double,double,double), double y[], double x0,
+                                    double c, double h, int number_of_steps );
+void Backward_Difference_Correction( double (*f)(double, double), double y[],
+ double x0, double c, double h, int richardson_columns, int number_of_steps );
+int Gragg_Bulirsch_Stoer( double (*f)(double, double), double y0, double *y1,
+            double x, double h, double *h_new, double epsilon, double yscale,
+                                                  int rational_extrapolate  );
+int Adams_12_Steps( double (*f)(double, double), double y[], double x0,
+                  double h, double f_history[], double *y_bashforth,
+                  double tolerance, int iterations );
+void Adams_12_Build_History(double (*f)(double,double), double f_history[],
+                                              double y[], double x, double h);
+double Simpson_Simpson_Adaptive(double a, double b, double tolerance,
+                              double (*f)(double), double min_h, int *err);
+double Gauss_Chebyshev_Integration_82pts( double (*f)(double) );
+double Hermite_Quadrature_1_Derivative_LR( double a, double h, int n,
+                                 double (*f)(double), double (*df)(double) );
+int Gauss_Rule_Cached( int family, int n, double alpha, double beta,
+                                       const double **x, const double **A );
+double Gauss_Rule_Integration( double (*f)(double), const double x[],
+                                                    const double A[], int n );
+
+#define WARM_CALLS 100000
+#define WARM_UP_CALLS 1000
+#define COLD_CALLS 2000
+#define EVICTION_BYTES (64 << 20)
+
+static volatile double sink;
+static double adams_y[2], adams_x, adams_history[12];
+static const double *legendre_x, *legendre_A;
+static char *eviction;
+
+static double f(double x, double y) { return x - y; }
+static double g(double x, double h, double u) {
+   return (u + h * x) / (1.0 + h);
+}
+static double q(double x) { return 1.0 / (1.0 + x * x); }
+static double dq(double x) { return -2.0 * x * q(x) * q(x); }
+
+// The second order equations y'' = x - y, for which f() serves, and the
+// damped y'' = x - y - 0.1 y'.  numerov_g() solves u = y - h^2 f(x,y) / 12
+// for y, central_g() the implicit central difference recursion for the
+// damped equation for y[n+1].
+
+static double f2(double x, double y, double yp) { return x - y - 0.1 * yp; }
+static double numerov_g(double x, double h, double u) {
+   return (u + h * h * x / 12.0) / (1.0 + h * h / 12.0);
+}
+static double central_g(double x, double y, double y_old, double h) {
+   return (2.0 * y - y_old + h * h * (x - y) + 0.05 * h * y_old)
+                                                            / (1.0 + 0.05 * h);
+}
+
+static void Call_Euler(void) { sink = Eulers_Method( f, 1.0, 0.0, 0.01, 1 ); }
+static void Call_Trapezoidal(void) {
+   sink = Trapezoidal_Method( f, g, 1.0, 0.0, 0.01, 1 );
+}
+static void Call_Gill(void) { sink = Runge_Kutta_Gill( f, 1.0, 0.0, 0.01, 1 ); }
+static void Call_3_8(void) { sink = Runge_Kutta_3_8( f, 1.0, 0.0, 0.01, 1 ); }
+static void Call_Nystrom(void) {
+   sink = Runge_Kutta_Nystrom( f, 1.0, 0.0, 0.01, 1 );
+}
+static void Call_Verner(void) {
+   sink = Runge_Kutta_Verner( f, 1.0, 0.0, 0.01, 1 );
+}
+static void Call_RK_2nd_Order(void) {
+   double y[2] = { 1.0, 0.0 };
+
+   Runge_Kutta_2nd_Order( f2, 0.0, y, 0.0, 0.01, 1 );
+   sink = y[1];
+}
+static void Call_Numerov(void) {
+   double y[2] = { 1.0, 0.0 };
+
+   Numerovs_Method( f, numerov_g, y, 0.0, 0.0, 0.01, 4, 1 );
+   sink = y[1];
+}
+static void Call_Explicit_Central(void) {
+   double y[2] = { 1.0, 0.0 };
+
+   Explicit_Central_Difference_Method( f, y, 0.0, 0.0, 0.01, 4, 1 );
+   sink = y[1];
+}
+static void Call_Implicit_Central(void) {
+   double y[3] = { 1.0, 0.0, 0.0 };
+
+   Implicit_Central_Difference_Method( f2(0.0, 1.0, 0.0), central_g, y, 0.0,
+                                                            0.0, 0.01, 2 );
+   sink = y[2];
+}
+static void Call_Backward_Difference(void) {
+   double y[2] = { 1.0, 0.0 };
+
+   Backward_Difference_Correction( f, y, 0.0, 0.0, 0.01, 4, 1 );
+   sink = y[1];
+}
+static void Call_GBS_Polynomial(void) {
+   double y1, h_new;
+
+   Gragg_Bulirsch_Stoer( f, 1.0, &y1, 0.0, 0.01, &h_new, 1.e-10, 1.0, 0 );
+   sink = y1;
+}
+static void Call_GBS_Rational(void) {
+   double y1, h_new;
+
+   Gragg_Bulirsch_Stoer( f, 1.0, &y1, 0.0, 0.01, &h_new, 1.e-10, 1.0, 1 );
+   sink = y1;
+}
+
+// The Adams method carries its history from call to call, it advances along
+// the solution of y' = x - y by steps of 1/1024.
+
+static void Call_Adams(void) {
+   double yb;
+
+   Adams_12_Steps( f, adams_y, adams_x, 1.0 / 1024.0, adams_history, &yb,
+                                                                   1.e-12, 4 );
+   adams_y[0] = adams_y[1];
+   adams_x += 1.0 / 1024.0;
+   sink = adams_y[0];
+}
+static void Start_Adams(void) {
+   double y[12];
+   int i;
+
+   for (i = 0; i < 12; i++) y[i] = i / 1024.0 - 1.0 + 2.0 * exp(-i / 1024.0);
+   Adams_12_Build_History( f, adams_history, y, 0.0, 1.0 / 1024.0 );
+   adams_y[0] = y[11];
+   adams_x = 11.0 / 1024.0;
+}
+static void Call_Simpson(void) {
+   int err;
+
+   sink = Simpson_Simpson_Adaptive( 0.0, 1.0, 1.e-10, q, 1.e-6, &err );
+}
+static void Call_Chebyshev(void) {
+   sink = Gauss_Chebyshev_Integration_82pts( q );
+}
+static void Call_Legendre(void) {
+   sink = Gauss_Rule_Integration( q, legendre_x, legendre_A, 20 );
+}
+static void Call_Hermite(void) {
+   sink = Hermite_Quadrature_1_Derivative_LR( 0.0, 0.05, 20, q, dq );
+}
+
+static const struct {
+   const char *name;
+   void (*call)(void);
+} routine[] = {
+   { "euler", Call_Euler },
+   { "trapezoidal", Call_Trapezoidal },
+   { "runge-kutta gill", Call_Gill },
+   { "runge-kutta 3/8", Call_3_8 },
+   { "runge-kutta nystrom", Call_Nystrom },
+   { "runge-kutta verner", Call_Verner },
+   { "runge-kutta 2nd ord", Call_RK_2nd_Order },
+   { "numerov", Call_Numerov },
+   { "explicit central", Call_Explicit_Central },
+   { "implicit central", Call_Implicit_Central },
+   { "backward diff corr", Call_Backward_Difference },
+   { "bulirsch-stoer poly", Call_GBS_Polynomial },
+   { "bulirsch-stoer rat", Call_GBS_Rational },
+   { "adams 12 steps", Call_Adams },
+   { "simpson adaptive", Call_Simpson },
+   { "chebyshev 82 pts", Call_Chebyshev },
+   { "legendre 20 pts", Call_Legendre },
+   { "hermite 20 pts", Call_Hermite }
+};
+
+#define NUMBER_OF_ROUTINES (int) (sizeof(routine) / sizeof(routine[0]))
+
+static double Seconds( void ) {
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (double) t.tv_sec + 1.e-9 * (double) t.tv_nsec;
+}
+
+// The timer, in ticks of the time stamp counter or in nanoseconds. The
+// fences keep the timed call from moving across the reads.
+
+static inline unsigned long long Ticks( void ) {
+#ifdef TIME_STAMP_COUNTER
+   unsigned long long t;
+   unsigned int aux;
+
+   _mm_lfence();
+   t = __rdtscp(&aux);
+   _mm_lfence();
+   return t;
+#else
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (unsigned long long) t.tv_sec * 1000000000ULL + t.tv_nsec;
+#endif
+}
+
+// The number of nanoseconds per tick.
+
+static double Calibrate( void ) {
+#ifdef TIME_STAMP_COUNTER
+   unsigned long long t0;
+   double s0, s;
+
+   s0 = Seconds();
+   t0 = Ticks();
+   do s = Seconds(); while (s - s0 < 0.2);
+   return 1.e9 * (s - s0) / (double) (Ticks() - t0);
+#else
+   return 1.0;
+#endif
+}
+
+// Keep the processor busy so that it leaves its idle state.
+
+static void Warm_Up_Processor( double seconds ) {
+   double s0 = Seconds(), x = 0.0;
+
+   while (Seconds() - s0 < seconds) x += sqrt(x + 1.0);
+   sink = x;
+}
+
+static void Pin( int cpu ) {
+#ifdef __linux__
+   cpu_set_t set;
+
+   CPU_ZERO(&set);
+   CPU_SET(cpu, &set);
+   if (sched_setaffinity(0, sizeof(set), &set) != 0)
+      printf("could not pin to cpu %d\n", cpu);
+   else printf("pinned to cpu %d\n", cpu);
+#else
+   (void) cpu;
+   printf("not pinned\n");
+#endif
+}
+
+static void Print_Governor( int cpu ) {
+   char path[128], governor[64] = "unknown";
+   FILE *fp;
+
+   sprintf(path, "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor", cpu);
+   if ((fp = fopen(path, "r")) != NULL) {
+      if (fscanf(fp, "%63s", governor) != 1) strcpy(governor, "unknown");
+      fclose(fp);
+   }
+   printf("cpufreq governor: %s\n", governor);
+}
+
+static void Evict_Caches( void ) {
+   int i;
+
+   for (i = 0; i < EVICTION_BYTES; i += 64) eviction[i]++;
+}
+
+static int Compare( const void *a, const void *b ) {
+   unsigned long long u = *(const unsigned long long*) a;
+   unsigned long long v = *(const unsigned long long*) b;
+
+   return (u > v) - (u < v);
+}
+
+// Time calls of the routine, or of nothing if call is NULL, and return the
+// sorted latencies in ticks less the overhead.
+
+static void Measure( void (*call)(void), int calls, int cold,
+                    unsigned long long overhead, unsigned long long t[] ) {
+   unsigned long long t0, t1;
+   int i;
+
+   if (!cold)
+      for (i = 0; i < WARM_UP_CALLS; i++) if (call != NULL) (*call)();
+   for (i = 0; i < calls; i++) {
+      if (cold) Evict_Caches();
+      t0 = Ticks();
+      if (call != NULL) (*call)();
+      t1 = Ticks();
+      t[i] = (t1 - t0 > overhead) ? t1 - t0 - overhead : 0;
+   }
+   qsort(t, calls, sizeof(t[0]), Compare);
+}
+
+static double Percentile( unsigned long long t[], int calls, double p,
+                                                       double ns_per_tick ) {
+   int i = (int) ceil(p * calls) - 1;
+
+   if (i < 0) i = 0;
+   return t[i] * ns_per_tick;
+}
+
+static void Print( const char *name, unsigned long long t[], int calls,
+                                                       double ns_per_tick ) {
+   printf("%-20s %9.1lf %9.1lf %9.1lf %9.1lf %10.1lf\n", name,
+            t[0] * ns_per_tick, Percentile( t, calls, 0.5, ns_per_tick ),
+            Percentile( t, calls, 0.99, ns_per_tick ),
+            Percentile( t, calls, 0.999, ns_per_tick ),
+            t[calls - 1] * ns_per_tick);
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned long long *t, overhead;
+   double ns_per_tick;
+   int cpu = (int) sysconf(_SC_NPROCESSORS_ONLN) - 1;
+   int i, cold;
+
+   if (argc > 1) cpu = atoi(argv[1]);
+   t = (unsigned long long*) malloc( WARM_CALLS * sizeof(unsigned long long) );
+   eviction = (char*) calloc( EVICTION_BYTES, 1 );
+   if (t == NULL || eviction == NULL) {
+      printf("Not enough memory\n"); return 1;
+   }
+   Pin( cpu );
+   Print_Governor( cpu );
+   Warm_Up_Processor( 0.5 );
+   ns_per_tick = Calibrate();
+#ifdef TIME_STAMP_COUNTER
+   printf("time stamp counter: %.4lf GHz\n", 1.0 / ns_per_tick);
+#else
+   printf("timer: clock_gettime\n");
+#endif
+   Gauss_Rule_Cached( 0, 20, 0.0, 0.0, &legendre_x, &legendre_A );
+   Measure( NULL, WARM_CALLS, 0, 0, t );
+   overhead = t[0];
+   printf("timer overhead: %.1lf ns (median %.1lf ns), subtracted\n",
+              overhead * ns_per_tick, Percentile( t, WARM_CALLS, 0.5,
+                                                            ns_per_tick ));
+
+   for (cold = 0; cold <= 1; cold++) {
+      printf("\n%s cache, %d calls, latency in ns\n", cold ? "cold" : "warm",
+                                           cold ? COLD_CALLS : WARM_CALLS);
+      printf("routine                    min       p50       p99     p99.9"
+                                                              "        max\n");
+      for (i = 0; i < NUMBER_OF_ROUTINES; i++) {
+         Start_Adams();
+         Measure( routine[i].call, cold ? COLD_CALLS : WARM_CALLS, cold,
+                                                                overhead, t );
+         Print( routine[i].name, t, cold ? COLD_CALLS : WARM_CALLS,
+                                                              ns_per_tick );
+      }
+   }
+   free(t);
+   free(eviction);
+   return 0;
+}
@@ -0,0 +1,56 @@
+#  Measure the latency distribution of single calls of the one step solvers,
+#  of the second order solvers, of a single step of the 12 step Adams method
+#  and of single quadratures.
+#
+#  Dependent on: eulers_method.c, trapezoidal_method.c, runge_kutta_gill.c,
+#  runge_kutta_3_8.c, runge_kutta_nystrom.c, runge_kutta_verner.c,
+#  bulirsch_stoer.c, adams_12_steps.c, simpson_simpson.c,
+#  gauss_chebyshev_82pts.c, gauss_quadrature_rules.c, richardson_adaptive.c,
+#  step_size_controller.c, step_profile_cache.c, vector_kernels.c,
+#  weighted_rms_norm.c, runge_kutta_2nd_order.c, numerov.c,
+#  explicit_central_difference.c, implicit_central_difference.c,
+#  backdiffcorr.c, hermite_quadrature_1_derivative.c, thread_pool.c
+#
+#  After downloading change permissions: chmod 744 bench_latency.sh
+#  Execute as ./bench_latency.sh [cpu]
+#
+#  The process is pinned to the given cpu, by default the last one.  For
+#  reproducible numbers set the cpufreq governor to performance first.
+#
+# Change! if the files are in a different directory.
+gcc -O2 -fopenmp -c -o x1.o eulers_method.c
+gcc -O2 -fopenmp -c -o x2.o trapezoidal_method.c
+gcc -O2 -fopenmp -c -o x3.o runge_kutta_gill.c
+gcc -O2 -fopenmp -c -o x4.o runge_kutta_3_8.c
+gcc -O2 -fopenmp -c -o x5.o runge_kutta_nystrom.c
+gcc -O2 -fopenmp -c -o x6.o runge_kutta_verner.c
+gcc -O2 -fopenmp -c -o x7.o bulirsch_stoer.c
+gcc -O2 -fopenmp -c -o x8.o adams_12_steps.c
+gcc -O2 -fopenmp -c -o x9.o simpson_simpson.c
+gcc -O2 -fopenmp -c -o x10.o gauss_chebyshev_82pts.c
+gcc -O2 -fopenmp -c -o x11.o gauss_quadrature_rules.c
+gcc -O2 -fopenmp -c -o x12.o richardson_adaptive.c
+gcc -O2 -fopenmp -c -o x13.o step_size_controller.c
+gcc -O2 -fopenmp -c -o x14.o step_profile_cache.c
+gcc -O2 -fopenmp -c -o x15.o vector_kernels.c
+gcc -O2 -fopenmp -c -o x16.o weighted_rms_norm.c
+gcc -O2 -fopenmp -c -o x17.o runge_kutta_2nd_order.c
+gcc -O2 -fopenmp -c -o x18.o numerov.c
+gcc -O2 -fopenmp -c -o x19.o explicit_central_difference.c
+gcc -O2 -fopenmp -c -o x20.o implicit_central_difference.c
+gcc -O2 -fopenmp -c -o x21.o backdiffcorr.c
+gcc -O2 -fopenmp -c -o x22.o hermite_quadrature_1_derivative.c
+gcc -O2 -fopenmp -pthread -c -o x23.o thread_pool.c
+
+# Change! if bench_latency.c is in a different directory.
+gcc -O2 -fopenmp -pthread -o blatency bench_latency.c x1.o x2.o x3.o x4.o \
+          x5.o x6.o x7.o x8.o x9.o x10.o x11.o x12.o x13.o x14.o x15.o x16.o \
+                             x17.o x18.o x19.o x20.o x21.o x22.o x23.o -lm
+
+# Change! if you profile has a PATH set to this directory.
+./blatency $1
+
+# Delete temporary files.
+rm blatency
+rm x1.o x2.o x3.o x4.o x5.o x6.o x7.o x8.o x9.o x10.o x11.o x12.o x13.o
+rm x14.o x15.o x16.o x17.o x18.o x19.o x20.o x21.o x22.o x23.o
@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: bench_vector_kernels.c                                               //
+// Purpose:                                                                   //
+//    Measure the memory bandwidth achieved by the vector kernels of the      //
+//    file vector_kernels.c when used by Runge_Kutta_Verner_System for a      //
+//    single very large system.                                               //
+//                                                                            //
+// Solve y' = -y, y(0) = 1 for each of n components, n = 2^24 by default or   //
+// the first command line argument, for 4 steps of size h = 0.01.  The time   //
+// spent in the evaluations of f is measured separately and subtracted, so    //
+// that the bandwidth is that of the vector kernels alone.                    //
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+double* Vector_Alloc( int n );
+void Vector_Free( double v[] );
+double Vector_Kernel_Bytes( void );
+void Vector_Kernel_Reset_Bytes( void );
+void Runge_Kutta_Verner_System( void (*f)(double, double[], double[]),
+                 double y[], int n, double x0, double h, int number_of_steps,
+                                                             double work[] );
+
+static int n = 1 << 24;
+static double f_seconds = 0.0;           // the time spent in f
+
+static double Seconds( void ) {
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (double) t.tv_sec + 1.e-9 * (double) t.tv_nsec;
+}
+
+// y' = f(x,y) = -y, evaluated with the same static schedule as the kernels.
+
+void f(double x, double y[], double dy[]) {
+   double start = Seconds();
+   int i;
+
+   (void) x;
+   #pragma omp parallel for schedule(static) if (n >= 32768)
+   for (i = 0; i < n; i++) dy[i] = -y[i];
+   f_seconds += Seconds() - start;
+}
+
+int main(int argc, char *argv[]) 
+{
+   double *y;
+   double *work;
+   double h = 0.01;
+   double start, elapsed, kernels, bytes;
+   int number_of_steps = 4;
+   int i;
+
+   if (argc > 1) n = atoi(argv[1]);
+   y = Vector_Alloc( n );
+   work = Vector_Alloc( 8 * n );
+   if (y == NULL || work == NULL) { printf("Not enough memory\n"); return 1; }
+   for (i = 0; i < n; i++) y[i] = 1.0;
+
+   Runge_Kutta_Verner_System( f, y, n, 0.0, h, 1, work );     // warm up
+   for (i = 0; i < n; i++) y[i] = 1.0;
+
+   Vector_Kernel_Reset_Bytes();
+   f_seconds = 0.0;
+   start = Seconds();
+   Runge_Kutta_Verner_System( f, y, n, 0.0, h, number_of_steps, work );
+   elapsed = Seconds() - start;
+   kernels = elapsed - f_seconds;
+   bytes = Vector_Kernel_Bytes();
+
+   printf("Runge_Kutta_Verner_System, n = %d, %d steps\n", n, number_of_steps);
+   printf("error at x = %4.2lf          %+9.4le\n", h * number_of_steps,
+                                    y[n-1] - exp(-h * number_of_steps));
+   printf("elapsed time               %9.4lf s\n", elapsed);
+   printf("time in f                  %9.4lf s\n", f_seconds);
+   printf("vector kernel traffic      %9.4lf GB\n", 1.e-9 * bytes);
+   printf("vector kernel bandwidth    %9.4lf GB/s (excluding f)\n",
+                                                     1.e-9 * bytes / kernels);
+   Vector_Free( y );
+   Vector_Free( work );
+   return 0;
+}
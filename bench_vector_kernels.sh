@@ -0,0 +1,30 @@
+#  Measure the bandwidth of the vector kernels in the file vector_kernels.c
+#  used by Runge_Kutta_Verner_System in the file runge_kutta_verner.c
+#
+#  Dependent on: vector_kernels.c, runge_kutta_verner.c, richardson_adaptive.c,
+#                step_size_controller.c, thread_pool.c
+#
+#  After downloading change permissions: chmod 744 bench_vector_kernels.sh
+#  Execute as ./bench_vector_kernels.sh [n]
+#
+#  Set OMP_NUM_THREADS and OMP_PROC_BIND=close (or spread) to control the
+#  threads and their placement.
+#
+# Change! if vector_kernels.c, runge_kutta_verner.c, richardson_adaptive.c,
+# step_size_controller.c or thread_pool.c are in a different directory.
+gcc -O3 -march=native -fopenmp -c -o x1.o vector_kernels.c
+gcc -O3 -march=native -fopenmp -c -o x2.o runge_kutta_verner.c
+gcc -O3 -march=native -fopenmp -c -o x3.o richardson_adaptive.c
+gcc -O3 -march=native -fopenmp -c -o x4.o step_size_controller.c
+gcc -O3 -march=native -fopenmp -pthread -c -o x5.o thread_pool.c
+
+# Change! if bench_vector_kernels.c is in a different directory.
+gcc -O3 -march=native -fopenmp -pthread -o bvers bench_vector_kernels.c \
+                                                 x1.o x2.o x3.o x4.o x5.o -lm
+
+# Change! if you profile has a PATH set to this directory.
+./bvers $1
+
+# Delete temporary files.
+rm bvers
+rm x1.o x2.o x3.o x4.o x5.o
@@ -2,6 +2,9 @@
 // File: bulirsch_stoer.c                                                     //
 // Routines:                                                                  //
 //    Gragg_Bulirsch_Stoer                                                    //
+//    Gragg_Bulirsch_Stoer_Fixed_Depth                                        //
+//    Gragg_Bulirsch_Stoer_System                                             //
+//    Gragg_Bulirsch_Stoer_System_Integrate                                   //
 ////////////////////////////////////////////////////////////////////////////////
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -20,10 +23,12 @@
 
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>                            // required for malloc()
+#include <float.h>                              // required for DBL_EPSILON
 
 static int number_of_steps[] = { 2,4,6,8,12,16,24,32,48,64,96,128 };
 
-#define ATTEMPTS sizeof(number_of_steps)/sizeof(number_of_steps[0])
+#define ATTEMPTS ((int) (sizeof(number_of_steps) / sizeof(number_of_steps[0])))
 
 static double Graggs_Method( double (*f)(double, double), double y0, double x0,
                                               double x, int number_of_steps );
@@ -31,6 +36,25 @@ static int Rational_Extrapolation_to_Zero( double *fzero, double tableau[],
                                                double x[], double f, int n );
 static int Polynomial_Extrapolation_to_Zero( double *fzero, double tableau[], 
                                                 double x[], double f, int n );
+static void Graggs_Method_System( void (*f)(double, double[], double[]),
+              double y0[], double est[], int n, double x0, double x,
+                                     int number_of_steps, double work[] );
+static int Extrapolated_Step( void (*f)(double, double[], double[]),
+            double y0[], double y1[], int n, double x, double h, double *h_new,
+            double atol[], double rtol[], int rational_extrapolate,
+                           int min_columns, int *columns, double *error );
+
+double Weighted_RMS_Error_Norm( double y_new[], double y_old[], double y0[],
+                                   double atol[], double rtol[], int n );
+int Step_Profile_Begin( int family );
+int Step_Profile_Record( int family, double x, double h, int columns );
+int Step_Profile_End( int family );
+int Step_Profile_Predict( int family, double x, double *h, int *columns );
+struct Step_Controller;
+void Step_Controller_Reset( struct Step_Controller *c );
+void Step_Controller_Set_Order( struct Step_Controller *c, double order );
+double Step_Controller_Next( struct Step_Controller *c, double h,
+                                                double error, int *accept );
 
 ////////////////////////////////////////////////////////////////////////////////
 // int Gragg_Bulirsch_Stoer( double (*f)(double, double), double y0,          //
@@ -145,6 +169,383 @@ int Gragg_Bulirsch_Stoer( double (*f)(double, double), double y0, double *y1,
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+// int Gragg_Bulirsch_Stoer_Fixed_Depth( double (*f)(double, double),         //
+//            double y0, double *y1, double x, double h, int depth,           //
+//                                  int rational_extrapolate, double *error ) //
+//                                                                            //
+//  Description:                                                              //
+//     A version of Gragg_Bulirsch_Stoer above for real-time use, in which    //
+//     the number of extrapolation columns is fixed instead of depending on   //
+//     the convergence of the estimates.  Gragg's method is applied exactly   //
+//     depth times, with 2, 4, 6, 8, 12, ... substeps, and the results are    //
+//     extrapolated to zero step size, so that f(x,y) is evaluated 3, 8, 15,  //
+//     24, 37, 54, 79, 112, 161, 226, 323 or 452 times for depth = 1,...,12.  //
+//     If the extrapolated estimates agree to the rounding error before the   //
+//     last column, which would make the extrapolation divide by zero, the    //
+//     remaining columns are skipped, so that these numbers are upper         //
+//     bounds.  No memory is allocated.  The caller controls the accuracy     //
+//     through h and depth, using *error, the difference of the last two      //
+//     extrapolated estimates, to monitor it.                                 //
+//                                                                            //
+//  Arguments:                                                                //
+//     double *f                                                              //
+//        Pointer to the function which returns the slope at (x,y) of         //
+//        integral curve of the differential equation y' = f(x,y).            //
+//     double y0                                                              //
+//        The initial value of y at x.                                        //
+//     double *y1                                                             //
+//        The pointer to the value of y at x + h.                             //
+//     double x                                                               //
+//        Initial value of x.                                                 //
+//     double h                                                               //
+//        Step size, x + h is abscissa for the return value.                  //
+//     int    depth                                                           //
+//        The number of extrapolation columns, 1 <= depth <= 12.              //
+//     int    rational_extrapolate                                            //
+//        A flag which if non-zero, then rational extrapolation to zero is    //
+//        used and if zero, then polynomial extrapolation to zero is used.    //
+//     double *error                                                          //
+//        If not NULL, the magnitude of the difference of the last two        //
+//        extrapolated estimates, 0 if depth = 1.                             //
+//                                                                            //
+//  Return Values:                                                            //
+//     The solution of y' = f(x,y) at x + h starting with y0 at x is          //
+//     returned via *y1.                                                      //
+//     The function returns:                                                  //
+//         0 if success                                                       //
+//        -3 if depth is out of range.                                        //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Gragg_Bulirsch_Stoer_Fixed_Depth( double (*f)(double, double), double y0,
+                              double *y1, double x, double h, int depth,
+                                  int rational_extrapolate, double *error ) {
+
+   double step_size2[ATTEMPTS];
+   double tableau[ATTEMPTS+1];
+   double dum;
+   double est;
+   double old_est;
+   double difference = 0.0;
+   int i;
+   int err;
+
+   if (depth < 1 || depth > ATTEMPTS) return -3;
+   for (i = 0; i < depth; i++) {
+      old_est = *y1;
+      est = Graggs_Method( f, y0, x, x+h, number_of_steps[i] );
+      step_size2[i] = (dum = h / (double) number_of_steps[i], dum * dum);
+      if (i == 0) *y1 = est;
+      if (rational_extrapolate)
+         err = Rational_Extrapolation_to_Zero(y1, tableau, step_size2, est, i);
+      else
+         err = Polynomial_Extrapolation_to_Zero(y1, tableau, step_size2, est,
+                                                                         i);
+      if (err < 0) break;
+      if (i > 0) difference = fabs(*y1 - old_est);
+   }
+   if (error != NULL) *error = difference;
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// int Gragg_Bulirsch_Stoer_System( void (*f)(double, double[], double[]),    //
+//       double y0[], double y1[], int n, double x, double h, double *h_new,  //
+//       double atol[], double rtol[], int rational_extrapolate,              //
+//                                              int *columns, double *error ) //
+//                                                                            //
+//  Description:                                                              //
+//     This function solves the system of differential equations y'=f(x,y),   //
+//     where y is an n-vector, with the initial condition y=y0[] at x.  The   //
+//     value returned is y1[] which is the value of y evaluated at x + h,     //
+//     h_new is the predicted step size so that the accuracy is maintained.   //
+//     Each component is extrapolated separately as in Gragg_Bulirsch_Stoer   //
+//     above.  The procedure terminates when the weighted root-mean-square    //
+//     norm of the difference of two successive extrapolated estimates,       //
+//     using the tolerance atol[i] + rtol[i] * max(|y0[i]|,|y1[i]|) for the   //
+//     i-th component, is not greater than 1.                                 //
+//                                                                            //
+//  Arguments:                                                                //
+//     void (*f)(double x, double y[], double dy[])                           //
+//        Pointer to the function which evaluates the derivatives             //
+//        dy[i] = f[i](x,y), i = 0,...,n-1, at (x,y[]).                       //
+//     double y0[]                                                            //
+//        The initial value of y at x.                                        //
+//     double y1[]                                                            //
+//        The value of y at x + h.  y1[] must be dimensioned at least n in    //
+//        the calling routine and must not overlap y0[].                      //
+//     int    n                                                               //
+//        The number of equations, n > 0.                                     //
+//     double x                                                               //
+//        Initial value of x.                                                 //
+//     double h                                                               //
+//        Step size, x + h is abscissa for the return value.                  //
+//     double *h_new                                                          //
+//        The pointer to the new step size required to maintain accuracy.     //
+//     double atol[]                                                          //
+//        The absolute tolerance of each component.                           //
+//     double rtol[]                                                          //
+//        The relative tolerance of each component.  For each component       //
+//        atol[i] + rtol[i] * |y[i]| must be positive.                        //
+//     int    rational_extrapolate                                            //
+//        A flag which if non-zero, then rational extrapolation to zero is    //
+//        used and if zero, then polynomial extrapolation to zero is used.    //
+//     int    *columns                                                        //
+//        If not NULL, the number of extrapolation columns, i.e. the number   //
+//        of calls to Gragg's method, used.                                   //
+//     double *error                                                          //
+//        If not NULL, the weighted root-mean-square norm of the difference   //
+//        of the final two extrapolated estimates.                            //
+//                                                                            //
+//  Return Values:                                                            //
+//     The solution of y' = f(x,y) at x + h starting with y0[] at x is        //
+//     returned in y1[].                                                      //
+//     The function returns:                                                  //
+//         0 if success                                                       //
+//        -1 if the process failed to converge                                //
+//        -2 if an attempt was made to divide by zero .                       //
+//        -4 if memory could not be allocated for the working storage.        //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Gragg_Bulirsch_Stoer_System( void (*f)(double, double[], double[]),
+            double y0[], double y1[], int n, double x, double h, double *h_new,
+            double atol[], double rtol[], int rational_extrapolate,
+                                              int *columns, double *error ) {
+
+   return Extrapolated_Step( f, y0, y1, n, x, h, h_new, atol, rtol,
+                             rational_extrapolate, 0, columns, error );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static int Extrapolated_Step( void (*f)(double, double[], double[]),      //
+//       double y0[], double y1[], int n, double x, double h, double *h_new,  //
+//       double atol[], double rtol[], int rational_extrapolate,              //
+//                     int min_columns, int *columns, double *error )         //
+//                                                                            //
+//  Description:                                                              //
+//     The step of Gragg_Bulirsch_Stoer_System() in which a step is not       //
+//     accepted before the extrapolation has reached min_columns columns.     //
+//     Gragg_Bulirsch_Stoer_System() passes 0, testing from the second        //
+//     column on.  If the tableau breaks down (an attempt to divide by zero)  //
+//     after the last two estimates had agreed, the step is accepted with     //
+//     the last estimate.                                                     //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static int Extrapolated_Step( void (*f)(double, double[], double[]),
+            double y0[], double y1[], int n, double x, double h, double *h_new,
+            double atol[], double rtol[], int rational_extrapolate,
+                           int min_columns, int *columns, double *error ) {
+
+   double step_size2[ATTEMPTS];
+   double dum;
+   double norm = 0.0;
+   double *tableau;
+   double *est;
+   double *old_est;
+   double *work;
+
+   int (*Extrapolate)(double*,double*,double*,double,int);
+   int i, j;
+   int err = 0;
+   int rc = -1;
+   int converged = 0;
+
+   if (rational_extrapolate) Extrapolate = Rational_Extrapolation_to_Zero;
+   else Extrapolate = Polynomial_Extrapolation_to_Zero;
+
+         /* Working storage: a tableau of ATTEMPTS + 1 entries for each */
+         /* component, the current and previous estimates and three     */
+         /* vectors for Gragg's method.                                 */
+
+   tableau = (double*) malloc( (ATTEMPTS + 6) * n * sizeof(double) );
+   if (tableau == NULL) return -4;
+   est = tableau + (ATTEMPTS + 1) * n;
+   old_est = est + n;
+   work = old_est + n;
+
+   Graggs_Method_System( f, y0, est, n, x, x+h, number_of_steps[0], work );
+   step_size2[0] = (dum = h / (double) number_of_steps[0], dum * dum);
+   for (j = 0; j < n; j++) {
+      y1[j] = est[j];
+      Extrapolate(&y1[j], &tableau[j * (ATTEMPTS+1)], step_size2, est[j], 0);
+   }
+
+       /* Continue with smaller step sizes and halt when the weighted   */
+       /* RMS norm of the difference of successive extrapolated values  */
+       /* is at most 1.                                                 */
+
+   for (i = 1; i < ATTEMPTS; i++) {
+      for (j = 0; j < n; j++) old_est[j] = y1[j];
+      Graggs_Method_System( f, y0, est, n, x, x+h, number_of_steps[i], work );
+      step_size2[i] = (dum = h / (double) number_of_steps[i], dum * dum);
+      for (j = 0; j < n; j++) {
+         err = Extrapolate(&y1[j], &tableau[j * (ATTEMPTS+1)], step_size2,
+                                                                  est[j], i);
+         if (err < 0) break;
+      }
+
+           /* If the tableau breaks down after the estimates have already */
+           /* agreed at a column before min_columns, accept those.        */
+
+      if (err < 0) {
+         if (!converged) { rc = err - 1; break; }
+         for (j = 0; j < n; j++) y1[j] = old_est[j];
+         i--;
+      }
+      else {
+         norm = Weighted_RMS_Error_Norm( y1, old_est, y0, atol, rtol, n );
+         converged = ( norm <= 1.0 );
+         if ( !converged || i + 1 < min_columns ) continue;
+      }
+      if (i > 1) *h_new = 8.0 * h / (double) number_of_steps[i-1];
+      else *h_new = h;
+      rc = 0;
+      break;
+   }
+   if (columns != NULL) *columns = (i < ATTEMPTS) ? i + 1 : ATTEMPTS;
+   if (error != NULL) *error = norm;
+   free(tableau);
+   return rc;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// int Gragg_Bulirsch_Stoer_System_Integrate(                                 //
+//       void (*f)(double, double[], double[]), double y[], int n, double x0, //
+//       double x1, double h, double atol[], double rtol[],                   //
+//       int rational_extrapolate, int family,                                //
+//       struct Step_Controller *controller, int *rejections )                //
+//                                                                            //
+//  Description:                                                              //
+//     This function integrates the system y' = f(x,y) from x0 to x1 by       //
+//     repeated calls to Gragg_Bulirsch_Stoer_System().  If a step fails the  //
+//     step size is divided by 4 and the step is retried.  A step in which an //
+//     attempt was made to divide by zero is also retried with a smaller step.//
+//                                                                            //
+//     If family >= 0, the step sizes are taken from the step profile cache   //
+//     (see step_profile_cache.c) of the trajectory family 'family' where a   //
+//     profile exists, and the accepted steps of this run are recorded as the //
+//     profile for the next run of the family.  The number of extrapolation   //
+//     columns c recorded with a proposed step starts the extrapolation of    //
+//     the step: convergence is first tested at column c - 1, so that a step  //
+//     sized for c columns is not accepted on an early, accidental agreement  //
+//     of two low order estimates.  A proposed step which fails is treated as //
+//     any other failed step, and the predictions are not used again until a  //
+//     step proposed by the integrator itself has succeeded.                  //
+//                                                                            //
+//     If controller is not NULL, the step sizes proposed by the integrator   //
+//     are taken from the step size controller (see step_size_controller.c)   //
+//     instead of 8h / (steps of the last but one column), and a step which   //
+//     fails to converge is retried with the step size it proposes.  The      //
+//     order passed to the controller is 2c - 1 where c is the number of      //
+//     extrapolation columns used, the order of the error estimate of the     //
+//     last but one extrapolated value.  A step in which an attempt was made  //
+//     to divide by zero is still retried with h / 4.                         //
+//                                                                            //
+//  Arguments:                                                                //
+//     void (*f)(double x, double y[], double dy[])                           //
+//        Pointer to the function which evaluates the derivatives.            //
+//     double y[]                                                             //
+//        On input the initial value of y at x0, on output the value at x1.   //
+//     int    n                                                               //
+//        The number of equations.                                            //
+//     double x0                                                              //
+//        The initial value of x.                                             //
+//     double x1                                                              //
+//        The final value of x, x1 > x0.                                      //
+//     double h                                                               //
+//        The initial step size used if no prediction is available.           //
+//     double atol[], rtol[]                                                  //
+//        The absolute and relative tolerances of each component.             //
+//     int    rational_extrapolate                                            //
+//        Non-zero for rational extrapolation, zero for polynomial.           //
+//     int    family                                                          //
+//        The key of the trajectory family, or -1 to disable the cache.       //
+//     struct Step_Controller *controller                                     //
+//        The step size controller created by Step_Controller_Create(), or    //
+//        NULL for the step size rule of Gragg_Bulirsch_Stoer_System().       //
+//     int    *rejections                                                     //
+//        If not NULL, the number of failed steps.                            //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if success, -1 or -2 if a step still failed after reducing the step  //
+//     size MAX_REJECTIONS times in succession or to the rounding level of x  //
+//     (-2 if the last failure was an attempt to divide by zero) and -4 if    //
+//     memory could not be allocated.                                         //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+#define MAX_REJECTIONS 20
+
+int Gragg_Bulirsch_Stoer_System_Integrate( 
+     void (*f)(double, double[], double[]), double y[], int n, double x0, 
+     double x1, double h, double atol[], double rtol[],
+                        int rational_extrapolate, int family,
+                        struct Step_Controller *controller, int *rejections ) {
+
+   double *y1;
+   double h_new;
+   double h_used;
+   double error;
+   int columns;
+   int accept;
+   int failures = 0;
+   int total_failures = 0;
+   int use_profile = (family >= 0);
+   int predicted;
+   int min_columns;
+   int last;
+   int err = 0;
+   int i;
+
+   y1 = (double*) malloc( n * sizeof(double) );
+   if (y1 == NULL) return -4;
+   if (family >= 0 && Step_Profile_Begin(family) != 0) family = -1;
+   if (controller != NULL) Step_Controller_Reset( controller );
+
+   while ( x0 < x1 && err == 0 ) {
+      h_used = h;
+      predicted = 0;
+      if (use_profile && failures == 0)
+         predicted = Step_Profile_Predict( family, x0, &h_used, &columns );
+      last = ( x0 + h_used >= x1 - 16.0 * DBL_EPSILON
+                                             * fmax(fabs(x0), fabs(x1)) );
+      if (last) h_used = x1 - x0;
+      min_columns = (predicted && !last) ? columns - 1 : 0;
+
+      err = Extrapolated_Step( f, y, y1, n, x0, h_used, &h_new, atol, rtol,
+                     rational_extrapolate, min_columns, &columns, &error );
+      if (controller != NULL && (err == 0 || err == -1)) {
+         Step_Controller_Set_Order( controller, 2.0 * columns - 1.0 );
+         h_new = Step_Controller_Next( controller, h_used,
+                                                       error, &accept );
+      }
+      if (err == -1 || err == -2) {
+         if (predicted) use_profile = 0;
+         total_failures++;
+         if (++failures > MAX_REJECTIONS) break;
+         h = (controller != NULL && err == -1) ? h_new : 0.25 * h_used;
+         if ( h <= 16.0 * DBL_EPSILON * fmax(fabs(x0), fabs(x1)) ) break;
+         err = 0;
+         continue;
+      }
+      if (err < 0) break;
+      if (family >= 0) Step_Profile_Record( family, x0, h_used, columns );
+      if (!predicted) use_profile = (family >= 0);
+      failures = 0;
+      x0 = (last) ? x1 : x0 + h_used;
+      for (i = 0; i < n; i++) y[i] = y1[i];
+      h = h_new;
+   }
+   if (family >= 0 && err == 0) Step_Profile_End( family );
+   if (rejections != NULL) *rejections = total_failures;
+   free(y1);
+   return err;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 //  double Graggs_Method( double (*f)(double, double), double y0, double x0,  //
 //                                          double x, int number_of_steps );  //
@@ -210,6 +611,58 @@ static double Graggs_Method( double (*f)(double, double), double y0, double x0,
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+//  static void Graggs_Method_System( void (*f)(double, double[], double[]),  //
+//              double y0[], double est[], int n, double x0, double x,        //
+//                                      int number_of_steps, double work[] )  //
+//                                                                            //
+//  Description:                                                              //
+//     Gragg's method, as described for Graggs_Method() above, applied to     //
+//     the system y' = f(x,y), where y is an n-vector.                        //
+//                                                                            //
+//  Arguments:                                                                //
+//     void (*f)  Pointer to the function which evaluates the derivatives     //
+//                dy[] = f(x,y[]).                                            //
+//     double y0[] The initial value of y at x0.                              //
+//     double est[] The estimate of y(x).                                     //
+//     int    n   The number of equations.                                    //
+//     double x0  Initial value of x.                                         //
+//     double x   Final value of x.                                           //
+//     int    number_of_steps  The number_of_steps must be a positive even    //
+//                integer.  The step size h is (x - x0) / number_of_steps.    //
+//     double work[] Working storage of dimension at least 3 * n.             //
+//                                                                            //
+//  Return Values:                                                            //
+//     The estimate of y(x) is returned in est[].                             //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static void Graggs_Method_System( void (*f)(double, double[], double[]),
+              double y0[], double est[], int n, double x0, double x,
+                                     int number_of_steps, double work[] ) {
+
+   double h = (x - x0) / (double) number_of_steps;
+   double h2 =  h + h;
+   double *ym = work;
+   double *yn = work + n;
+   double *dy = work + n + n;
+   double *tmp;
+   int j;
+
+   (*f)(x0, y0, dy);
+   for (j = 0; j < n; j++) { ym[j] = y0[j]; yn[j] = y0[j] + h * dy[j]; }
+
+   while ( --number_of_steps ) {
+      x0 += h;
+      (*f)(x0, yn, dy);
+      for (j = 0; j < n; j++) ym[j] += h2 * dy[j];
+      tmp = ym; ym = yn; yn = tmp;
+   }
+   (*f)(x, yn, dy);
+   for (j = 0; j < n; j++) est[j] = 0.5 * ( ym[j] + yn[j] + h * dy[j] );
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 //  static int Rational_Extrapolation_to_Zero( double *fzero,                 //
 //                             double tableau[], double *x, double f, int n ) //
@@ -0,0 +1,316 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: chebyshev_approximation.c                                            //
+// Routines:                                                                  //
+//    Chebyshev_Coefficients                                                  //
+//    Chebyshev_Coefficients_From_Zeros                                       //
+//    Chebyshev_Approximation                                                 //
+//    Chebyshev_Evaluate                                                      //
+//    Chebyshev_Evaluate_Array                                                //
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Description:                                                              //
+//     A function f(x) which is expensive to evaluate but smooth on [a,b]     //
+//     may be replaced by its Chebyshev interpolant                           //
+//            p(x) = c[0]/2 + c[1] T1(t) + ... + c[n-1] T(n-1)(t),            //
+//     where t = (2x - a - b) / (b - a) and Tj(t) = cos(j arccos(t)).  The    //
+//     interpolant agrees with f at the n zeros of Tn,                        //
+//            t[k] = cos( pi (k + 1/2) / n ),  k = 0,...,n-1,                 //
+//     and the coefficients are given by the discrete cosine transform        //
+//            c[j] = (2/n) Sum f(x[k]) cos( pi j (k + 1/2) / n ).             //
+//     For a smooth f the coefficients decrease rapidly, so that a modest n   //
+//     reproduces f to near machine precision, and p(x) is then evaluated by  //
+//     Clenshaw's recurrence in O(n) operations:                              //
+//            b[n] = b[n+1] = 0,  b[j] = 2 t b[j+1] - b[j+2] + c[j],          //
+//            p(x) = t b[1] - b[2] + c[0]/2.                                  //
+//                                                                            //
+//     Chebyshev_Approximation() chooses n adaptively.  Since the zeros of    //
+//     Tn are also zeros of T3n, n is tripled until the coefficients of the   //
+//     highest third of the degrees are negligible, each function value being //
+//     computed once.                                                         //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+#include <math.h>                               // required for cos(), fabs()
+#include <stdlib.h>                             // required for malloc()
+
+#define PI 3.14159265358979323846264338327950288
+
+#define INITIAL_N 9
+#define EVALUATION_BLOCK 64
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Chebyshev_Coefficients( double fx[], int n, double c[] )              //
+//                                                                            //
+//  Description:                                                              //
+//     Computes the coefficients c[0],...,c[n-1] of the Chebyshev interpolant //
+//     given fx[k] = f(x[k]), where x[k] corresponds to t[k] =                //
+//     cos( pi (k + 1/2) / n ), k = 0,...,n-1, i.e. in decreasing order.      //
+//                                                                            //
+//  Arguments:                                                                //
+//     double fx[]  The function values, dimensioned at least n.              //
+//     int    n     The number of interpolation points, n >= 1.               //
+//     double c[]   The coefficients, dimensioned at least n.  c[] must not   //
+//                  be fx[].                                                  //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -2 if memory could not be allocated.                  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Chebyshev_Coefficients( double fx[], int n, double c[] ) {
+
+   double *cosine;
+   double sum;
+   double scale = 2.0 / (double) n;
+   int n4 = 4 * n;
+   int j, k, m;
+
+         // cos( pi j (2k + 1) / (2n) ) = cosine[ j (2k+1) mod 4n ]  //
+
+   cosine = (double*) malloc( n4 * sizeof(double) );
+   if (cosine == NULL) return -2;
+   for (m = 0; m < n4; m++) cosine[m] = cos( PI * (double) m / (2.0 * n) );
+
+   for (j = 0; j < n; j++) {
+      sum = 0.0;
+      m = j;
+      for (k = 0; k < n; k++) {
+         sum += fx[k] * cosine[m];
+         m += j + j;
+         if (m >= n4) m %= n4;
+      }
+      c[j] = scale * sum;
+   }
+   free(cosine);
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Chebyshev_Coefficients_From_Zeros( double fz[], int n, double c[] )   //
+//                                                                            //
+//  Description:                                                              //
+//     As Chebyshev_Coefficients() but the function values are given at the   //
+//     zeros of Tn in increasing order, i.e. fz[i] = f(z[i]) where z[] are    //
+//     the zeros returned by Gauss_Chebyshev_Zeros_82pts(),                   //
+//     Gauss_Chebyshev_Zeros_96pts() or Gauss_Chebyshev_Zeros_100pts() for    //
+//     n = 82, 96 or 100, mapped to [a,b].                                    //
+//                                                                            //
+//  Arguments:                                                                //
+//     double fz[]  The function values, dimensioned at least n.              //
+//     int    n     The number of interpolation points, n >= 1.               //
+//     double c[]   The coefficients, dimensioned at least n.                 //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -2 if memory could not be allocated.                  //
+//                                                                            //
+//  Example:                                                                  //
+//     double z[82], fz[82], c[82];                                           //
+//     int i;                                                                 //
+//                                                                            //
+//     Gauss_Chebyshev_Zeros_82pts( z );                                      //
+//     for (i = 0; i < 82; i++) fz[i] = f( 0.5*(a+b) + 0.5*(b-a)*z[i] );      //
+//     Chebyshev_Coefficients_From_Zeros( fz, 82, c );                        //
+//     y = Chebyshev_Evaluate( c, 82, a, b, x );                              //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Chebyshev_Coefficients_From_Zeros( double fz[], int n, double c[] ) {
+
+   double *fx;
+   int k, err;
+
+   fx = (double*) malloc( n * sizeof(double) );
+   if (fx == NULL) return -2;
+   for (k = 0; k < n; k++) fx[k] = fz[n-1-k];
+   err = Chebyshev_Coefficients( fx, n, c );
+   free(fx);
+   return err;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  double* Chebyshev_Approximation( double (*f)(double), double a, double b, //
+//                      double tolerance, int max_n, int *n, int *err )       //
+//                                                                            //
+//  Description:                                                              //
+//     Computes the Chebyshev interpolant of f on [a,b] with n chosen         //
+//     adaptively: n = 9, 27, 81, ... is tripled until the sum of the         //
+//     magnitudes of the coefficients of the highest third of the degrees is  //
+//     less than the tolerance.  The negligible trailing coefficients, whose  //
+//     magnitudes sum to less than half the tolerance, are then dropped.      //
+//                                                                            //
+//  Arguments:                                                                //
+//     double *f         Pointer to the function to approximate.              //
+//     double a          The lower limit of the interval.                     //
+//     double b          The upper limit of the interval.                     //
+//     double tolerance  The acceptable absolute error of the interpolant.    //
+//     int    max_n      The maximum number of interpolation points.          //
+//     int    *n         The number of coefficients returned.                 //
+//     int    *err       0 if successful, -1 if the tolerance was not reached //
+//                       with at most max_n points (the last interpolant is   //
+//                       returned), -2 if memory could not be allocated.      //
+//                                                                            //
+//  Return Values:                                                            //
+//     The array of *n coefficients, which the caller must free(), or NULL    //
+//     if memory could not be allocated.                                      //
+//                                                                            //
+//  Example:                                                                  //
+//     double *c;                                                             //
+//     int n, err;                                                            //
+//                                                                            //
+//     c = Chebyshev_Approximation( equation_of_state, 0.0, 1.0, 1.e-13,      //
+//                                                        6561, &n, &err );   //
+//     ...                                                                    //
+//     p = Chebyshev_Evaluate( c, n, 0.0, 1.0, x );                           //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double* Chebyshev_Approximation( double (*f)(double), double a, double b,
+                         double tolerance, int max_n, int *n, int *err ) {
+
+   double *fx = NULL;
+   double *c = NULL;
+   double *p;
+   double mid = 0.5 * (a + b);
+   double half = 0.5 * (b - a);
+   double tail;
+   int m = INITIAL_N;
+   int k, j;
+
+   *err = -2;
+   *n = 0;
+   if (max_n < 1) max_n = 1;
+   if (m > max_n) m = max_n;
+   fx = (double*) malloc( m * sizeof(double) );
+   c = (double*) malloc( m * sizeof(double) );
+   if (fx == NULL || c == NULL) { free(fx); free(c); return NULL; }
+   for (k = 0; k < m; k++) fx[k] = (*f)( mid + half * cos(PI * (k + 0.5) / m) );
+
+   while (1) {
+      if ( Chebyshev_Coefficients( fx, m, c ) ) { free(fx); free(c); return NULL; }
+      tail = 0.0;
+      for (j = m - m / 3; j < m; j++) tail += fabs(c[j]);
+      if (tail < tolerance) { *err = 0; break; }
+      if (3 * m > max_n) { *err = -1; break; }
+
+             // Triple the number of points, reusing the values at the //
+             // old points, which are every third new point.           //
+
+      p = (double*) realloc( fx, 3 * m * sizeof(double) );
+      if (p == NULL) { free(fx); free(c); return NULL; }
+      fx = p;
+      for (k = m - 1; k >= 0; k--) fx[3*k+1] = fx[k];
+      m *= 3;
+      for (k = 0; k < m; k++)
+         if (k % 3 != 1) fx[k] = (*f)( mid + half * cos(PI * (k + 0.5) / m) );
+      p = (double*) realloc( c, m * sizeof(double) );
+      if (p == NULL) { free(fx); free(c); return NULL; }
+      c = p;
+   }
+   free(fx);
+
+                 // Drop the negligible trailing coefficients. //
+
+   tail = 0.0;
+   for (j = m - 1; j > 0; j--) {
+      tail += fabs(c[j]);
+      if (tail >= 0.5 * tolerance) break;
+   }
+   *n = j + 1;
+   p = (double*) realloc( c, *n * sizeof(double) );
+   return (p == NULL) ? c : p;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  double Chebyshev_Evaluate( double c[], int n, double a, double b,         //
+//                                                                double x )  //
+//                                                                            //
+//  Description:                                                              //
+//     Evaluates the Chebyshev series with coefficients c[0],...,c[n-1] on    //
+//     [a,b] at x by Clenshaw's recurrence.                                   //
+//                                                                            //
+//  Arguments:                                                                //
+//     double c[]  The coefficients.                                          //
+//     int    n    The number of coefficients, n >= 1.                        //
+//     double a    The lower limit of the interval.                           //
+//     double b    The upper limit of the interval.                           //
+//     double x    The argument, a <= x <= b.                                 //
+//                                                                            //
+//  Return Values:                                                            //
+//     The value of the series at x.                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double Chebyshev_Evaluate( double c[], int n, double a, double b, double x ) {
+
+   double t = (2.0 * x - a - b) / (b - a);
+   double t2 = t + t;
+   double b0 = 0.0, b1 = 0.0, b2;
+   int j;
+
+   for (j = n - 1; j >= 1; j--) {
+      b2 = b1;
+      b1 = b0;
+      b0 = t2 * b1 - b2 + c[j];
+   }
+   return t * b0 - b1 + 0.5 * c[0];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Chebyshev_Evaluate_Array( double c[], int n, double a, double b,     //
+//                                         double x[], double fx[], int m )   //
+//                                                                            //
+//  Description:                                                              //
+//     Evaluates the Chebyshev series at x[0],...,x[m-1].  The points are     //
+//     processed in blocks of EVALUATION_BLOCK with the recurrence of all the //
+//     points of a block advanced together, so that the inner loop runs over  //
+//     independent points and is vectorized by the compiler.  The signature   //
+//     is that of the batch integrands of Simpson_Simpson_Adaptive_Batch()    //
+//     and Gauss_Rule_Integration_Batch() apart from the leading arguments.   //
+//                                                                            //
+//  Arguments:                                                                //
+//     double c[]   The coefficients.                                         //
+//     int    n     The number of coefficients, n >= 1.                       //
+//     double a     The lower limit of the interval.                          //
+//     double b     The upper limit of the interval.                          //
+//     double x[]   The arguments, a <= x[i] <= b.                            //
+//     double fx[]  The values of the series, fx[] may be x[].                //
+//     int    m     The number of arguments.                                  //
+//                                                                            //
+//  Return Values:                                                            //
+//     none                                                                   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Chebyshev_Evaluate_Array( double c[], int n, double a, double b,
+                                        double x[], double fx[], int m ) {
+
+   double t2[EVALUATION_BLOCK];
+   double b0[EVALUATION_BLOCK];
+   double b1[EVALUATION_BLOCK];
+   double b2;
+   double scale = 2.0 / (b - a);
+   double shift = (a + b) / (b - a);
+   int i, j, k, len;
+
+   for (i = 0; i < m; i += EVALUATION_BLOCK) {
+      len = (m - i < EVALUATION_BLOCK) ? m - i : EVALUATION_BLOCK;
+      for (k = 0; k < len; k++) {
+         t2[k] = 2.0 * (scale * x[i+k] - shift);
+         b0[k] = 0.0;
+         b1[k] = 0.0;
+      }
+      for (j = n - 1; j >= 1; j--) {
+         #pragma omp simd private(b2)
+         for (k = 0; k < len; k++) {
+            b2 = b1[k];
+            b1[k] = b0[k];
+            b0[k] = t2[k] * b1[k] - b2 + c[j];
+         }
+      }
+      for (k = 0; k < len; k++)
+         fx[i+k] = 0.5 * t2[k] * b0[k] - b1[k] + 0.5 * c[0];
+   }
+}
@@ -0,0 +1,252 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: cumulative_quadrature.c                                              //
+// Routines:                                                                  //
+//    Cumulative_Integral                                                     //
+//    Cumulative_Integral_Mapped                                              //
+//    Cumulative_Integral_Unmap                                               //
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Description:                                                              //
+//     Given the points a = x[0] < x[1] < ... < x[n-1], the routines below    //
+//     tabulate the antiderivative                                            //
+//                  F[i] = Integral from x[0] to x[i] of f(x) dx,             //
+//     i = 0,...,n-1, in O(n) evaluations of f instead of integrating anew    //
+//     from x[0] to each x[i].                                                //
+//                                                                            //
+//     The integral over each panel [x[i-1],x[i]] is approximated by the 8    //
+//     point Gauss-Legendre formula, which is exact for polynomials of degree //
+//     at most 15, so the panels are usually the output spacing itself.  The  //
+//     panel integrals are then accumulated by a blocked prefix scan:         //
+//       (1) the points are divided into blocks of SCAN_BLOCK panels, and for //
+//           each block the panel integrals and their running sum are formed  //
+//           with Kahan's compensated summation,                              //
+//       (2) the totals of the blocks are summed, again compensated, to give  //
+//           the value of F at the start of each block, and                   //
+//       (3) the start value is added to each entry of the block.             //
+//     Steps (1) and (3) are independent from block to block and, if compiled //
+//     with OpenMP (e.g. gcc -fopenmp), are distributed among the threads, in //
+//     which case f() must be safe to call concurrently.  Called from a body  //
+//     of Thread_Pool_Parallel_For(), see thread_pool.c, the routines run     //
+//     serially.  Since the blocks do not depend on the number of threads,    //
+//     neither do the results.                                                //
+//                                                                            //
+//     For very long tables Cumulative_Integral_Mapped() writes the result to //
+//     a memory mapped file (or anonymous mapping) so that the table need not //
+//     fit in the swap space and is available to other processes.             //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>                             // required for malloc(), free()
+#include <sys/mman.h>                           // required for mmap(), munmap()
+#include <sys/types.h>                          // required for off_t
+#include <fcntl.h>                              // required for open()
+#include <unistd.h>                             // required for ftruncate()
+
+#define SCAN_BLOCK 16384
+#define NUM_OF_POSITIVE_NODES 4
+
+int Thread_Pool_In_Parallel( void );
+
+//  The nodes and weights of the 8 point Gauss-Legendre formula on [-1,1]     //
+
+static const double node[] = {
+    1.83434642495649804939476142360184e-01,
+    5.25532409916328985817739049189246e-01,
+    7.96666477413626739591553936475831e-01,
+    9.60289856497536231683560868569473e-01
+};
+
+static const double weight[] = {
+    3.62683783378361982965150449277196e-01,
+    3.13706645877887287337962201986601e-01,
+    2.22381034453374470544355994426241e-01,
+    1.01228536290376259152531354309962e-01
+};
+
+static double Panel_Integral( double (*f)(double), double a, double b );
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Cumulative_Integral( double (*f)(double), double x[], double F[],     //
+//                                                                   int n )  //
+//                                                                            //
+//  Description:                                                              //
+//     Sets F[i] to the integral of f from x[0] to x[i], i = 0,...,n-1.       //
+//                                                                            //
+//  Arguments:                                                                //
+//     double *f   Pointer to the integrand, a function of a single variable  //
+//                 of type double.                                            //
+//     double x[]  The points x[0] < x[1] < ... < x[n-1].                     //
+//     double F[]  The values of the antiderivative, dimensioned at least n.  //
+//                 F[0] = 0.                                                  //
+//     int    n    The number of points.                                      //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -1 if n < 1 and -2 if memory could not be allocated.  //
+//                                                                            //
+//  Example:                                                                  //
+//     #define N 10000001                                                     //
+//     double *x = (double*) malloc( N * sizeof(double) );                    //
+//     double *F = (double*) malloc( N * sizeof(double) );                    //
+//     double f(double);                                                      //
+//     int i;                                                                 //
+//                                                                            //
+//     for (i = 0; i < N; i++) x[i] = 1.0e-7 * i;                             //
+//     if ( Cumulative_Integral( f, x, F, N ) < 0 ) printf("error\n");        //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Cumulative_Integral( double (*f)(double), double x[], double F[], int n ) {
+
+   int panels = n - 1;
+   int nblocks = (panels + SCAN_BLOCK - 1) / SCAN_BLOCK;
+   double *total;
+   double sum, c, t, y;
+   int b, i, lo, hi;
+
+   if (n < 1) return -1;
+   F[0] = 0.0;
+   if (n == 1) return 0;
+
+   total = (double*) malloc( nblocks * sizeof(double) );
+   if (total == NULL) return -2;
+
+               // (1) The compensated running sum of each block. //
+
+   #pragma omp parallel for schedule(dynamic) private(i, lo, hi, sum, c, t, y) \
+                                                 if (!Thread_Pool_In_Parallel())
+   for (b = 0; b < nblocks; b++) {
+      lo = b * SCAN_BLOCK + 1;
+      hi = (lo + SCAN_BLOCK - 1 < n - 1) ? lo + SCAN_BLOCK - 1 : n - 1;
+      sum = 0.0;
+      c = 0.0;
+      for (i = lo; i <= hi; i++) {
+         y = Panel_Integral( f, x[i-1], x[i] ) - c;
+         t = sum + y;
+         c = (t - sum) - y;
+         sum = t;
+         F[i] = sum;
+      }
+      total[b] = sum - c;
+   }
+
+               // (2) The value of F at the start of each block. //
+
+   sum = 0.0;
+   c = 0.0;
+   for (b = 0; b < nblocks; b++) {
+      y = total[b] - c;
+      total[b] = sum - c;
+      t = sum + y;
+      c = (t - sum) - y;
+      sum = t;
+   }
+
+               // (3) Add the start value to each entry of the block. //
+
+   #pragma omp parallel for schedule(static) private(i, lo, hi) \
+                                                 if (!Thread_Pool_In_Parallel())
+   for (b = 1; b < nblocks; b++) {
+      lo = b * SCAN_BLOCK + 1;
+      hi = (lo + SCAN_BLOCK - 1 < n - 1) ? lo + SCAN_BLOCK - 1 : n - 1;
+      for (i = lo; i <= hi; i++) F[i] += total[b];
+   }
+
+   free(total);
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  double* Cumulative_Integral_Mapped( double (*f)(double), double x[],      //
+//                               int n, const char *filename, int *err )      //
+//                                                                            //
+//  Description:                                                              //
+//     As Cumulative_Integral() but the table F[] is created by mmap().  If   //
+//     filename is not NULL the file is created (or truncated) to hold n      //
+//     doubles and mapped shared, so that on return the file contains the     //
+//     table in the native binary format; otherwise an anonymous mapping is   //
+//     used.                                                                  //
+//                                                                            //
+//  Arguments:                                                                //
+//     double *f              Pointer to the integrand.                       //
+//     double x[]             The points x[0] < x[1] < ... < x[n-1].          //
+//     int    n               The number of points, n >= 1.                   //
+//     const char *filename   The name of the file to hold the table or NULL. //
+//     int    *err            0 if successful, -1 if n < 1, -2 if memory      //
+//                            could not be allocated and -3 if the file could //
+//                            not be created or mapped.                       //
+//                                                                            //
+//  Return Values:                                                            //
+//     A pointer to the table F[0],...,F[n-1], which must be released with    //
+//     Cumulative_Integral_Unmap(), or NULL if an error occurred.             //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double* Cumulative_Integral_Mapped( double (*f)(double), double x[], int n,
+                                          const char *filename, int *err ) {
+
+   size_t bytes = (size_t) n * sizeof(double);
+   void *p;
+   int fd;
+
+   if (n < 1) { *err = -1; return NULL; }
+   if (filename == NULL)
+      p = mmap( NULL, bytes, PROT_READ | PROT_WRITE,
+                                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+   else {
+      fd = open( filename, O_RDWR | O_CREAT | O_TRUNC, 0644 );
+      if (fd < 0) { *err = -3; return NULL; }
+      if ( ftruncate( fd, (off_t) bytes ) ) {
+         close(fd);
+         *err = -3;
+         return NULL;
+      }
+      p = mmap( NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+      close(fd);
+   }
+   if (p == MAP_FAILED) { *err = -3; return NULL; }
+
+   *err = Cumulative_Integral( f, x, (double*) p, n );
+   if (*err < 0) { munmap( p, bytes ); return NULL; }
+   return (double*) p;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Cumulative_Integral_Unmap( double F[], int n )                       //
+//                                                                            //
+//  Description:                                                              //
+//     Releases a table of n entries returned by Cumulative_Integral_Mapped().//
+//     If the table is backed by a file, the file retains its contents.       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Cumulative_Integral_Unmap( double F[], int n ) {
+
+   munmap( F, (size_t) n * sizeof(double) );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static double Panel_Integral( double (*f)(double), double a, double b )   //
+//                                                                            //
+//  Description:                                                              //
+//     The 8 point Gauss-Legendre approximation of the integral of f over     //
+//     [a,b].                                                                 //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static double Panel_Integral( double (*f)(double), double a, double b ) {
+
+   double c = 0.5 * (a + b);
+   double h = 0.5 * (b - a);
+   double dx;
+   double integral = 0.0;
+   int i;
+
+   for (i = NUM_OF_POSITIVE_NODES - 1; i >= 0; i--) {
+      dx = h * node[i];
+      integral += weight[i] * ( (*f)(c - dx) + (*f)(c + dx) );
+   }
+   return h * integral;
+}
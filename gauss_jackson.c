@@ -0,0 +1,497 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: gauss_jackson.c                                                      //
+// Routines:                                                                  //
+//    Gauss_Jackson_Create                                                    //
+//    Gauss_Jackson_Start                                                     //
+//    Gauss_Jackson_Step                                                      //
+//    Gauss_Jackson_Dense                                                     //
+//    Gauss_Jackson_Free                                                      //
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Description:                                                              //
+//     The Gauss-Jackson method, or summed Stormer-Cowell method, for the     //
+//     system of second order differential equations y'' = f(x,y,y'), y an    //
+//     n-vector, is a fixed step multistep method which requires a single     //
+//     evaluation of f per step.  With x[m] = x0 + mh, f[m] = f(x[m],y[m],    //
+//     y'[m]) and the backward difference operator D, D f[m] = f[m] - f[m-1], //
+//     the Stormer-Cowell and Adams-Moulton formulas                          //
+//                                                                            //
+//           D^2 y[m] = h^2 c(D) f[m],        D y'[m] = h g(D) f[m],          //
+//                                                                            //
+//     where g(z) = -z / ln(1-z) and c(z) = g(z)^2, are summed twice and once //
+//     respectively.  Introducing the sums                                    //
+//                                                                            //
+//           S1[m] = S1[m-1] + f[m],          S2[m] = S2[m-1] + S1[m],        //
+//                                                                            //
+//     and truncating the series after the difference of order q-1, the       //
+//     correctors become                                                      //
+//                                                                            //
+//     y[m+1]  = h^2 ( S2[m] + Sum(k=2..q+1) c[k] D^(k-2) f[m+1] ),           //
+//     y'[m+1] = h ( S1[m+1] + Sum(k=1..q) g[k] D^(k-1) f[m+1] ),             //
+//                                                                            //
+//     and the predictors, obtained from the series c(z)/(1-z) and            //
+//     g(z)/(1-z), are the corresponding explicit formulas in f[m],...,       //
+//     f[m-q+1].  Each step predicts y[m+1] and y'[m+1], evaluates f there    //
+//     and corrects (PEC); optionally f is evaluated once more at the         //
+//     corrected values (PECE).  The truncation error of the correctors is    //
+//     O(h^(q+2)) and, since y is formed from the sums rather than            //
+//     accumulated, the global error over a fixed interval is of the same     //
+//     order q + 2, e.g. of order 10 for q = 8.  The differences are          //
+//     converted once to weights of the ordinates f[m], f[m-1], ... so that a //
+//     step costs O(qn) operations.                                           //
+//                                                                            //
+//     Since y is recomputed from the sums at every step instead of being     //
+//     accumulated, and the sums S1 and S2 are accumulated with Kahan's       //
+//     compensated summation, the round-off error grows slowly over very      //
+//     long arcs.                                                             //
+//                                                                            //
+//     The q - 1 starting values are computed by the embedded Runge-Kutta-    //
+//     Nystrom pair Runge_Kutta_2nd_Order_Embedded_System(), see              //
+//     runge_kutta_2nd_order.c, with the tolerance START_TOLERANCE, and the   //
+//     sums are then initialized so that the correctors reproduce y and y'    //
+//     at the last starting point.  The solution between x[m] and x[m+1] is   //
+//     interpolated by integrating the polynomial of degree q through f[m+1], //
+//     ..., f[m-q+1] once and twice from x[m].                                //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>                             // required for malloc()
+
+#define MAX_GAUSS_JACKSON_ORDER 16
+#define START_TOLERANCE 1.0e-14
+
+struct Step_Controller;
+
+struct Gauss_Jackson {
+   void (*f)(double, double[], double[], double[]);
+   int n;
+   int order;                     // q, the number of back points
+   int pece;
+   double h;
+   double x;                      // x[m]
+   int newest;                    // fh[newest] is f[m]
+   double *fh[MAX_GAUSS_JACKSON_ORDER + 1];          // f[m],...,f[m-q]
+   double *S1, *S2;               // S1[m], S2[m]
+   double *C1, *C2;               // their compensations
+   double *y_old, *yp_old;        // y[m-1], y'[m-1]
+   double *y_new, *yp_new;        // y[m], y'[m]
+   int steps;                     // the number of steps taken since the start
+   double pos_pred[MAX_GAUSS_JACKSON_ORDER];     // ordinate weights of the
+   double vel_pred[MAX_GAUSS_JACKSON_ORDER];     // predictors and correctors
+   double pos_corr[MAX_GAUSS_JACKSON_ORDER];
+   double vel_corr[MAX_GAUSS_JACKSON_ORDER];
+};
+
+int Runge_Kutta_2nd_Order_Embedded_System(
+         void (*f)(double, double[], double[], double[]), double y[],
+         double yp[], int n, double x0, double x1, double *h, double atol[],
+         double rtol[], int special, struct Step_Controller *controller,
+                                                         int *evaluations );
+void Gauss_Jackson_Free( struct Gauss_Jackson *s );
+
+static void Ordinate_Weights( double w[], double d[], int q );
+static void Kahan_Add( double S[], double C[], double v[], int n );
+
+////////////////////////////////////////////////////////////////////////////////
+//  struct Gauss_Jackson* Gauss_Jackson_Create(                               //
+//         void (*f)(double, double[], double[], double[]), int n, int order, //
+//                                            double h, int pece, int *err )  //
+//                                                                            //
+//  Description:                                                              //
+//     Creates a Gauss-Jackson integrator of the given order and step size.   //
+//     The integrator allocates (q + 9) n doubles: the last q + 1 evaluations //
+//     of f, the sums and their compensations, and y and y' at the last two   //
+//     points.                                                                //
+//                                                                            //
+//  Arguments:                                                                //
+//     void (*f)(double x, double y[], double yp[], double ypp[])             //
+//            Pointer to the function which evaluates ypp[] = f(x,y[],yp[]).  //
+//     int    n      The number of equations.                                 //
+//     int    order  The number q of back points, 2 <= q <=                   //
+//                   MAX_GAUSS_JACKSON_ORDER; the method is of order q + 2.   //
+//     double h      The step size, h > 0.                                    //
+//     int    pece   0 for one evaluation of f per step (PEC), nonzero to     //
+//                   evaluate f again at the corrected values (PECE).         //
+//     int    *err   0 if successful, -2 if memory could not be allocated and //
+//                   -3 if the order or h is invalid.                         //
+//                                                                            //
+//  Return Values:                                                            //
+//     A pointer to the integrator, which must be released with               //
+//     Gauss_Jackson_Free(), or NULL if an error occurred.                    //
+//                                                                            //
+//  Example:                                                                  //
+//     struct Gauss_Jackson *s;                                               //
+//     double x, y[3], yp[3];                                                 //
+//     int err;                                                               //
+//                                                                            //
+//     s = Gauss_Jackson_Create( f, 3, 8, 60.0, 0, &err );                    //
+//     x = Gauss_Jackson_Start( s, 0.0, y, yp );                              //
+//     while (x < 864000.0) x = Gauss_Jackson_Step( s, y, yp );               //
+//     Gauss_Jackson_Free( s );                                               //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+struct Gauss_Jackson* Gauss_Jackson_Create(
+         void (*f)(double, double[], double[], double[]), int n, int order,
+                                           double h, int pece, int *err ) {
+
+   struct Gauss_Jackson *s;
+   double L[MAX_GAUSS_JACKSON_ORDER + 2];
+   double g[MAX_GAUSS_JACKSON_ORDER + 2];
+   double c[MAX_GAUSS_JACKSON_ORDER + 2];
+   double gp[MAX_GAUSS_JACKSON_ORDER + 2];
+   double cp[MAX_GAUSS_JACKSON_ORDER + 2];
+   double *work;
+   int i, k, q = order;
+
+   *err = -3;
+   if (q < 2 || q > MAX_GAUSS_JACKSON_ORDER || !(h > 0.0)) return NULL;
+   *err = -2;
+   s = (struct Gauss_Jackson*) malloc( sizeof(struct Gauss_Jackson) );
+   if (s == NULL) return NULL;
+   work = (double*) malloc( (q + 9) * n * sizeof(double) );
+   if (work == NULL) { free(s); return NULL; }
+
+   s->f = f;
+   s->n = n;
+   s->order = q;
+   s->pece = pece;
+   s->h = h;
+   s->newest = 0;
+   s->steps = -1;
+   for (i = 0; i <= q; i++) s->fh[i] = work + i * n;
+   s->S1 = work + (q + 1) * n;
+   s->S2 = s->S1 + n;
+   s->C1 = s->S2 + n;
+   s->C2 = s->C1 + n;
+   s->y_old = s->C2 + n;
+   s->yp_old = s->y_old + n;
+   s->y_new = s->yp_old + n;
+   s->yp_new = s->y_new + n;
+
+           // The series L(z) = -ln(1-z)/z, g = 1/L, c = g^2, and g/(1-z), //
+           // c/(1-z).                                                     //
+
+   for (k = 0; k <= q + 1; k++) L[k] = 1.0 / (double) (k + 1);
+   g[0] = 1.0;
+   for (k = 1; k <= q + 1; k++) {
+      g[k] = 0.0;
+      for (i = 1; i <= k; i++) g[k] -= L[i] * g[k-i];
+   }
+   for (k = 0; k <= q + 1; k++) {
+      c[k] = 0.0;
+      for (i = 0; i <= k; i++) c[k] += g[i] * g[k-i];
+      gp[k] = (k > 0) ? gp[k-1] + g[k] : g[0];
+      cp[k] = (k > 0) ? cp[k-1] + c[k] : c[0];
+   }
+
+           // The coefficients of D^0,...,D^(q-1) converted to ordinates. //
+
+   Ordinate_Weights( s->pos_pred, cp + 2, q );
+   Ordinate_Weights( s->pos_corr, c + 2, q );
+   Ordinate_Weights( s->vel_pred, gp + 1, q );
+   Ordinate_Weights( s->vel_corr, g + 1, q );
+   *err = 0;
+   return s;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  double Gauss_Jackson_Start( struct Gauss_Jackson *s, double x0,           //
+//                                                double y[], double yp[] )   //
+//                                                                            //
+//  Description:                                                              //
+//     Computes the starting values at x0 + h,..., x0 + (q-1)h and            //
+//     initializes the sums.                                                  //
+//                                                                            //
+//  Arguments:                                                                //
+//     struct Gauss_Jackson *s  The integrator.                               //
+//     double x0    The initial value of x.                                   //
+//     double y[]   On input y at x0, on output y at x0 + (q-1)h.             //
+//     double yp[]  On input y' at x0, on output y' at x0 + (q-1)h.           //
+//                                                                            //
+//  Return Values:                                                            //
+//     The point x0 + (q-1)h reached, or x0 if the starting procedure failed, //
+//     in which case y[] and yp[] are unchanged.                              //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double Gauss_Jackson_Start( struct Gauss_Jackson *s, double x0, double y[],
+                                                               double yp[] ) {
+
+   int n = s->n;
+   int q = s->order;
+   double h = s->h;
+   double *atol, *y1, *yp1;
+   double hs = 0.0, x;
+   double *fj;
+   int i, j;
+
+   atol = (double*) malloc( 4 * n * sizeof(double) );
+   if (atol == NULL) return x0;
+   y1 = atol + 2 * n;
+   yp1 = y1 + n;
+   for (i = 0; i < 2 * n; i++) atol[i] = START_TOLERANCE;
+   for (i = 0; i < n; i++) { y1[i] = y[i]; yp1[i] = yp[i]; }
+
+            // f[0] is the oldest; after the start fh[q-1] is f[m]. //
+
+   s->newest = q - 1;
+   (*s->f)(x0, y1, yp1, s->fh[0]);
+   for (j = 1; j < q; j++) {
+      x = x0 + (j - 1) * h;
+      if ( Runge_Kutta_2nd_Order_Embedded_System( s->f, y1, yp1, n, x,
+                         x + h, &hs, atol, atol, 0, NULL, NULL ) != 0 ) {
+         free(atol);
+         return x0;
+      }
+      (*s->f)(x0 + j * h, y1, yp1, s->fh[j]);
+   }
+   s->x = x0 + (q - 1) * h;
+
+              // Choose S1[m] and S2[m] so that the correctors //
+              // reproduce y[m] and y'[m].                     //
+
+   for (i = 0; i < n; i++) {
+      s->S1[i] = yp1[i] / h;
+      s->S2[i] = y1[i] / (h * h);
+   }
+   for (j = 0; j < q; j++) {
+      fj = s->fh[q - 1 - j];                            // f[m-j]
+      for (i = 0; i < n; i++) {
+         s->S1[i] -= s->vel_corr[j] * fj[i];
+         s->S2[i] -= s->pos_corr[j] * fj[i];
+      }
+   }
+   for (i = 0; i < n; i++) {
+      s->S2[i] += s->S1[i];
+      s->C1[i] = s->C2[i] = 0.0;
+      s->y_new[i] = y[i] = y1[i];
+      s->yp_new[i] = yp1[i];
+      yp[i] = yp1[i];
+   }
+   s->steps = 0;
+   free(atol);
+   return s->x;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  double Gauss_Jackson_Step( struct Gauss_Jackson *s, double y[],           //
+//                                                             double yp[] )  //
+//                                                                            //
+//  Description:                                                              //
+//     Advances the solution by one step h.  Gauss_Jackson_Start() must have  //
+//     been called.                                                           //
+//                                                                            //
+//  Arguments:                                                                //
+//     struct Gauss_Jackson *s  The integrator.                               //
+//     double y[]   On output y at the new point.                             //
+//     double yp[]  On output y' at the new point.                            //
+//                                                                            //
+//  Return Values:                                                            //
+//     The new point x[m+1].                                                  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double Gauss_Jackson_Step( struct Gauss_Jackson *s, double y[], double yp[] ) {
+
+   int n = s->n;
+   int q = s->order;
+   int slots = q + 1;
+   double h = s->h;
+   double h2 = h * h;
+   double *fj, *fnew, *swap;
+   double x1 = s->x + h;
+   int i, j, next;
+
+              // Predict from f[m],...,f[m-q+1]. //
+
+   for (i = 0; i < n; i++) { y[i] = s->S2[i]; yp[i] = s->S1[i]; }
+   for (j = 0; j < q; j++) {
+      fj = s->fh[(s->newest - j + slots) % slots];
+      for (i = 0; i < n; i++) {
+         y[i] += s->pos_pred[j] * fj[i];
+         yp[i] += s->vel_pred[j] * fj[i];
+      }
+   }
+   for (i = 0; i < n; i++) { y[i] *= h2; yp[i] *= h; }
+
+              // Evaluate, the slot of f[m-q] receives f[m+1]. //
+
+   next = (s->newest + 1) % slots;
+   fnew = s->fh[next];
+   (*s->f)(x1, y, yp, fnew);
+
+              // Correct from f[m+1],...,f[m-q+2]. //
+
+   for (i = 0; i < n; i++) {
+      y[i] = s->S2[i];
+      yp[i] = s->S1[i] + fnew[i];
+   }
+   for (j = 0; j < q; j++) {
+      fj = s->fh[(next - j + slots) % slots];
+      for (i = 0; i < n; i++) {
+         y[i] += s->pos_corr[j] * fj[i];
+         yp[i] += s->vel_corr[j] * fj[i];
+      }
+   }
+   for (i = 0; i < n; i++) { y[i] *= h2; yp[i] *= h; }
+   if (s->pece) (*s->f)(x1, y, yp, fnew);
+
+              // Update the sums and the history. //
+
+   Kahan_Add( s->S1, s->C1, fnew, n );
+   Kahan_Add( s->S2, s->C2, s->S1, n );
+   s->newest = next;
+   swap = s->y_old; s->y_old = s->y_new; s->y_new = swap;
+   swap = s->yp_old; s->yp_old = s->yp_new; s->yp_new = swap;
+   for (i = 0; i < n; i++) { s->y_new[i] = y[i]; s->yp_new[i] = yp[i]; }
+   s->x = x1;
+   s->steps++;
+   return x1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Gauss_Jackson_Dense( struct Gauss_Jackson *s, double x, double y[],   //
+//                                                              double yp[] ) //
+//                                                                            //
+//  Description:                                                              //
+//     Interpolates y and y' at a point x of the last step [x[m-1],x[m]].     //
+//     The polynomial of degree q interpolating f[m],...,f[m-q] is integrated //
+//     from x[m-1]:                                                           //
+//       y(x[m-1] + th)  = y[m-1] + th y'[m-1] + h^2 Sum W[j](t) f[m-j],      //
+//       y'(x[m-1] + th) = y'[m-1] + h Sum V[j](t) f[m-j],                    //
+//     where V[j] and W[j] are the first and second integrals from 0 of the   //
+//     Lagrange polynomial of the node 1-j, nodes 1, 0, -1,..., 1-q.          //
+//                                                                            //
+//  Arguments:                                                                //
+//     struct Gauss_Jackson *s  The integrator.                               //
+//     double x     The point, x[m-1] <= x <= x[m].                           //
+//     double y[]   On output y at x.                                         //
+//     double yp[]  On output y' at x.                                        //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -1 if no step has been taken since the start or x is  //
+//     not in the last step.                                                  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Gauss_Jackson_Dense( struct Gauss_Jackson *s, double x, double y[],
+                                                               double yp[] ) {
+
+   int n = s->n;
+   int q = s->order;
+   int slots = q + 1;
+   double h = s->h;
+   double t = (x - (s->x - h)) / h;
+   double p[MAX_GAUSS_JACKSON_ORDER + 1];
+   double V, W, tk, node;
+   double *fj;
+   int i, j, k, l, deg;
+
+   if (s->steps < 1 || t < 0.0 || t > 1.0) return -1;
+   for (i = 0; i < n; i++) {
+      y[i] = s->y_old[i] + t * h * s->yp_old[i];
+      yp[i] = s->yp_old[i];
+   }
+   for (j = 0; j <= q; j++) {
+
+               // The monomial coefficients of the Lagrange polynomial //
+               // of the node 1 - j.                                   //
+
+      p[0] = 1.0;
+      deg = 0;
+      for (l = 0; l <= q; l++) {
+         if (l == j) continue;
+         node = 1.0 - l;
+         p[deg + 1] = 0.0;
+         for (k = deg + 1; k > 0; k--) p[k] = p[k-1] - node * p[k];
+         p[0] *= -node;
+         deg++;
+         for (k = 0; k <= deg; k++) p[k] /= (double) (l - j);
+      }
+
+               // Its integrals from 0 to t. //
+
+      V = 0.0;
+      W = 0.0;
+      tk = t;
+      for (k = 0; k <= q; k++) {
+         V += p[k] * tk / (double) (k + 1);
+         tk *= t;
+         W += p[k] * tk / (double) ((k + 1) * (k + 2));
+      }
+      fj = s->fh[(s->newest - j + slots) % slots];
+      for (i = 0; i < n; i++) {
+         y[i] += h * h * W * fj[i];
+         yp[i] += h * V * fj[i];
+      }
+   }
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Gauss_Jackson_Free( struct Gauss_Jackson *s )                        //
+//                                                                            //
+//  Description:                                                              //
+//     Releases an integrator created by Gauss_Jackson_Create().              //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Gauss_Jackson_Free( struct Gauss_Jackson *s ) {
+
+   if (s == NULL) return;
+   free(s->fh[0]);
+   free(s);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static void Ordinate_Weights( double w[], double d[], int q )             //
+//                                                                            //
+//  Description:                                                              //
+//     Sets w[] so that Sum(k=0..q-1) d[k] D^k f[m] = Sum(j=0..q-1) w[j]      //
+//     f[m-j], using D^k f[m] = Sum(j=0..k) (-1)^j binomial(k,j) f[m-j].      //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static void Ordinate_Weights( double w[], double d[], int q ) {
+
+   double binomial;
+   int j, k;
+
+   for (j = 0; j < q; j++) w[j] = 0.0;
+   for (k = 0; k < q; k++) {
+      binomial = 1.0;
+      for (j = 0; j <= k; j++) {
+         w[j] += ( (j & 1) ? -binomial : binomial ) * d[k];
+         binomial = binomial * (double) (k - j) / (double) (j + 1);
+      }
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static void Kahan_Add( double S[], double C[], double v[], int n )        //
+//                                                                            //
+//  Description:                                                              //
+//     Adds v[] to the sums S[] with Kahan's compensated summation, C[]       //
+//     holding the compensations.                                             //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static void Kahan_Add( double S[], double C[], double v[], int n ) {
+
+   double t, u;
+   int i;
+
+   for (i = 0; i < n; i++) {
+      u = v[i] - C[i];
+      t = S[i] + u;
+      C[i] = (t - S[i]) - u;
+      S[i] = t;
+   }
+}
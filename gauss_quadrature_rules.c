@@ -0,0 +1,798 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: gauss_quadrature_rules.c                                             //
+// Routines:                                                                  //
+//    Gauss_Legendre_Rule                                                     //
+//    Gauss_Jacobi_Rule                                                       //
+//    Gauss_Laguerre_Rule                                                     //
+//    Gauss_Hermite_Rule                                                      //
+//    Gauss_Rule_Cached                                                       //
+//    Gauss_Rule_Free_Cache                                                   //
+//    Gauss_Rule_Integration                                                  //
+//    Gauss_Rule_Integration_Batch                                            //
+//    Gauss_Rule_Integration_Intervals                                        //
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Description:                                                              //
+//     An n point Gaussian quadrature formula for the weight function w(x) on //
+//     the interval (a,b),                                                    //
+//          Integral f(x) w(x) dx ~ A[0] f(x[0]) + ... + A[n-1] f(x[n-1]),    //
+//     is exact for polynomials f of degree at most 2n-1.  The nodes x[i] are //
+//     the zeros of the n-th orthogonal polynomial for w(x), and the weights  //
+//     A[i] are positive.  The following weights are supported:               //
+//        Legendre  w(x) = 1                          on (-1,1),              //
+//        Jacobi    w(x) = (1-x)^alpha (1+x)^beta     on (-1,1), alpha,beta>-1//
+//        Laguerre  w(x) = x^alpha exp(-x)            on (0,inf), alpha > -1, //
+//        Hermite   w(x) = exp(-x^2)                  on (-inf,inf).          //
+//                                                                            //
+//     For n <= ASYMPTOTIC_N, and for the Jacobi, Laguerre and Hermite        //
+//     weights for every n, the rule is computed by the Golub-Welsch method:  //
+//     the nodes are the eigenvalues of the symmetric tridiagonal Jacobi      //
+//     matrix of the three term recurrence of the orthonormal polynomials,    //
+//     and the weights are mu0 times the squares of the first components of   //
+//     the normalized eigenvectors, mu0 being the integral of w(x).  The      //
+//     eigenvalues are found by the implicit QL method in which only the      //
+//     first row of the eigenvector matrix is accumulated, so that the cost   //
+//     is O(n^2).                                                             //
+//                                                                            //
+//     For the Legendre weight and n > ASYMPTOTIC_N, the nodes are found in   //
+//     O(n) operations as in Hale and Townsend, "Fast and accurate            //
+//     computation of Gauss-Legendre and Gauss-Jacobi quadrature nodes and    //
+//     weights", SIAM J. Sci. Comput. 35 (2013).  Writing x = cos(t), the     //
+//     interior nodes are found by Newton's method in t applied to the        //
+//     Stieltjes asymptotic expansion (Szego, Orthogonal Polynomials, 8.21)   //
+//       P[n](cos t) = C[n] Sum h[n,m] cos(a[n,m]) / (2 sin t)^(m+1/2),       //
+//     m = 0,...,M-1, where a[n,m] = (n+m+1/2)t - (m+1/2)pi/2, h[n,0] = 1 and //
+//     h[n,m] = h[n,m-1] (m-1/2)^2 / (m (n+m+1/2)), each iteration costing    //
+//     O(M) operations.  Starting values are given by Tricomi's formula.  The //
+//     BOUNDARY_NODES nodes closest to each end point, for which the          //
+//     expansion is inaccurate, are found by Newton's method applied to the   //
+//     three term recurrence starting from the zeros of the Bessel function   //
+//     J0, each costing O(n) operations.  The weight of a node is             //
+//     2 / (dP[n]/dt)^2; the constant C[n] of the interior weights is fixed   //
+//     so that the weights sum to 2.                                          //
+//                                                                            //
+//     Gauss_Rule_Cached() keeps every rule it has computed in a cache which  //
+//     may be shared by several threads.                                      //
+//                                                                            //
+//     Gauss_Rule_Integration_Intervals() integrates one function over many   //
+//     intervals [a[j],b[j]] with a rule on [-1,1].  The nodes of as many     //
+//     intervals as fit in INTERVAL_BATCH_SIZE points are mapped together and //
+//     the integrand is called once for the whole batch, so that the cost of  //
+//     the call is shared by thousands of nodes and the integrand may itself  //
+//     be vectorized.  If compiled with OpenMP (e.g. gcc -fopenmp) the        //
+//     batches are distributed among the threads, unless called from a body   //
+//     of Thread_Pool_Parallel_For(), see thread_pool.c.                      //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+#include <math.h>                   // required for cos(), sin(), lgamma() etc
+#include <float.h>                  // required for DBL_EPSILON
+#include <stdlib.h>                 // required for malloc(), free()
+#include <pthread.h>                // required for pthread_mutex_lock()
+
+#define PI 3.14159265358979323846264338327950288
+
+#define ASYMPTOTIC_N 100
+#define BOUNDARY_NODES 10
+#define EXPANSION_TERMS 20
+#define BATCH_SIZE 256
+#define INTERVAL_BATCH_SIZE 4096
+
+#define GAUSS_LEGENDRE 0
+#define GAUSS_JACOBI   1
+#define GAUSS_LAGUERRE 2
+#define GAUSS_HERMITE  3
+
+struct Gauss_Rule {
+   int family;
+   int n;
+   double alpha;
+   double beta;
+   double *x;
+   double *A;
+   struct Gauss_Rule *next;
+};
+
+static struct Gauss_Rule *cache = NULL;
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int Golub_Welsch( int n, double d[], double e[], double mu0,
+                                                      double x[], double A[] );
+static void Legendre_Asymptotic( int n, double x[], double A[] );
+static double Legendre_Newton_Recurrence( int n, double t, double *dp_dt );
+static double Stieltjes_Newton( int n, double t, double *dp_dt );
+int Thread_Pool_In_Parallel( void );
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Gauss_Legendre_Rule( int n, double x[], double A[] )                  //
+//                                                                            //
+//  Description:                                                              //
+//     Computes the nodes and weights of the n point Gauss-Legendre formula   //
+//     for the integral of f(x) from -1 to 1.                                 //
+//                                                                            //
+//  Arguments:                                                                //
+//     int    n    The number of nodes, n >= 1.                               //
+//     double x[]  The nodes in increasing order.  x[] should be dimensioned  //
+//                 at least n in the caller function.                         //
+//     double A[]  The corresponding weights, dimensioned at least n.         //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -1 if the QL iteration failed to converge and -2 if   //
+//     memory could not be allocated.                                         //
+//                                                                            //
+//  Example:                                                                  //
+//     double x[1000], A[1000];                                               //
+//                                                                            //
+//     Gauss_Legendre_Rule( 1000, x, A );                                     //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Gauss_Legendre_Rule( int n, double x[], double A[] ) {
+
+   double *e;
+   double k;
+   int i, err;
+
+   if (n > ASYMPTOTIC_N) { Legendre_Asymptotic( n, x, A ); return 0; }
+
+   e = (double*) malloc( n * sizeof(double) );
+   if (e == NULL) return -2;
+   for (i = 0; i < n; i++) {
+      x[i] = 0.0;
+      k = (double) (i + 1);
+      e[i] = k / sqrt( 4.0 * k * k - 1.0 );
+   }
+   err = Golub_Welsch( n, x, e, 2.0, x, A );
+   free(e);
+   return err;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Gauss_Jacobi_Rule( int n, double alpha, double beta, double x[],      //
+//                                                              double A[] )  //
+//                                                                            //
+//  Description:                                                              //
+//     Computes the nodes and weights of the n point Gauss-Jacobi formula     //
+//     for the integral of f(x) (1-x)^alpha (1+x)^beta from -1 to 1.          //
+//                                                                            //
+//  Arguments:                                                                //
+//     int    n      The number of nodes, n >= 1.                             //
+//     double alpha  The exponent of (1-x), alpha > -1.                       //
+//     double beta   The exponent of (1+x), beta > -1.                        //
+//     double x[]    The nodes in increasing order, dimensioned at least n.   //
+//     double A[]    The corresponding weights, dimensioned at least n.       //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -1 if the QL iteration failed to converge, -2 if      //
+//     memory could not be allocated and -3 if alpha or beta <= -1.           //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Gauss_Jacobi_Rule( int n, double alpha, double beta, double x[],
+                                                                 double A[] ) {
+
+   double *e;
+   double ab = alpha + beta;
+   double mu0;
+   double k, s;
+   int i, err;
+
+   if (alpha <= -1.0 || beta <= -1.0) return -3;
+   e = (double*) malloc( n * sizeof(double) );
+   if (e == NULL) return -2;
+
+   mu0 = exp( (ab + 1.0) * log(2.0) + lgamma(alpha + 1.0) + lgamma(beta + 1.0)
+                                                         - lgamma(ab + 2.0) );
+   x[0] = (beta - alpha) / (ab + 2.0);
+   for (i = 1; i < n; i++) {
+      k = (double) i;
+      s = 2.0 * k + ab;
+      x[i] = (beta * beta - alpha * alpha) / ( s * (s + 2.0) );
+   }
+   for (i = 0; i < n - 1; i++) {
+      k = (double) (i + 1);
+      s = 2.0 * k + ab;
+      if (i == 0)
+         e[i] = sqrt( 4.0 * (1.0 + alpha) * (1.0 + beta)
+                                          / ( (ab + 2.0) * (ab + 2.0) * (ab + 3.0) ) );
+      else
+         e[i] = sqrt( 4.0 * k * (k + alpha) * (k + beta) * (k + ab)
+                                    / ( s * s * (s + 1.0) * (s - 1.0) ) );
+   }
+   err = Golub_Welsch( n, x, e, mu0, x, A );
+   free(e);
+   return err;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Gauss_Laguerre_Rule( int n, double alpha, double x[], double A[] )    //
+//                                                                            //
+//  Description:                                                              //
+//     Computes the nodes and weights of the n point generalized Gauss-       //
+//     Laguerre formula for the integral of f(x) x^alpha exp(-x) from 0 to    //
+//     infinity.                                                              //
+//                                                                            //
+//  Arguments:                                                                //
+//     int    n      The number of nodes, n >= 1.                             //
+//     double alpha  The exponent of x, alpha > -1.                           //
+//     double x[]    The nodes in increasing order, dimensioned at least n.   //
+//     double A[]    The corresponding weights, dimensioned at least n.  For  //
+//                   large n the weights of the largest nodes underflow to 0. //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -1 if the QL iteration failed to converge, -2 if      //
+//     memory could not be allocated and -3 if alpha <= -1.                   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Gauss_Laguerre_Rule( int n, double alpha, double x[], double A[] ) {
+
+   double *e;
+   double k;
+   int i, err;
+
+   if (alpha <= -1.0) return -3;
+   e = (double*) malloc( n * sizeof(double) );
+   if (e == NULL) return -2;
+   for (i = 0; i < n; i++) {
+      k = (double) i;
+      x[i] = 2.0 * k + alpha + 1.0;
+      e[i] = sqrt( (k + 1.0) * (k + 1.0 + alpha) );
+   }
+   err = Golub_Welsch( n, x, e, exp( lgamma(alpha + 1.0) ), x, A );
+   free(e);
+   return err;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Gauss_Hermite_Rule( int n, double x[], double A[] )                   //
+//                                                                            //
+//  Description:                                                              //
+//     Computes the nodes and weights of the n point Gauss-Hermite formula    //
+//     for the integral of f(x) exp(-x^2) from -infinity to infinity.         //
+//                                                                            //
+//  Arguments:                                                                //
+//     int    n    The number of nodes, n >= 1.                               //
+//     double x[]  The nodes in increasing order, dimensioned at least n.     //
+//     double A[]  The corresponding weights, dimensioned at least n.  For    //
+//                 large n the weights of the outermost nodes underflow to 0. //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -1 if the QL iteration failed to converge and -2 if   //
+//     memory could not be allocated.                                         //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Gauss_Hermite_Rule( int n, double x[], double A[] ) {
+
+   double *e;
+   int i, err;
+
+   e = (double*) malloc( n * sizeof(double) );
+   if (e == NULL) return -2;
+   for (i = 0; i < n; i++) {
+      x[i] = 0.0;
+      e[i] = sqrt( 0.5 * (double) (i + 1) );
+   }
+   err = Golub_Welsch( n, x, e, sqrt(PI), x, A );
+   free(e);
+   return err;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Gauss_Rule_Cached( int family, int n, double alpha, double beta,      //
+//                                       const double **x, const double **A ) //
+//                                                                            //
+//  Description:                                                              //
+//     Returns the n point rule of the given family, computing it by one of   //
+//     the routines above the first time it is requested and thereafter       //
+//     returning the cached copy.  The routine may be called concurrently by  //
+//     several threads; a rule requested by two threads at the same time may  //
+//     be computed twice but only one copy is kept.                           //
+//                                                                            //
+//  Arguments:                                                                //
+//     int    family  0 for Legendre, 1 for Jacobi, 2 for Laguerre and 3 for  //
+//                    Hermite.                                                //
+//     int    n       The number of nodes, n >= 1.                            //
+//     double alpha   The parameter alpha of the Jacobi and Laguerre weights, //
+//                    ignored otherwise.                                      //
+//     double beta    The parameter beta of the Jacobi weight, ignored        //
+//                    otherwise.                                              //
+//     const double **x  The address of the cached nodes.                     //
+//     const double **A  The address of the cached weights.                   //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, otherwise the error returned by the routine which     //
+//     computes the rule, or -4 if family is invalid.  The cached arrays must //
+//     not be modified or freed by the caller and remain valid until          //
+//     Gauss_Rule_Free_Cache() is called.                                     //
+//                                                                            //
+//  Example:                                                                  //
+//     const double *x, *A;                                                   //
+//                                                                            //
+//     if ( Gauss_Rule_Cached( 0, 10000, 0.0, 0.0, &x, &A ) == 0 )            //
+//        integral = Gauss_Rule_Integration( f, x, A, 10000 );                //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Gauss_Rule_Cached( int family, int n, double alpha, double beta,
+                                       const double **x, const double **A ) {
+
+   struct Gauss_Rule *r;
+   struct Gauss_Rule *s;
+   int err;
+
+   if (family < GAUSS_LEGENDRE || family > GAUSS_HERMITE) return -4;
+   if (family != GAUSS_JACOBI) beta = 0.0;
+   if (family == GAUSS_LEGENDRE || family == GAUSS_HERMITE) alpha = 0.0;
+
+   pthread_mutex_lock( &cache_lock );
+   for (r = cache; r != NULL; r = r->next)
+      if ( r->family == family && r->n == n && r->alpha == alpha
+                                                      && r->beta == beta ) break;
+   pthread_mutex_unlock( &cache_lock );
+   if (r != NULL) { *x = r->x; *A = r->A; return 0; }
+
+          // Compute the rule outside of the lock so that other threads  //
+          // are not held up while a large rule is being computed.       //
+
+   r = (struct Gauss_Rule*) malloc( sizeof(struct Gauss_Rule) );
+   if (r == NULL) return -2;
+   r->x = (double*) malloc( 2 * n * sizeof(double) );
+   if (r->x == NULL) { free(r); return -2; }
+   r->A = r->x + n;
+   r->family = family;
+   r->n = n;
+   r->alpha = alpha;
+   r->beta = beta;
+
+   switch (family) {
+      case GAUSS_LEGENDRE: err = Gauss_Legendre_Rule( n, r->x, r->A ); break;
+      case GAUSS_JACOBI: err = Gauss_Jacobi_Rule( n, alpha, beta, r->x, r->A );
+                         break;
+      case GAUSS_LAGUERRE: err = Gauss_Laguerre_Rule( n, alpha, r->x, r->A );
+                           break;
+      default: err = Gauss_Hermite_Rule( n, r->x, r->A );
+   }
+   if (err) { free(r->x); free(r); return err; }
+
+   pthread_mutex_lock( &cache_lock );
+   for (s = cache; s != NULL; s = s->next)
+      if ( s->family == family && s->n == n && s->alpha == alpha
+                                                      && s->beta == beta ) break;
+   if (s == NULL) { r->next = cache; cache = r; s = r; r = NULL; }
+   pthread_mutex_unlock( &cache_lock );
+   if (r != NULL) { free(r->x); free(r); }
+   *x = s->x;
+   *A = s->A;
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Gauss_Rule_Free_Cache( void )                                        //
+//                                                                            //
+//  Description:                                                              //
+//     Frees every cached rule.  No other thread may be using a cached rule   //
+//     or calling Gauss_Rule_Cached() at the time.                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Gauss_Rule_Free_Cache( void ) {
+
+   struct Gauss_Rule *r;
+
+   pthread_mutex_lock( &cache_lock );
+   while (cache != NULL) {
+      r = cache;
+      cache = r->next;
+      free(r->x);
+      free(r);
+   }
+   pthread_mutex_unlock( &cache_lock );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  double Gauss_Rule_Integration( double (*f)(double), const double x[],     //
+//                                                const double A[], int n )   //
+//                                                                            //
+//  Description:                                                              //
+//     Approximate the integral of f(x) w(x) using the n point rule with      //
+//     nodes x[] and weights A[] computed by one of the routines above.       //
+//                                                                            //
+//  Arguments:                                                                //
+//     double *f   Pointer to function of a single variable of type double.   //
+//     double x[]  The nodes.                                                 //
+//     double A[]  The weights.                                               //
+//     int    n    The number of nodes.                                       //
+//                                                                            //
+//  Return Values:                                                            //
+//     The approximation of the integral.                                     //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double Gauss_Rule_Integration( double (*f)(double), const double x[],
+                                                    const double A[], int n ) {
+
+   double integral = 0.0;
+   int i;
+
+   for (i = 0; i < n; i++) integral += A[i] * (*f)(x[i]);
+
+   return integral;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  double Gauss_Rule_Integration_Batch(                                      //
+//                  void (*f)(double[], double[], int), const double x[],     //
+//                                                const double A[], int n )   //
+//                                                                            //
+//  Description:                                                              //
+//     As Gauss_Rule_Integration() but the integrand is evaluated at up to    //
+//     BATCH_SIZE nodes per call.                                             //
+//                                                                            //
+//  Arguments:                                                                //
+//     void   *f   Pointer to the integrand, f(x, fx, m) must set             //
+//                 fx[i] = f(x[i]) for i = 0,...,m-1.                         //
+//     double x[]  The nodes.                                                 //
+//     double A[]  The weights.                                               //
+//     int    n    The number of nodes.                                       //
+//                                                                            //
+//  Return Values:                                                            //
+//     The approximation of the integral.                                     //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double Gauss_Rule_Integration_Batch( void (*f)(double[], double[], int),
+                              const double x[], const double A[], int n ) {
+
+   double xb[BATCH_SIZE];
+   double fx[BATCH_SIZE];
+   double integral = 0.0;
+   int i, j, m;
+
+   for (i = 0; i < n; i += BATCH_SIZE) {
+      m = (n - i < BATCH_SIZE) ? n - i : BATCH_SIZE;
+      for (j = 0; j < m; j++) xb[j] = x[i+j];
+      (*f)(xb, fx, m);
+      for (j = 0; j < m; j++) integral += A[i+j] * fx[j];
+   }
+   return integral;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Gauss_Rule_Integration_Intervals(                                     //
+//          void (*f)(double[], double[], int), const double a[],             //
+//          const double b[], double result[], int m, const double x[],       //
+//                                                const double A[], int n )   //
+//                                                                            //
+//  Description:                                                              //
+//     Approximates the integrals of f(x) over the m intervals [a[j],b[j]],   //
+//     j = 0,...,m-1, using the n point rule with nodes x[] and weights A[]   //
+//     on [-1,1], e.g. the Gauss-Legendre rule.  The rule is mapped to each   //
+//     interval by x -> (a[j] + b[j])/2 + (b[j] - a[j])/2 x.  The integrand   //
+//     is evaluated at the nodes of up to INTERVAL_BATCH_SIZE / n intervals   //
+//     per call.  If compiled with OpenMP the integrand may be called         //
+//     concurrently by several threads, except inside a body of               //
+//     Thread_Pool_Parallel_For() where the intervals are integrated by the   //
+//     calling thread.                                                        //
+//                                                                            //
+//  Arguments:                                                                //
+//     void   *f         Pointer to the integrand, f(x, fx, k) must set       //
+//                       fx[i] = f(x[i]) for i = 0,...,k-1.                   //
+//     double a[]        The lower limits of the intervals.                   //
+//     double b[]        The upper limits of the intervals.                   //
+//     double result[]   The integrals, dimensioned at least m.  result[] may //
+//                       be the same array as a[] or b[].                     //
+//     int    m          The number of intervals.                             //
+//     double x[]        The nodes of the rule on [-1,1].                     //
+//     double A[]        The weights of the rule.                             //
+//     int    n          The number of nodes.                                 //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -2 if memory could not be allocated.                  //
+//                                                                            //
+//  Example:                                                                  //
+//     const double *x, *A;                                                   //
+//     double *lo, *hi, *counts;                                              //
+//     void density(double[], double[], int);                                 //
+//                                                                            //
+//     Gauss_Rule_Cached( 0, 16, 0.0, 0.0, &x, &A );                          //
+//     Gauss_Rule_Integration_Intervals( density, lo, hi, counts, 1000000,    //
+//                                                                x, A, 16 ); //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Gauss_Rule_Integration_Intervals( void (*f)(double[], double[], int),
+                  const double a[], const double b[], double result[], int m,
+                                const double x[], const double A[], int n ) {
+
+   int per_batch = (n < INTERVAL_BATCH_SIZE) ? INTERVAL_BATCH_SIZE / n : 1;
+   int nbatches = (m + per_batch - 1) / per_batch;
+   int points = per_batch * n;
+   int err = 0;
+
+   #pragma omp parallel if (!Thread_Pool_In_Parallel())
+   {
+      double *xb = (double*) malloc( 2 * points * sizeof(double) );
+      double *fx = xb + points;
+      double *px, *pf;
+      double c, h, sum;
+      int batch, i, j, lo, k;
+
+      if (xb == NULL) {
+         #pragma omp atomic write
+         err = -2;
+      }
+
+      #pragma omp for schedule(dynamic)
+      for (batch = 0; batch < nbatches; batch++) {
+         if (xb == NULL) continue;
+         lo = batch * per_batch;
+         k = (m - lo < per_batch) ? m - lo : per_batch;
+         for (j = 0, px = xb; j < k; j++, px += n) {
+            c = 0.5 * (b[lo+j] + a[lo+j]);
+            h = 0.5 * (b[lo+j] - a[lo+j]);
+            #pragma omp simd
+            for (i = 0; i < n; i++) px[i] = c + h * x[i];
+         }
+         (*f)(xb, fx, k * n);
+         for (j = 0, pf = fx; j < k; j++, pf += n) {
+            h = 0.5 * (b[lo+j] - a[lo+j]);
+            sum = 0.0;
+            for (i = 0; i < n; i++) sum += A[i] * pf[i];
+            result[lo+j] = h * sum;
+         }
+      }
+      free(xb);
+   }
+   return err;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static int Golub_Welsch( int n, double d[], double e[], double mu0,       //
+//                                                  double x[], double A[] )  //
+//                                                                            //
+//  Description:                                                              //
+//     Finds the eigenvalues of the symmetric tridiagonal matrix with         //
+//     diagonal d[0],...,d[n-1] and off-diagonal e[0],...,e[n-2] by the       //
+//     implicit QL method with Wilkinson shifts, accumulating only the first  //
+//     components z[] of the eigenvectors.  On return the eigenvalues are     //
+//     sorted into increasing order in x[] and A[i] = mu0 * z[i]^2.  x[] may  //
+//     be the same array as d[].  e[] is destroyed.                           //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static int Golub_Welsch( int n, double d[], double e[], double mu0,
+                                                    double x[], double A[] ) {
+
+   double *z = A;
+   double b, c, f, g, p, r, s, dd;
+   int i, j, l, m, iter;
+
+   for (i = 0; i < n; i++) { x[i] = d[i]; z[i] = 0.0; }
+   z[0] = 1.0;
+   e[n-1] = 0.0;
+
+   for (l = 0; l < n; l++) {
+      iter = 0;
+      do {
+         for (m = l; m < n - 1; m++) {
+            dd = fabs(x[m]) + fabs(x[m+1]);
+            if ( fabs(e[m]) <= DBL_EPSILON * dd ) break;
+         }
+         if (m != l) {
+            if (iter++ == 60) return -1;
+            g = (x[l+1] - x[l]) / (2.0 * e[l]);
+            r = hypot(g, 1.0);
+            g = x[m] - x[l] + e[l] / (g + copysign(r, g));
+            s = c = 1.0;
+            p = 0.0;
+            for (i = m - 1; i >= l; i--) {
+               f = s * e[i];
+               b = c * e[i];
+               e[i+1] = (r = hypot(f, g));
+               if (r == 0.0) {
+                  x[i+1] -= p;
+                  e[m] = 0.0;
+                  break;
+               }
+               s = f / r;
+               c = g / r;
+               g = x[i+1] - p;
+               r = (x[i] - g) * s + 2.0 * c * b;
+               x[i+1] = g + (p = s * r);
+               g = c * r - b;
+               f = z[i+1];
+               z[i+1] = s * z[i] + c * f;
+               z[i] = c * z[i] - s * f;
+            }
+            if (r == 0.0 && i >= l) continue;
+            x[l] -= p;
+            e[l] = g;
+            e[m] = 0.0;
+         }
+      } while (m != l);
+   }
+
+             // Sort the eigenvalues by insertion, which is fast //
+             // since the QL method leaves them nearly sorted.   //
+
+   for (i = 1; i < n; i++) {
+      p = x[i];
+      f = z[i];
+      for (j = i - 1; j >= 0 && x[j] > p; j--) { x[j+1] = x[j]; z[j+1] = z[j]; }
+      x[j+1] = p;
+      z[j+1] = f;
+   }
+   for (i = 0; i < n; i++) A[i] = mu0 * z[i] * z[i];
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static void Legendre_Asymptotic( int n, double x[], double A[] )          //
+//                                                                            //
+//  Description:                                                              //
+//     Computes the n point Gauss-Legendre rule, n > ASYMPTOTIC_N, in O(n)    //
+//     operations as described at the top of the file.  Only the nodes in     //
+//     [0,1) are computed, the others follow by symmetry.                     //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static void Legendre_Asymptotic( int n, double x[], double A[] ) {
+
+   double dn = (double) n;
+   double t, dt, dp_dt, beta, xt;
+   double boundary_sum = 0.0;
+   double interior_sum = 0.0;
+   double scale;
+   int half = n / 2;
+   int k, i, iter;
+
+   for (k = 1; k <= half; k++) {
+      i = n - k;                     // x[i] = cos(t[k]) in increasing order
+      if (k <= BOUNDARY_NODES) {
+
+             // The k-th zero of J0 by McMahon's expansion, then Newton's //
+             // method applied to the three term recurrence.              //
+
+         beta = (k - 0.25) * PI;
+         t = beta + 1.0 / (8.0 * beta) - 31.0 / (384.0 * beta * beta * beta)
+               + 3779.0 / (15360.0 * beta * beta * beta * beta * beta);
+         t /= sqrt( (dn + 0.5) * (dn + 0.5) + (1.0 - 0.25) / 12.0 );
+         for (iter = 0; iter < 10; iter++) {
+            dt = Legendre_Newton_Recurrence( n, t, &dp_dt );
+            t -= dt;
+            if ( fabs(dt) <= 2.0 * DBL_EPSILON * t ) break;
+         }
+         Legendre_Newton_Recurrence( n, t, &dp_dt );
+         x[i] = cos(t);
+         A[i] = 2.0 / (dp_dt * dp_dt);
+         boundary_sum += A[i];
+      }
+      else {
+
+             // Tricomi's initial value, then Newton's method applied to //
+             // the Stieltjes expansion.                                  //
+
+         t = PI * (4.0 * k - 1.0) / (4.0 * dn + 2.0);
+         xt = cos(t) * ( 1.0 - (dn - 1.0) / (8.0 * dn * dn * dn)
+                     - (39.0 - 28.0 / (sin(t) * sin(t)))
+                                          / (384.0 * dn * dn * dn * dn) );
+         t = acos(xt);
+         for (iter = 0; iter < 10; iter++) {
+            dt = Stieltjes_Newton( n, t, &dp_dt );
+            t -= dt;
+            if ( fabs(dt) <= 2.0 * DBL_EPSILON * t ) break;
+         }
+         Stieltjes_Newton( n, t, &dp_dt );
+         x[i] = cos(t);
+         A[i] = 2.0 / (dp_dt * dp_dt);
+         interior_sum += A[i];
+      }
+   }
+   if (n & 1) {                     // the middle node is zero
+      t = 0.5 * PI;
+      if (half < BOUNDARY_NODES) {
+         Legendre_Newton_Recurrence( n, t, &dp_dt );
+         A[half] = 2.0 / (dp_dt * dp_dt);
+         boundary_sum += 0.5 * A[half];
+      }
+      else {
+         Stieltjes_Newton( n, t, &dp_dt );
+         A[half] = 2.0 / (dp_dt * dp_dt);
+         interior_sum += 0.5 * A[half];
+      }
+      x[half] = 0.0;
+   }
+
+           // The interior weights were computed with C[n] = 1.  Scale //
+           // them so that the weights of [0,1] sum to 1.              //
+
+   scale = (1.0 - boundary_sum) / interior_sum;
+   for (k = BOUNDARY_NODES + 1; k <= half; k++) A[n-k] *= scale;
+   if ( (n & 1) && half >= BOUNDARY_NODES ) A[half] *= scale;
+
+   for (k = 1; k <= half; k++) {
+      x[k-1] = - x[n-k];
+      A[k-1] = A[n-k];
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static double Legendre_Newton_Recurrence( int n, double t,                //
+//                                                        double *dp_dt )     //
+//                                                                            //
+//  Description:                                                              //
+//     Evaluates P[n](cos t) and its derivative with respect to t by the      //
+//     three term recurrence and returns the Newton correction P / (dP/dt).   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static double Legendre_Newton_Recurrence( int n, double t, double *dp_dt ) {
+
+   double x = cos(t);
+   double p0 = 1.0;
+   double p1 = x;
+   double p2;
+   int k;
+
+   for (k = 2; k <= n; k++) {
+      p2 = ( (2.0 * k - 1.0) * x * p1 - (k - 1.0) * p0 ) / (double) k;
+      p0 = p1;
+      p1 = p2;
+   }
+   *dp_dt = (double) n * (x * p1 - p0) / sin(t);
+   return p1 / *dp_dt;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static double Stieltjes_Newton( int n, double t, double *dp_dt )          //
+//                                                                            //
+//  Description:                                                              //
+//     Evaluates P[n](cos t) / C[n] and its derivative with respect to t by   //
+//     the first EXPANSION_TERMS terms of the Stieltjes expansion and returns //
+//     the Newton correction P / (dP/dt).                                     //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static double Stieltjes_Newton( int n, double t, double *dp_dt ) {
+
+   double dn = (double) n;
+   double s2 = 2.0 * sin(t);
+   double c2 = 2.0 * cos(t);
+   double ca, sa, cd, sd, tmp;
+   double h = 1.0;
+   double u = 1.0 / sqrt(s2);
+   double p = 0.0;
+   double dp = 0.0;
+   double m;
+   int j;
+
+   ca = cos( (dn + 0.5) * t - 0.25 * PI );   // a[n,0]
+   sa = sin( (dn + 0.5) * t - 0.25 * PI );
+   cd = cos( t - 0.5 * PI );                 // a[n,m+1] - a[n,m]
+   sd = sin( t - 0.5 * PI );
+
+   for (j = 0; j < EXPANSION_TERMS; j++) {
+      m = (double) j;
+      p += h * ca * u;
+      dp -= h * u * ( (dn + m + 0.5) * sa + (m + 0.5) * ca * c2 / s2 );
+      h *= (m + 0.5) * (m + 0.5) / ( (m + 1.0) * (dn + m + 1.5) );
+      u /= s2;
+      tmp = ca * cd - sa * sd;
+      sa = sa * cd + ca * sd;
+      ca = tmp;
+   }
+   *dp_dt = dp;
+   return p / dp;
+}
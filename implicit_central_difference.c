@@ -24,6 +24,10 @@
 //     for which the value y[n+1] is given implicitly.                        //
 //     The starting procedure is y[0] = a, y[1] = hc + h^2 f(x0,a,c) / 2.     //
 //                                                                            //
+//     For systems M y'' + C y' + K y = F(t) with sparse matrices, such as    //
+//     those of finite element models, see the Newmark-beta, HHT-alpha and    //
+//     generalized-alpha methods in newmark_beta.c.                           //
+//                                                                            //
 ////////////////////////////////////////////////////////////////////////////////
 
 ////////////////////////////////////////////////////////////////////////////////
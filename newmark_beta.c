@@ -0,0 +1,636 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: newmark_beta.c                                                       //
+// Routines:                                                                  //
+//    Generalized_Alpha_Create                                                //
+//    Generalized_Alpha_Initialize                                            //
+//    Generalized_Alpha_Step                                                  //
+//    Generalized_Alpha_Step_Nonlinear                                        //
+//    Generalized_Alpha_Free                                                  //
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Description:                                                              //
+//     The equations of motion of a discretized structure                     //
+//                       M y'' + C y' + K y = F(t),                           //
+//     where M, C and K are sparse symmetric n x n mass, damping and          //
+//     stiffness matrices, are stiff, and an explicit method such as the      //
+//     explicit central difference method is stable only for steps smaller    //
+//     than the period of the highest mode of the mesh.  The implicit methods //
+//     below are unconditionally stable.  With d, v and a the approximations  //
+//     of y, y' and y'' at t[n], Newmark's formulas                           //
+//                                                                            //
+//       d[n+1] = d[n] + h v[n] + h^2 ( (1/2 - beta) a[n] + beta a[n+1] )     //
+//       v[n+1] = v[n] + h ( (1 - gamma) a[n] + gamma a[n+1] )                //
+//                                                                            //
+//     are combined with the equations of motion imposed at intermediate      //
+//     points (the generalized-alpha method of Chung and Hulbert, 1993)       //
+//                                                                            //
+//       M a[n+1-am] + C v[n+1-af] + K d[n+1-af] = F(t[n] + (1-af) h),        //
+//                                                                            //
+//     where x[n+1-alpha] = (1 - alpha) x[n+1] + alpha x[n].  Each step       //
+//     requires the solution of a linear system with the effective matrix     //
+//                                                                            //
+//           S = (1-am) M + (1-af) gamma h C + (1-af) beta h^2 K,             //
+//                                                                            //
+//     which does not change if h does not change.  S is therefore factored   //
+//     once, by Generalized_Alpha_Create(), as S = L D L' in skyline          //
+//     (envelope) storage in which row i of L is stored from its first        //
+//     nonzero column to the diagonal, so that the fill-in of the             //
+//     factorization is confined to the envelope, and every step costs only a //
+//     forward and a back substitution and three sparse matrix-vector         //
+//     products.  The size of the envelope depends on the numbering of the    //
+//     unknowns; a numbering with small bandwidth, e.g. reverse Cuthill-      //
+//     McKee, should be used.                                                 //
+//                                                                            //
+//     The schemes are selected by                                            //
+//       scheme 0, Newmark:   am = af = 0, gamma = 1/2, beta = parameter,     //
+//                            e.g. 1/4 (average acceleration, no numerical    //
+//                            damping) or 1/6 (linear acceleration, which is  //
+//                            only conditionally stable),                     //
+//       scheme 1, HHT-alpha: am = 0, af = -alpha where alpha = parameter,    //
+//                            -1/3 <= alpha <= 0, gamma = 1/2 - alpha,        //
+//                            beta = (1 - alpha)^2 / 4,                       //
+//       scheme 2, generalized-alpha: with rho = parameter, 0 <= rho <= 1,    //
+//                            the spectral radius at infinite frequency,      //
+//                            am = (2 rho - 1) / (rho + 1),                   //
+//                            af = rho / (rho + 1), gamma = 1/2 - am + af,    //
+//                            beta = (1 - am + af)^2 / 4.                     //
+//     HHT-alpha and generalized-alpha damp the spurious high frequency modes //
+//     while remaining second order accurate.                                 //
+//                                                                            //
+//     If the internal forces are a nonlinear function fint(d) instead of K d //
+//     the equations                                                          //
+//       M a[n+1-am] + C v[n+1-af] + (1-af) fint(d[n+1]) + af fint(d[n])      //
+//                                                  = F(t[n] + (1-af) h)      //
+//     are solved for a[n+1] by the modified Newton method with the matrix S  //
+//     already factored, K being the tangent stiffness at a reference state.  //
+//                                                                            //
+//     The matrices are given in compressed sparse row (CSR) storage: the     //
+//     entries of row i are val[row[i]],...,val[row[i+1]-1] in the columns    //
+//     col[row[i]],...,col[row[i+1]-1], numbered from 0.  Both triangles of   //
+//     each symmetric matrix must be stored.                                  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>                             // required for malloc()
+#include <math.h>                               // required for fabs()
+
+#define NEWMARK 0
+#define HHT_ALPHA 1
+#define GENERALIZED_ALPHA 2
+
+struct Skyline {
+   int n;
+   int *first;                     // the first column of row i in the envelope
+   int *ptr;                       // row i starts at env[ptr[i]]
+   double *env;                    // the strictly lower part of the envelope
+   double *diag;
+};
+
+struct Generalized_Alpha {
+   int n;
+   double h;
+   double alpha_m;
+   double alpha_f;
+   double beta;
+   double gamma;
+   int *M_row, *M_col;
+   double *M_val;
+   int *C_row, *C_col;
+   double *C_val;
+   int *K_row, *K_col;
+   double *K_val;
+   struct Skyline S;
+   double *work;                   // 6n doubles
+};
+
+void Generalized_Alpha_Free( struct Generalized_Alpha *s );
+
+static int Skyline_Build( struct Skyline *s, int n, int *row[], int *col[],
+                                      double *val[], double coef[], int m );
+static int Skyline_Factor( struct Skyline *s );
+static void Skyline_Solve( struct Skyline *s, double x[] );
+static void Skyline_Free( struct Skyline *s );
+static void CSR_Multiply_Add( int n, int row[], int col[], double val[],
+                                          double coef, double x[], double y[] );
+
+////////////////////////////////////////////////////////////////////////////////
+//  struct Generalized_Alpha* Generalized_Alpha_Create( int n,                //
+//           int M_row[], int M_col[], double M_val[],                        //
+//           int C_row[], int C_col[], double C_val[],                        //
+//           int K_row[], int K_col[], double K_val[],                        //
+//                        double h, int scheme, double parameter, int *err )  //
+//                                                                            //
+//  Description:                                                              //
+//     Sets up the integrator for the step size h and the given scheme and    //
+//     factors the effective matrix S.  The matrices are not copied and must  //
+//     not be changed or freed while the integrator is in use.                //
+//                                                                            //
+//  Arguments:                                                                //
+//     int    n          The number of unknowns.                              //
+//     int    M_row[], M_col[], double M_val[]                                //
+//                       The mass matrix in CSR storage.                      //
+//     int    C_row[], C_col[], double C_val[]                                //
+//                       The damping matrix in CSR storage, or NULL pointers  //
+//                       if there is no damping.                              //
+//     int    K_row[], K_col[], double K_val[]                                //
+//                       The stiffness matrix, or for nonlinear internal      //
+//                       forces the tangent stiffness matrix at a reference   //
+//                       state, in CSR storage.                               //
+//     double h          The step size.                                       //
+//     int    scheme     0 (Newmark), 1 (HHT-alpha) or 2 (generalized-alpha). //
+//     double parameter  beta for Newmark, alpha for HHT-alpha and the        //
+//                       spectral radius at infinity for generalized-alpha.   //
+//     int    *err       0 if successful, -1 if S is not positive definite,   //
+//                       -2 if memory could not be allocated, -3 if the       //
+//                       scheme or the parameter is invalid.                  //
+//                                                                            //
+//  Return Values:                                                            //
+//     A pointer to the integrator, which must be released with               //
+//     Generalized_Alpha_Free(), or NULL if an error occurred.                //
+//                                                                            //
+//  Example:                                                                  //
+//     struct Generalized_Alpha *s;                                           //
+//     int i, err;                                                            //
+//                                                                            //
+//     s = Generalized_Alpha_Create( n, Mr, Mc, Mv, Cr, Cc, Cv, Kr, Kc, Kv,   //
+//                                                     1.e-3, 2, 0.8, &err ); //
+//     Generalized_Alpha_Initialize( s, 0.0, d, v, load, NULL, a );           //
+//     for (i = 0; i < 10000; i++)                                            //
+//        Generalized_Alpha_Step( s, 1.e-3 * i, d, v, a, load );              //
+//     Generalized_Alpha_Free( s );                                           //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+struct Generalized_Alpha* Generalized_Alpha_Create( int n,
+                int M_row[], int M_col[], double M_val[],
+                int C_row[], int C_col[], double C_val[],
+                int K_row[], int K_col[], double K_val[],
+                          double h, int scheme, double parameter, int *err ) {
+
+   struct Generalized_Alpha *s;
+   int *row[3], *col[3];
+   double *val[3], coef[3];
+   int m = 0;
+
+   *err = -2;
+   s = (struct Generalized_Alpha*) malloc( sizeof(struct Generalized_Alpha) );
+   if (s == NULL) return NULL;
+
+   switch (scheme) {
+      case NEWMARK:
+         s->alpha_m = 0.0;
+         s->alpha_f = 0.0;
+         s->gamma = 0.5;
+         s->beta = parameter;
+         if (parameter <= 0.0 || parameter > 0.5) *err = -3;
+         break;
+      case HHT_ALPHA:
+         s->alpha_m = 0.0;
+         s->alpha_f = -parameter;
+         s->gamma = 0.5 - parameter;
+         s->beta = 0.25 * (1.0 - parameter) * (1.0 - parameter);
+         if (parameter < -1.0 / 3.0 || parameter > 0.0) *err = -3;
+         break;
+      case GENERALIZED_ALPHA:
+         s->alpha_m = (2.0 * parameter - 1.0) / (parameter + 1.0);
+         s->alpha_f = parameter / (parameter + 1.0);
+         s->gamma = 0.5 - s->alpha_m + s->alpha_f;
+         s->beta = 0.25 * (1.0 - s->alpha_m + s->alpha_f)
+                                          * (1.0 - s->alpha_m + s->alpha_f);
+         if (parameter < 0.0 || parameter > 1.0) *err = -3;
+         break;
+      default:
+         *err = -3;
+   }
+   if (*err == -3 || h <= 0.0) { free(s); *err = -3; return NULL; }
+
+   s->n = n;
+   s->h = h;
+   s->M_row = M_row; s->M_col = M_col; s->M_val = M_val;
+   s->C_row = C_row; s->C_col = C_col; s->C_val = C_val;
+   s->K_row = K_row; s->K_col = K_col; s->K_val = K_val;
+   if (C_row == NULL || C_col == NULL || C_val == NULL) s->C_row = NULL;
+
+          // Build and factor S = (1-am) M + (1-af) gamma h C          //
+          //                                   + (1-af) beta h^2 K.    //
+
+   row[m] = M_row; col[m] = M_col; val[m] = M_val;
+   coef[m++] = 1.0 - s->alpha_m;
+   row[m] = K_row; col[m] = K_col; val[m] = K_val;
+   coef[m++] = (1.0 - s->alpha_f) * s->beta * h * h;
+   if (s->C_row != NULL) {
+      row[m] = C_row; col[m] = C_col; val[m] = C_val;
+      coef[m++] = (1.0 - s->alpha_f) * s->gamma * h;
+   }
+   s->work = (double*) malloc( 6 * n * sizeof(double) );
+   if (s->work == NULL) { free(s); return NULL; }
+   if ( Skyline_Build( &s->S, n, row, col, val, coef, m ) ) {
+      free(s->work);
+      free(s);
+      return NULL;
+   }
+   if ( Skyline_Factor( &s->S ) ) {
+      Generalized_Alpha_Free( s );
+      *err = -1;
+      return NULL;
+   }
+   *err = 0;
+   return s;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Generalized_Alpha_Initialize( struct Generalized_Alpha *s, double t0, //
+//         double d[], double v[], void (*force)(double, double[]),           //
+//                 void (*internal_force)(double[], double[]), double a[] )   //
+//                                                                            //
+//  Description:                                                              //
+//     Computes the initial acceleration a = M^-1 ( F(t0) - C v - K d ), or   //
+//     with K d replaced by fint(d) if internal_force is not NULL.            //
+//                                                                            //
+//  Arguments:                                                                //
+//     struct Generalized_Alpha *s  The integrator.                           //
+//     double t0     The initial time.                                        //
+//     double d[]    The initial displacements.                               //
+//     double v[]    The initial velocities.                                  //
+//     void   *force Pointer to the function which sets F[i], i = 0,...,n-1,  //
+//                   to the external forces at time t, force(t, F).           //
+//     void   *internal_force  NULL or a pointer to the function which sets   //
+//                   fint[i] to the internal forces at d, internal_force(d,   //
+//                   fint).                                                   //
+//     double a[]    The initial accelerations.                               //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -1 if M is not positive definite and -2 if memory     //
+//     could not be allocated.                                                //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Generalized_Alpha_Initialize( struct Generalized_Alpha *s, double t0,
+            double d[], double v[], void (*force)(double, double[]),
+                      void (*internal_force)(double[], double[]), double a[] ) {
+
+   struct Skyline M;
+   double *fint = s->work;
+   double one = 1.0;
+   int n = s->n;
+   int i, err;
+
+   if ( (err = Skyline_Build( &M, n, &s->M_row, &s->M_col, &s->M_val,
+                                                            &one, 1 )) != 0 )
+      return err;
+   if ( Skyline_Factor( &M ) ) { Skyline_Free( &M ); return -1; }
+
+   (*force)(t0, a);
+   if (s->C_row != NULL)
+      CSR_Multiply_Add( n, s->C_row, s->C_col, s->C_val, -1.0, v, a );
+   if (internal_force != NULL) {
+      (*internal_force)(d, fint);
+      for (i = 0; i < n; i++) a[i] -= fint[i];
+   }
+   else CSR_Multiply_Add( n, s->K_row, s->K_col, s->K_val, -1.0, d, a );
+   Skyline_Solve( &M, a );
+   Skyline_Free( &M );
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Generalized_Alpha_Step( struct Generalized_Alpha *s, double t,       //
+//                      double d[], double v[], double a[],                   //
+//                                     void (*force)(double, double[]) )      //
+//                                                                            //
+//  Description:                                                              //
+//     Advances the displacements d[], velocities v[] and accelerations a[]   //
+//     from t to t + h for the linear equations M y'' + C y' + K y = F(t).    //
+//                                                                            //
+//  Arguments:                                                                //
+//     struct Generalized_Alpha *s  The integrator.                           //
+//     double t      The time at the start of the step.                       //
+//     double d[]    On input the displacements at t, on output at t + h.     //
+//     double v[]    On input the velocities at t, on output at t + h.        //
+//     double a[]    On input the accelerations at t, on output at t + h.     //
+//     void   *force Pointer to the function which sets the external forces,  //
+//                   force(t, F).                                             //
+//                                                                            //
+//  Return Values:                                                            //
+//     none                                                                   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Generalized_Alpha_Step( struct Generalized_Alpha *s, double t,
+         double d[], double v[], double a[], void (*force)(double, double[]) ) {
+
+   int n = s->n;
+   double h = s->h;
+   double am = s->alpha_m;
+   double af = s->alpha_f;
+   double *dp = s->work;
+   double *vp = dp + n;
+   double *rhs = vp + n;
+   double *x = rhs + n;
+   double c1 = h * h * (0.5 - s->beta);
+   double c2 = h * (1.0 - s->gamma);
+   int i;
+
+                       // The predictors and the weighted states. //
+
+   for (i = 0; i < n; i++) {
+      dp[i] = d[i] + h * v[i] + c1 * a[i];
+      vp[i] = v[i] + c2 * a[i];
+   }
+   (*force)(t + (1.0 - af) * h, rhs);
+   CSR_Multiply_Add( n, s->M_row, s->M_col, s->M_val, -am, a, rhs );
+   if (s->C_row != NULL) {
+      for (i = 0; i < n; i++) x[i] = (1.0 - af) * vp[i] + af * v[i];
+      CSR_Multiply_Add( n, s->C_row, s->C_col, s->C_val, -1.0, x, rhs );
+   }
+   for (i = 0; i < n; i++) x[i] = (1.0 - af) * dp[i] + af * d[i];
+   CSR_Multiply_Add( n, s->K_row, s->K_col, s->K_val, -1.0, x, rhs );
+
+                       // Solve S a[n+1] = rhs and correct. //
+
+   Skyline_Solve( &s->S, rhs );
+   c1 = s->beta * h * h;
+   c2 = s->gamma * h;
+   for (i = 0; i < n; i++) {
+      a[i] = rhs[i];
+      d[i] = dp[i] + c1 * a[i];
+      v[i] = vp[i] + c2 * a[i];
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Generalized_Alpha_Step_Nonlinear( struct Generalized_Alpha *s,        //
+//         double t, double d[], double v[], double a[],                      //
+//         void (*force)(double, double[]),                                   //
+//         void (*internal_force)(double[], double[]), double tolerance,      //
+//                                      int max_iterations, int *iterations ) //
+//                                                                            //
+//  Description:                                                              //
+//     Advances d[], v[] and a[] from t to t + h for the equations            //
+//     M y'' + C y' + fint(y) = F(t) by the modified Newton method, each      //
+//     iteration costing one evaluation of the internal forces and one        //
+//     forward and back substitution with the factorization of S.  The        //
+//     iteration stops when the correction of the accelerations satisfies     //
+//     max |da| <= tolerance * (1 + max |a|).                                 //
+//                                                                            //
+//  Arguments:                                                                //
+//     struct Generalized_Alpha *s  The integrator.                           //
+//     double t      The time at the start of the step.                       //
+//     double d[]    On input the displacements at t, on output at t + h.     //
+//     double v[]    On input the velocities at t, on output at t + h.        //
+//     double a[]    On input the accelerations at t, on output at t + h.     //
+//     void   *force Pointer to the function which sets the external forces,  //
+//                   force(t, F).                                             //
+//     void   *internal_force  Pointer to the function which sets the         //
+//                   internal forces, internal_force(d, fint).                //
+//     double tolerance       The relative tolerance of the iteration.        //
+//     int    max_iterations  The maximum number of iterations.               //
+//     int    *iterations     If not NULL, the number of iterations used.     //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -1 if the iteration did not converge, in which case   //
+//     d[], v[] and a[] are unchanged.                                        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Generalized_Alpha_Step_Nonlinear( struct Generalized_Alpha *s, double t,
+            double d[], double v[], double a[], void (*force)(double, double[]),
+            void (*internal_force)(double[], double[]), double tolerance,
+                                        int max_iterations, int *iterations ) {
+
+   int n = s->n;
+   double h = s->h;
+   double am = s->alpha_m;
+   double af = s->alpha_f;
+   double *dn = s->work;                   // d[n+1]
+   double *vn = dn + n;                    // v[n+1]
+   double *an = vn + n;                    // a[n+1]
+   double *r = an + n;                     // the residual
+   double *x = r + n;
+   double *f_old = x + n;                  // F - af fint(d[n]) - am M a[n]
+   double c1 = h * h * (0.5 - s->beta);
+   double c2 = h * (1.0 - s->gamma);
+   double bh2 = s->beta * h * h;
+   double gh = s->gamma * h;
+   double da, amax;
+   int i, k;
+
+                   // The terms which do not change during the iteration. //
+
+   (*internal_force)(d, x);
+   (*force)(t + (1.0 - af) * h, f_old);
+   for (i = 0; i < n; i++) f_old[i] -= af * x[i];
+   CSR_Multiply_Add( n, s->M_row, s->M_col, s->M_val, -am, a, f_old );
+   if (s->C_row != NULL)
+      CSR_Multiply_Add( n, s->C_row, s->C_col, s->C_val, -af, v, f_old );
+   for (i = 0; i < n; i++) an[i] = a[i];
+
+   for (k = 1; k <= max_iterations; k++) {
+      for (i = 0; i < n; i++) {
+         dn[i] = d[i] + h * v[i] + c1 * a[i] + bh2 * an[i];
+         vn[i] = v[i] + c2 * a[i] + gh * an[i];
+      }
+      (*internal_force)(dn, x);
+      for (i = 0; i < n; i++) r[i] = f_old[i] - (1.0 - af) * x[i];
+      CSR_Multiply_Add( n, s->M_row, s->M_col, s->M_val, -(1.0 - am), an, r );
+      if (s->C_row != NULL)
+         CSR_Multiply_Add( n, s->C_row, s->C_col, s->C_val, -(1.0 - af), vn, r);
+      Skyline_Solve( &s->S, r );
+      da = 0.0;
+      amax = 0.0;
+      for (i = 0; i < n; i++) {
+         an[i] += r[i];
+         if (fabs(r[i]) > da) da = fabs(r[i]);
+         if (fabs(an[i]) > amax) amax = fabs(an[i]);
+      }
+      if ( da <= tolerance * (1.0 + amax) ) break;
+   }
+   if (iterations != NULL) *iterations = (k <= max_iterations) ? k : k - 1;
+   if (k > max_iterations) return -1;
+
+   for (i = 0; i < n; i++) {
+      d[i] += h * v[i] + c1 * a[i] + bh2 * an[i];
+      v[i] += c2 * a[i] + gh * an[i];
+      a[i] = an[i];
+   }
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Generalized_Alpha_Free( struct Generalized_Alpha *s )                //
+//                                                                            //
+//  Description:                                                              //
+//     Releases an integrator created by Generalized_Alpha_Create().  The     //
+//     matrices passed to Generalized_Alpha_Create() are not freed.           //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Generalized_Alpha_Free( struct Generalized_Alpha *s ) {
+
+   if (s == NULL) return;
+   Skyline_Free( &s->S );
+   free(s->work);
+   free(s);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static int Skyline_Build( struct Skyline *s, int n, int *row[],           //
+//                int *col[], double *val[], double coef[], int m )           //
+//                                                                            //
+//  Description:                                                              //
+//     Sets up the envelope of coef[0] A[0] + ... + coef[m-1] A[m-1], the     //
+//     A[k] being given in CSR storage, and stores the lower triangle of the  //
+//     sum in it.  Returns 0 if successful or -2 if memory could not be       //
+//     allocated.                                                             //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static int Skyline_Build( struct Skyline *s, int n, int *row[], int *col[],
+                                      double *val[], double coef[], int m ) {
+
+   int i, j, k, p;
+
+   s->n = n;
+   s->first = (int*) malloc( (2 * n + 1) * sizeof(int) );
+   s->diag = (double*) malloc( n * sizeof(double) );
+   s->env = NULL;
+   if (s->first == NULL || s->diag == NULL) { Skyline_Free(s); return -2; }
+   s->ptr = s->first + n;
+
+   for (i = 0; i < n; i++) {
+      s->first[i] = i;
+      s->diag[i] = 0.0;
+   }
+   for (k = 0; k < m; k++)
+      for (i = 0; i < n; i++)
+         for (p = row[k][i]; p < row[k][i+1]; p++)
+            if (col[k][p] < s->first[i]) s->first[i] = col[k][p];
+
+   s->ptr[0] = 0;
+   for (i = 0; i < n; i++) s->ptr[i+1] = s->ptr[i] + i - s->first[i];
+   s->env = (double*) calloc( s->ptr[n] + 1, sizeof(double) );
+   if (s->env == NULL) { Skyline_Free(s); return -2; }
+
+   for (k = 0; k < m; k++)
+      for (i = 0; i < n; i++)
+         for (p = row[k][i]; p < row[k][i+1]; p++) {
+            j = col[k][p];
+            if (j == i) s->diag[i] += coef[k] * val[k][p];
+            else if (j < i)
+               s->env[s->ptr[i] + j - s->first[i]] += coef[k] * val[k][p];
+         }
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static int Skyline_Factor( struct Skyline *s )                            //
+//                                                                            //
+//  Description:                                                              //
+//     Factors the matrix in place as L D L' by rows.  For j < i,             //
+//        g[i][j] = a[i][j] - Sum g[i][k] L[j][k],  L[i][j] = g[i][j] / D[j], //
+//        D[i] = a[i][i] - Sum g[i][k] L[i][k],                               //
+//     the sums extending over the columns k < j in the envelopes of both     //
+//     rows.  Returns 0 if successful or -1 if a pivot D[i] is not positive.  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static int Skyline_Factor( struct Skyline *s ) {
+
+   double *ri, *rj;
+   double sum, g;
+   int i, j, k, fi, fj, k0;
+
+   for (i = 0; i < s->n; i++) {
+      fi = s->first[i];
+      ri = s->env + s->ptr[i] - fi;              // ri[j] is entry (i,j)
+      for (j = fi; j < i; j++) {
+         fj = s->first[j];
+         rj = s->env + s->ptr[j] - fj;
+         k0 = (fi > fj) ? fi : fj;
+         sum = ri[j];
+         for (k = k0; k < j; k++) sum -= ri[k] * rj[k];
+         ri[j] = sum;                            // g[i][j]
+      }
+      sum = s->diag[i];
+      for (j = fi; j < i; j++) {
+         g = ri[j];
+         ri[j] = g / s->diag[j];                 // L[i][j]
+         sum -= g * ri[j];
+      }
+      if ( !(sum > 0.0) ) return -1;
+      s->diag[i] = sum;
+   }
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static void Skyline_Solve( struct Skyline *s, double x[] )                //
+//                                                                            //
+//  Description:                                                              //
+//     Solves L D L' x = b, b given in x[] on input, by forward substitution, //
+//     division by D and back substitution.                                   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static void Skyline_Solve( struct Skyline *s, double x[] ) {
+
+   double *ri;
+   double sum;
+   int i, k, fi;
+
+   for (i = 0; i < s->n; i++) {
+      fi = s->first[i];
+      ri = s->env + s->ptr[i] - fi;
+      sum = x[i];
+      for (k = fi; k < i; k++) sum -= ri[k] * x[k];
+      x[i] = sum;
+   }
+   for (i = 0; i < s->n; i++) x[i] /= s->diag[i];
+   for (i = s->n - 1; i >= 0; i--) {
+      fi = s->first[i];
+      ri = s->env + s->ptr[i] - fi;
+      for (k = fi; k < i; k++) x[k] -= ri[k] * x[i];
+   }
+}
+
+
+static void Skyline_Free( struct Skyline *s ) {
+
+   free(s->first);
+   free(s->diag);
+   free(s->env);
+   s->first = NULL;
+   s->diag = NULL;
+   s->env = NULL;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static void CSR_Multiply_Add( int n, int row[], int col[], double val[],  //
+//                                     double coef, double x[], double y[] )  //
+//                                                                            //
+//  Description:                                                              //
+//     Sets y = y + coef A x where A is the n x n matrix in CSR storage.      //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static void CSR_Multiply_Add( int n, int row[], int col[], double val[],
+                                         double coef, double x[], double y[] ) {
+
+   double sum;
+   int i, p;
+
+   if (coef == 0.0) return;
+   for (i = 0; i < n; i++) {
+      sum = 0.0;
+      for (p = row[i]; p < row[i+1]; p++) sum += val[p] * x[col[p]];
+      y[i] += coef * sum;
+   }
+}
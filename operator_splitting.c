@@ -0,0 +1,426 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: operator_splitting.c                                                 //
+// Routines:                                                                  //
+//    Operator_Splitting_Create                                               //
+//    Operator_Splitting_Set_Operator                                         //
+//    Operator_Splitting_Integrate                                            //
+//    Operator_Splitting_Free                                                 //
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Description:                                                              //
+//     If the right hand side of the system y' = f(x,y) is a sum of two or    //
+//     three operators, y' = A(x,y) + B(x,y) (+ C(x,y)), e.g. the reaction,   //
+//     diffusion and advection terms of a reaction-diffusion-advection model, //
+//     each of which is best integrated by a different method, then the       //
+//     flow of y' = f(x,y) over a step h may be approximated by a composition //
+//     of the flows of the operators taken one at a time.  Denote by A(t) the //
+//     approximate flow of y' = A(x,y) over the time t, given by a user       //
+//     supplied stepper.  Then the splitting schemes are                      //
+//                                                                            //
+//     Lie (order 1):      S(h) = C(h) B(h) A(h),                             //
+//     Strang (order 2):   S(h) = A(h/2) B(h/2) C(h) B(h/2) A(h/2),           //
+//                                                                            //
+//     applying the rightmost flow first, and the compositions of Strang      //
+//     steps of order p = 4, 6 or 8 built recursively from those of order     //
+//     p - 2 by                                                               //
+//                                                                            //
+//     Yoshida:  S[p](h) = S[p-2](w h) S[p-2]((1-2w) h) S[p-2](w h),          //
+//               w = 1 / (2 - 2^(1/(p-1))),                                   //
+//     Suzuki:   S[p](h) = S[p-2](w h)^2 S[p-2]((1-4w) h) S[p-2](w h)^2,      //
+//               w = 1 / (4 - 4^(1/(p-1))).                                   //
+//                                                                            //
+//     The Yoshida compositions use fewer flows, 3^(p/2-1) Strang steps, the  //
+//     Suzuki compositions, 5^(p/2-1) Strang steps, have smaller error        //
+//     constants.  Both contain steps backward in time, (1-2w) and (1-4w)     //
+//     being negative, which a stepper for a dissipative operator such as     //
+//     diffusion may not tolerate; for those Strang splitting is the highest  //
+//     order available.  Adjacent flows of the same operator are merged, so   //
+//     that e.g. a Strang step costs one flow of A fewer than it appears.     //
+//                                                                            //
+//     Each operator may be divided into substeps, the flow over t being      //
+//     taken as that many steps of t / substeps, e.g. for a stiff reaction    //
+//     integrated by an explicit method.  An operator may also be declared    //
+//     to act independently on cells of a fixed number of components, e.g.    //
+//     the reaction at each point of a grid, in which case the stepper is     //
+//     called for each cell separately and the cells are divided among the    //
+//     threads by Thread_Pool_Parallel_For(), see thread_pool.c.  The         //
+//     stepper of such an operator must then be safe to call concurrently.    //
+//                                                                            //
+//     Compile with -pthread.                                                 //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>                             // required for malloc()
+#include <math.h>                               // required for pow()
+#include <stdatomic.h>                          // required for atomic_int
+
+#define MAX_OPERATORS 3
+#define MAX_SPLITTING_ORDER 8
+
+int Thread_Pool_Parallel_For( int first, int last, int grain,
+                        void (*body)(int lo, int hi, void *arg), void *arg );
+
+struct Split_Operator {
+   int (*step)(double, double, double[], int, void*);
+   void *context;
+   int substeps;
+   int cell_size;                  // 0 if the operator acts on all of y
+};
+
+struct Operator_Splitting {
+   int operators;
+   int count;                      // the number of flows per step
+   int *op;                        // op[j] is the operator of the j-th flow
+   double *fraction;               // and fraction[j] * h its time
+   struct Split_Operator op_info[MAX_OPERATORS];
+};
+
+struct Cell_Job {
+   struct Split_Operator *op;
+   double *y;
+   double x;
+   double dt;
+   atomic_int err;
+};
+
+static int Strang_Fractions( double fraction[], int scheme, int order,
+                                                           double scale );
+static void Append( struct Operator_Splitting *s, int op, double fraction );
+static int Advance( struct Split_Operator *op, double y[], int n, double x,
+                                                                 double t );
+static void Advance_Cells( int lo, int hi, void *arg );
+void Operator_Splitting_Free( struct Operator_Splitting *s );
+
+////////////////////////////////////////////////////////////////////////////////
+//  struct Operator_Splitting* Operator_Splitting_Create( int operators,      //
+//                                        int scheme, int order, int *err )   //
+//                                                                            //
+//  Description:                                                              //
+//     Creates a splitting of y' = f(x,y) into the given number of operators  //
+//     composed by the given scheme.  The operators are then defined by       //
+//     Operator_Splitting_Set_Operator().                                     //
+//                                                                            //
+//  Arguments:                                                                //
+//     int    operators  The number of operators, 2 or 3.                     //
+//     int    scheme     0 for Lie, 1 for Strang, 2 for Yoshida and 3 for     //
+//                       Suzuki splitting.                                    //
+//     int    order      The order of the Yoshida or Suzuki composition,      //
+//                       4, 6 or 8, ignored for the Lie and Strang schemes.   //
+//     int    *err       0 if successful, -2 if memory could not be allocated //
+//                       and -3 if an argument is invalid.                    //
+//                                                                            //
+//  Return Values:                                                            //
+//     A pointer to the splitting, which must be released with                //
+//     Operator_Splitting_Free(), or NULL if an error occurred.               //
+//                                                                            //
+//  Example:                                                                  //
+//     struct Operator_Splitting *s;                                          //
+//     int err;                                                               //
+//                                                                            //
+//     s = Operator_Splitting_Create( 2, 1, 2, &err );                        //
+//     Operator_Splitting_Set_Operator( s, 0, reaction, NULL, 4, 3 );         //
+//     Operator_Splitting_Set_Operator( s, 1, diffusion, grid, 1, 0 );        //
+//     err = Operator_Splitting_Integrate( s, y, 3 * cells, 0.0, 0.01, 100 ); //
+//     Operator_Splitting_Free( s );                                          //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+struct Operator_Splitting* Operator_Splitting_Create( int operators,
+                                        int scheme, int order, int *err ) {
+
+   struct Operator_Splitting *s;
+   double *strang;
+   int blocks, i, j, k;
+
+   *err = -3;
+   if (operators < 2 || operators > MAX_OPERATORS) return NULL;
+   if (scheme < 0 || scheme > 3) return NULL;
+   if (scheme < 2) order = (scheme == 0) ? 1 : 2;
+   else if (order < 4 || order > MAX_SPLITTING_ORDER || order % 2)
+      return NULL;
+
+             // The number of Strang steps of the composition. //
+
+   for (blocks = 1, i = 4; i <= order; i += 2) blocks *= (scheme == 2) ? 3 : 5;
+
+   *err = -2;
+   s = (struct Operator_Splitting*) malloc( sizeof(struct Operator_Splitting) );
+   if (s == NULL) return NULL;
+   s->operators = operators;
+   s->count = 0;
+   k = blocks * (2 * operators - 1);
+   s->op = (int*) malloc( k * sizeof(int) );
+   s->fraction = (double*) malloc( k * sizeof(double) );
+   strang = (double*) malloc( blocks * sizeof(double) );
+   if (s->op == NULL || s->fraction == NULL || strang == NULL) {
+      free(strang);
+      Operator_Splitting_Free( s );
+      return NULL;
+   }
+   for (k = 0; k < operators; k++) {
+      s->op_info[k].step = NULL;
+      s->op_info[k].context = NULL;
+      s->op_info[k].substeps = 1;
+      s->op_info[k].cell_size = 0;
+   }
+
+   if (scheme == 0)
+      for (k = 0; k < operators; k++) Append( s, k, 1.0 );
+   else {
+      Strang_Fractions( strang, scheme, order, 1.0 );
+      for (j = 0; j < blocks; j++) {
+         for (k = 0; k < operators - 1; k++) Append( s, k, 0.5 * strang[j] );
+         Append( s, operators - 1, strang[j] );
+         for (k = operators - 2; k >= 0; k--) Append( s, k, 0.5 * strang[j] );
+      }
+   }
+   free(strang);
+   *err = 0;
+   return s;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Operator_Splitting_Set_Operator( struct Operator_Splitting *s, int k, //
+//             int (*step)(double x, double t, double y[], int n, void *ctx), //
+//                        void *context, int substeps, int cell_size )        //
+//                                                                            //
+//  Description:                                                              //
+//     Defines the k-th operator, k = 0 being applied first, by a stepper     //
+//     which approximates the flow of y' = A(x,y) from x to x + t.  The       //
+//     stepper is called as step(x, t, y, n, context), t may be negative for  //
+//     the Yoshida and Suzuki schemes, and returns 0 if successful or a       //
+//     nonzero error code which is returned by Operator_Splitting_Integrate().//
+//                                                                            //
+//  Arguments:                                                                //
+//     struct Operator_Splitting *s  The splitting.                           //
+//     int    k          The operator, 0 <= k < operators.                    //
+//     int    (*step)()  The stepper.                                         //
+//     void   *context   Its last argument.                                   //
+//     int    substeps   The number of steps into which each flow of the      //
+//                       operator is divided, at least 1.                     //
+//     int    cell_size  0 if the operator acts on all n components of y.     //
+//                       Otherwise the operator acts independently on each of //
+//                       the n / cell_size consecutive cells of cell_size     //
+//                       components, and step() is called for each cell in    //
+//                       parallel with y the first component of the cell and  //
+//                       n = cell_size.                                       //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -3 if an argument is invalid.                         //
+//                                                                            //
+//  Example:                                                                  //
+//     Using Runge_Kutta_Verner_System() for a reaction with three species    //
+//     in each cell,                                                          //
+//                                                                            //
+//     int reaction(double x, double t, double y[], int n, void *context) {   //
+//        double work[8 * 3];                                                 //
+//                                                                            //
+//        Runge_Kutta_Verner_System( rates, y, 3, x, t, 1, work );            //
+//        return 0;                                                           //
+//     }                                                                      //
+//                                                                            //
+//     Operator_Splitting_Set_Operator( s, 0, reaction, NULL, 4, 3 );         //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Operator_Splitting_Set_Operator( struct Operator_Splitting *s, int k,
+                   int (*step)(double, double, double[], int, void*),
+                              void *context, int substeps, int cell_size ) {
+
+   if (k < 0 || k >= s->operators || step == NULL) return -3;
+   if (substeps < 1 || cell_size < 0) return -3;
+   s->op_info[k].step = step;
+   s->op_info[k].context = context;
+   s->op_info[k].substeps = substeps;
+   s->op_info[k].cell_size = cell_size;
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Operator_Splitting_Integrate( struct Operator_Splitting *s,           //
+//         double y[], int n, double x0, double h, int number_of_steps )      //
+//                                                                            //
+//  Description:                                                              //
+//     Advances the solution of y' = f(x,y) from x0 by number_of_steps steps  //
+//     of size h of the splitting.  Each operator is given the time at which  //
+//     its own flows start, e.g. for Strang splitting A is advanced from x to //
+//     x + h/2 and then from x + h/2 to x + h.                                //
+//                                                                            //
+//  Arguments:                                                                //
+//     struct Operator_Splitting *s  The splitting.                           //
+//     double y[]   On input y(x0), on output y(x0 + number_of_steps * h).    //
+//     int    n     The number of equations, a multiple of the cell sizes.    //
+//     double x0    The initial value of x.                                   //
+//     double h     The step size.                                            //
+//     int    number_of_steps  The number of steps.                           //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -3 if an operator has not been set or n is not a      //
+//     multiple of its cell size, otherwise the first nonzero value returned  //
+//     by a stepper, y[] then being left at the point of failure.             //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Operator_Splitting_Integrate( struct Operator_Splitting *s,
+              double y[], int n, double x0, double h, int number_of_steps ) {
+
+   double elapsed[MAX_OPERATORS];
+   double x;
+   int i, j, k, err;
+
+   for (k = 0; k < s->operators; k++) {
+      if (s->op_info[k].step == NULL) return -3;
+      if (s->op_info[k].cell_size > 0 && n % s->op_info[k].cell_size)
+         return -3;
+   }
+   for (i = 0; i < number_of_steps; i++) {
+      x = x0 + i * h;
+      for (k = 0; k < s->operators; k++) elapsed[k] = 0.0;
+      for (j = 0; j < s->count; j++) {
+         k = s->op[j];
+         err = Advance( &s->op_info[k], y, n, x + elapsed[k] * h,
+                                                      s->fraction[j] * h );
+         if (err) return err;
+         elapsed[k] += s->fraction[j];
+      }
+   }
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Operator_Splitting_Free( struct Operator_Splitting *s )              //
+//                                                                            //
+//  Description:                                                              //
+//     Releases a splitting created by Operator_Splitting_Create().           //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Operator_Splitting_Free( struct Operator_Splitting *s ) {
+
+   if (s == NULL) return;
+   free(s->op);
+   free(s->fraction);
+   free(s);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static int Strang_Fractions( double fraction[], int scheme, int order,    //
+//                                                          double scale )    //
+//                                                                            //
+//  Description:                                                              //
+//     Stores the fractions of the step taken by the successive Strang steps  //
+//     of the Yoshida (scheme 2) or Suzuki (scheme 3) composition of the      //
+//     given order, times scale, and returns their number.                    //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static int Strang_Fractions( double fraction[], int scheme, int order,
+                                                            double scale ) {
+
+   double w;
+   int count = 0;
+
+   if (order <= 2) { fraction[0] = scale; return 1; }
+   if (scheme == 2) {
+      w = 1.0 / (2.0 - pow(2.0, 1.0 / (order - 1)));
+      count += Strang_Fractions( fraction, scheme, order - 2, w * scale );
+      count += Strang_Fractions( fraction + count, scheme, order - 2,
+                                                 (1.0 - 2.0 * w) * scale );
+      count += Strang_Fractions( fraction + count, scheme, order - 2,
+                                                              w * scale );
+   }
+   else {
+      w = 1.0 / (4.0 - pow(4.0, 1.0 / (order - 1)));
+      count += Strang_Fractions( fraction, scheme, order - 2, w * scale );
+      count += Strang_Fractions( fraction + count, scheme, order - 2,
+                                                              w * scale );
+      count += Strang_Fractions( fraction + count, scheme, order - 2,
+                                                 (1.0 - 4.0 * w) * scale );
+      count += Strang_Fractions( fraction + count, scheme, order - 2,
+                                                              w * scale );
+      count += Strang_Fractions( fraction + count, scheme, order - 2,
+                                                              w * scale );
+   }
+   return count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static void Append( struct Operator_Splitting *s, int op,                 //
+//                                                       double fraction )    //
+//                                                                            //
+//  Description:                                                              //
+//     Appends a flow of the operator op to the composition, merging it with  //
+//     the last flow if that is of the same operator.                         //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static void Append( struct Operator_Splitting *s, int op, double fraction ) {
+
+   if (s->count > 0 && s->op[s->count - 1] == op)
+      s->fraction[s->count - 1] += fraction;
+   else {
+      s->op[s->count] = op;
+      s->fraction[s->count] = fraction;
+      s->count++;
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static int Advance( struct Split_Operator *op, double y[], int n,         //
+//                                                  double x, double t )      //
+//                                                                            //
+//  Description:                                                              //
+//     Advances y by the flow of the operator from x to x + t in its          //
+//     substeps, for an operator acting on cells each cell in parallel        //
+//     through all the substeps.                                              //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static int Advance( struct Split_Operator *op, double y[], int n, double x,
+                                                                 double t ) {
+
+   struct Cell_Job job;
+   double dt = t / op->substeps;
+   int i, err;
+
+   if (op->cell_size > 0) {
+      job.op = op;
+      job.y = y;
+      job.x = x;
+      job.dt = dt;
+      atomic_init( &job.err, 0 );
+      Thread_Pool_Parallel_For( 0, n / op->cell_size, 0, Advance_Cells,
+                                                                     &job );
+      return atomic_load( &job.err );
+   }
+   for (i = 0; i < op->substeps; i++) {
+      err = (*op->step)(x + i * dt, dt, y, n, op->context);
+      if (err) return err;
+   }
+   return 0;
+}
+
+
+static void Advance_Cells( int lo, int hi, void *arg ) {
+
+   struct Cell_Job *job = (struct Cell_Job*) arg;
+   struct Split_Operator *op = job->op;
+   int m = op->cell_size;
+   int cell, i, err, expected;
+
+   for (cell = lo; cell < hi; cell++)
+      for (i = 0; i < op->substeps; i++) {
+         err = (*op->step)(job->x + i * job->dt, job->dt, job->y + cell * m, m,
+                                                                op->context);
+         if (err) {
+            expected = 0;
+            atomic_compare_exchange_strong( &job->err, &expected, err );
+            return;
+         }
+      }
+}
@@ -0,0 +1,733 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: rhs_bytecode.c                                                       //
+// Routines:                                                                  //
+//    RHS_Program_Compile                                                     //
+//    RHS_Program_Evaluate                                                    //
+//    RHS_Program_Bind                                                        //
+//    RHS_Program_Scalar                                                      //
+//    RHS_Program_System                                                      //
+//    RHS_Program_Free                                                        //
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Description:                                                              //
+//     The right hand side f(x,y) of a system of n differential equations     //
+//     y' = f(x,y) may be given as text at run time, e.g.                     //
+//                                                                            //
+//           r3 = (y[0]^2 + y[1]^2)^1.5;                                      //
+//           dy[0] = y[2];  dy[1] = y[3];                                     //
+//           dy[2] = -y[0] / r3;  dy[3] = -y[1] / r3                          //
+//                                                                            //
+//     The statements, separated by ';' or new lines, assign an expression    //
+//     either to a derivative dy[i], i = 0,...,n-1, each exactly once, or to  //
+//     a local name which may be used in later statements.  The expressions   //
+//     are formed from numbers, x, y[i], the locals, pi, the operators + - *  //
+//     / and ^ (right associative), parentheses and the functions sin, cos,   //
+//     tan, asin, acos, atan, sinh, cosh, tanh, exp, log, log10, sqrt, abs,   //
+//     atan2(a,b), pow(a,b), min(a,b) and max(a,b).  Text following '#' on a  //
+//     line is a comment.                                                     //
+//                                                                            //
+//     RHS_Program_Compile() parses the text by recursive descent into code   //
+//     for a register machine, folding constant subexpressions, replacing a^2 //
+//     by a*a and a^0.5 by sqrt(a), loading x and each y[i] only once and     //
+//     reusing the registers of temporaries.  Each register holds the values  //
+//     of RHS_LANES states, and each instruction is a loop over the lanes     //
+//     which the compiler vectorizes, so that when a batch of states is       //
+//     evaluated at once the cost of decoding an instruction is shared by all //
+//     the lanes.                                                             //
+//                                                                            //
+//     For use with the existing solvers, whose right hand sides have no user //
+//     argument, a program is bound by RHS_Program_Bind() and then            //
+//     RHS_Program_Scalar() may be passed as f(x,y) to e.g.                   //
+//     Runge_Kutta_Verner() or Gragg_Bulirsch_Stoer() (n = 1), and            //
+//     RHS_Program_System() as f(x,y[],dy[]) to e.g.                          //
+//     Runge_Kutta_Verner_System() or                                         //
+//     Gragg_Bulirsch_Stoer_System_Integrate().                               //
+//     If the program is bound with batch m, RHS_Program_System() treats its  //
+//     argument as m independent states of n components each, so that m       //
+//     trajectories advanced together as one system of mn equations are       //
+//     evaluated in a single pass.                                            //
+//                                                                            //
+//     A program owns its registers and must not be evaluated by two threads  //
+//     at the same time.                                                      //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>                             // required for malloc()
+#include <string.h>                             // required for strncmp()
+#include <ctype.h>                              // required for isalpha()
+#include <math.h>                               // required for sin(), ...
+
+#define RHS_LANES 32
+#define MAX_NAME 32
+#define MAX_LOCALS 256
+
+                 // The binary operations are OP_ADD,...,OP_MAX. //
+
+enum { OP_LOAD_X, OP_LOAD_Y, OP_STORE, OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_POW,
+       OP_ATAN2, OP_MIN, OP_MAX, OP_NEG, OP_SQR, OP_SIN, OP_COS, OP_TAN,
+       OP_ASIN, OP_ACOS, OP_ATAN, OP_SINH, OP_COSH, OP_TANH, OP_EXP, OP_LOG,
+       OP_LOG10, OP_SQRT, OP_ABS };
+
+#define BINARY(op) ((op) >= OP_ADD && (op) <= OP_MAX)
+
+static const struct { const char *name; int op; int arguments; } functions[] =
+{ {"sin", OP_SIN, 1}, {"cos", OP_COS, 1}, {"tan", OP_TAN, 1},
+  {"asin", OP_ASIN, 1}, {"acos", OP_ACOS, 1}, {"atan", OP_ATAN, 1},
+  {"sinh", OP_SINH, 1}, {"cosh", OP_COSH, 1}, {"tanh", OP_TANH, 1},
+  {"exp", OP_EXP, 1}, {"log", OP_LOG, 1}, {"log10", OP_LOG10, 1},
+  {"sqrt", OP_SQRT, 1}, {"abs", OP_ABS, 1}, {"atan2", OP_ATAN2, 2},
+  {"pow", OP_POW, 2}, {"min", OP_MIN, 2}, {"max", OP_MAX, 2} };
+
+#define NUMBER_OF_FUNCTIONS (int) (sizeof(functions) / sizeof(functions[0]))
+
+struct Instruction {
+   int op;
+   int dst;                        // the register, or i of dy[i] for OP_STORE
+   int a;                          // the operands, or i of y[i] for OP_LOAD_Y
+   int b;
+};
+
+struct RHS_Program {
+   int n;
+   int count;                      // the number of instructions
+   int registers;
+   struct Instruction *code;
+   double *reg;                    // reg[r * RHS_LANES + lane]
+};
+
+             // A value during compilation: a register or a constant. //
+
+struct Value {
+   int reg;                        // -1 for a constant
+   double constant;
+};
+
+struct Compiler {
+   const char *text;
+   const char *p;
+   int n;
+   int failed;                     // -1 syntax, -2 memory, -3 components
+   int newline;                    // a new line ends the last statement
+   const char *skipped;            // where Skip_Space() last stopped
+   const char *error;
+   struct Instruction *code;
+   int count, code_size;
+   double *constant;               // the constant of a register, if pinned
+   char *pinned;                   // registers which are never freed
+   int registers, register_size;
+   int *free_list, free_count;
+   int x_reg;
+   int *y_reg;
+   char local_name[MAX_LOCALS][MAX_NAME];
+   struct Value local[MAX_LOCALS];
+   int locals;
+};
+
+static struct RHS_Program *bound = NULL;
+static int bound_batch = 1;
+
+static struct Value Expression( struct Compiler *c );
+static void Skip_Space( struct Compiler *c );
+static int New_Register( struct Compiler *c, int pinned );
+static void Release( struct Compiler *c, struct Value v );
+static int Emit( struct Compiler *c, int op, int dst, int a, int b );
+static int In_Register( struct Compiler *c, struct Value v );
+static double Fold( int op, double a, double b );
+void RHS_Program_Free( struct RHS_Program *p );
+
+////////////////////////////////////////////////////////////////////////////////
+//  struct RHS_Program* RHS_Program_Compile( const char *source, int n,       //
+//                                                int *err, int *position )   //
+//                                                                            //
+//  Description:                                                              //
+//     Compiles the text of the right hand side of n differential equations.  //
+//                                                                            //
+//  Arguments:                                                                //
+//     const char *source  The statements as described above.                 //
+//     int  n              The number of equations.                           //
+//     int  *err           0 if successful, -1 if there is a syntax error,    //
+//                         -2 if memory could not be allocated and -3 if a    //
+//                         derivative is not assigned or assigned twice.      //
+//     int  *position      If not NULL, the offset in source of the error.    //
+//                                                                            //
+//  Return Values:                                                            //
+//     A pointer to the program, which must be released with                  //
+//     RHS_Program_Free(), or NULL if an error occurred.                      //
+//                                                                            //
+//  Example:                                                                  //
+//     struct RHS_Program *p;                                                 //
+//     int err;                                                               //
+//                                                                            //
+//     p = RHS_Program_Compile( "dy[0] = y[1]; dy[1] = -y[0]", 2, &err,       //
+//                                                                  NULL );   //
+//     RHS_Program_Bind( p, 1 );                                              //
+//     Runge_Kutta_Verner_System( RHS_Program_System, y, 2, 0.0, 0.01, 100,   //
+//                                                                  work );   //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+struct RHS_Program* RHS_Program_Compile( const char *source, int n, int *err,
+                                                            int *position ) {
+
+   struct Compiler c;
+   struct RHS_Program *program = NULL;
+   struct Value v;
+   char name[MAX_NAME];
+   char *assigned;
+   int i, k, len, index, reg;
+
+   memset( &c, 0, sizeof(c) );
+   c.text = c.p = source;
+   c.n = n;
+   c.x_reg = -1;
+   c.y_reg = (int*) malloc( n * sizeof(int) );
+   assigned = (char*) calloc( n + 1, 1 );
+   if (c.y_reg == NULL || assigned == NULL) c.failed = -2;
+   for (i = 0; i < n && c.y_reg != NULL; i++) c.y_reg[i] = -1;
+
+   while ( !c.failed ) {
+      Skip_Space( &c );
+      if (*c.p == '\0') break;
+      if (*c.p == ';') { c.p++; continue; }
+
+                 // The target: dy[i] or a local name. //
+
+      if ( !isalpha((unsigned char) *c.p) && *c.p != '_' ) {
+         c.failed = -1; c.error = c.p; break;
+      }
+      for (len = 0; isalnum((unsigned char) c.p[len]) || c.p[len] == '_';
+                                                                     len++)
+         if (len < MAX_NAME - 1) name[len] = c.p[len];
+      name[(len < MAX_NAME - 1) ? len : MAX_NAME - 1] = '\0';
+      c.p += len;
+      index = -1;
+      if ( strcmp(name, "dy") == 0 ) {
+         Skip_Space( &c );
+         if (*c.p != '[') { c.failed = -1; c.error = c.p; break; }
+         c.p++;
+         index = (int) strtol( c.p, (char**) &c.p, 10 );
+         Skip_Space( &c );
+         if (*c.p != ']' || index < 0 || index >= n) {
+            c.failed = -1; c.error = c.p; break;
+         }
+         c.p++;
+      }
+      Skip_Space( &c );
+      if (*c.p != '=') { c.failed = -1; c.error = c.p; break; }
+      c.p++;
+      v = Expression( &c );
+      if (c.failed) break;
+      Skip_Space( &c );
+      if (*c.p != ';' && *c.p != '\0' && !c.newline) {
+         c.failed = -1; c.error = c.p; break;
+      }
+
+      if (index >= 0) {
+         if (assigned[index]) { c.failed = -3; c.error = c.p; break; }
+         assigned[index] = 1;
+         reg = In_Register( &c, v );
+         Emit( &c, OP_STORE, index, reg, 0 );
+         if (v.reg >= 0) Release( &c, v );
+         continue;
+      }
+
+                 // A local keeps its register pinned. //
+
+      for (k = 0; k < c.locals; k++)
+         if ( strcmp(c.local_name[k], name) == 0 ) break;
+      if (k == MAX_LOCALS || !strcmp(name, "x") || !strcmp(name, "y")
+                                                  || !strcmp(name, "pi")) {
+         c.failed = -1; c.error = c.p; break;
+      }
+      if (k == c.locals) {
+         c.locals++;
+         strcpy( c.local_name[k], name );
+      }
+      if (v.reg >= 0 && !c.pinned[v.reg]) c.pinned[v.reg] = 1;
+      c.local[k] = v;
+   }
+   for (i = 0; i < n && !c.failed; i++)
+      if (!assigned[i]) { c.failed = -3; c.error = c.p; }
+
+   if (!c.failed) {
+      program = (struct RHS_Program*) malloc( sizeof(struct RHS_Program) );
+      if (program != NULL) {
+         program->n = n;
+         program->count = c.count;
+         program->registers = c.registers;
+         program->code = c.code;
+         program->reg = (double*) malloc( (c.registers + 1) * RHS_LANES
+                                                           * sizeof(double) );
+         if (program->reg == NULL) { free(program); program = NULL; }
+      }
+      if (program == NULL) c.failed = -2;
+      else {
+
+                 // Fill the registers which hold constants. //
+
+         for (reg = 0; reg < c.registers; reg++)
+            if (c.pinned[reg] == 2)
+               for (i = 0; i < RHS_LANES; i++)
+                  program->reg[reg * RHS_LANES + i] = c.constant[reg];
+         c.code = NULL;
+      }
+   }
+   *err = c.failed;
+   if (position != NULL) *position = (c.error != NULL) ? c.error - c.text : 0;
+   free(c.code);
+   free(c.constant);
+   free(c.pinned);
+   free(c.free_list);
+   free(c.y_reg);
+   free(assigned);
+   return (c.failed) ? NULL : program;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void RHS_Program_Evaluate( struct RHS_Program *p, double x,               //
+//                                    double y[], double dy[], int m )        //
+//                                                                            //
+//  Description:                                                              //
+//     Evaluates dy = f(x,y) for the m states y[j*n],...,y[j*n+n-1],          //
+//     j = 0,...,m-1, RHS_LANES states at a time.                             //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void RHS_Program_Evaluate( struct RHS_Program *p, double x, double y[],
+                                                       double dy[], int m ) {
+
+   struct Instruction *ins, *end = p->code + p->count;
+   double *r = p->reg;
+   double *d, *a, *b;
+   int n = p->n;
+   int base, w, l;
+
+   for (base = 0; base < m; base += RHS_LANES) {
+      w = (m - base < RHS_LANES) ? m - base : RHS_LANES;
+      for (ins = p->code; ins < end; ins++) {
+         d = r + ins->dst * RHS_LANES;
+         a = r + ins->a * RHS_LANES;
+         b = r + ins->b * RHS_LANES;
+         switch (ins->op) {
+            case OP_LOAD_X:
+               for (l = 0; l < w; l++) d[l] = x;
+               break;
+            case OP_LOAD_Y:
+               for (l = 0; l < w; l++) d[l] = y[(base + l) * n + ins->a];
+               break;
+            case OP_STORE:
+               for (l = 0; l < w; l++) dy[(base + l) * n + ins->dst] = a[l];
+               break;
+            case OP_NEG:
+               #pragma omp simd
+               for (l = 0; l < w; l++) d[l] = -a[l];
+               break;
+            case OP_ADD:
+               #pragma omp simd
+               for (l = 0; l < w; l++) d[l] = a[l] + b[l];
+               break;
+            case OP_SUB:
+               #pragma omp simd
+               for (l = 0; l < w; l++) d[l] = a[l] - b[l];
+               break;
+            case OP_MUL:
+               #pragma omp simd
+               for (l = 0; l < w; l++) d[l] = a[l] * b[l];
+               break;
+            case OP_DIV:
+               #pragma omp simd
+               for (l = 0; l < w; l++) d[l] = a[l] / b[l];
+               break;
+            case OP_SQR:
+               #pragma omp simd
+               for (l = 0; l < w; l++) d[l] = a[l] * a[l];
+               break;
+            case OP_SQRT:
+               #pragma omp simd
+               for (l = 0; l < w; l++) d[l] = sqrt(a[l]);
+               break;
+            case OP_ABS:
+               #pragma omp simd
+               for (l = 0; l < w; l++) d[l] = fabs(a[l]);
+               break;
+            case OP_MIN:
+               #pragma omp simd
+               for (l = 0; l < w; l++) d[l] = (b[l] < a[l]) ? b[l] : a[l];
+               break;
+            case OP_MAX:
+               #pragma omp simd
+               for (l = 0; l < w; l++) d[l] = (b[l] > a[l]) ? b[l] : a[l];
+               break;
+            default:
+               for (l = 0; l < w; l++) d[l] = Fold( ins->op, a[l], b[l] );
+         }
+      }
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void RHS_Program_Bind( struct RHS_Program *p, int batch )                 //
+//                                                                            //
+//  Description:                                                              //
+//     Makes p the program evaluated by RHS_Program_Scalar() and              //
+//     RHS_Program_System(), the latter for 'batch' states at a time.         //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void RHS_Program_Bind( struct RHS_Program *p, int batch ) {
+
+   bound = p;
+   bound_batch = (batch > 1) ? batch : 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  double RHS_Program_Scalar( double x, double y )                           //
+//                                                                            //
+//  Description:                                                              //
+//     Returns f(x,y) of the bound program of a single equation.              //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double RHS_Program_Scalar( double x, double y ) {
+
+   double dy;
+
+   RHS_Program_Evaluate( bound, x, &y, &dy, 1 );
+   return dy;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void RHS_Program_System( double x, double y[], double dy[] )              //
+//                                                                            //
+//  Description:                                                              //
+//     Sets dy[] = f(x,y[]) for the bound program, y[] holding batch states   //
+//     of n components each.                                                  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void RHS_Program_System( double x, double y[], double dy[] ) {
+
+   RHS_Program_Evaluate( bound, x, y, dy, bound_batch );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void RHS_Program_Free( struct RHS_Program *p )                            //
+//                                                                            //
+//  Description:                                                              //
+//     Releases a program created by RHS_Program_Compile().                   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void RHS_Program_Free( struct RHS_Program *p ) {
+
+   if (p == NULL) return;
+   if (bound == p) bound = NULL;
+   free(p->code);
+   free(p->reg);
+   free(p);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  The parser.  Each routine returns a constant or a register; a register    //
+//  which is not pinned is owned by the caller, who must release it.          //
+////////////////////////////////////////////////////////////////////////////////
+
+static void Skip_Space( struct Compiler *c ) {
+
+                 // Note whether a new line was passed since the last //
+                 // token, which may end a statement.                 //
+
+   if (c->p == c->skipped) return;
+   c->newline = 0;
+   for (;;) {
+      while ( isspace((unsigned char) *c->p) ) {
+         if (*c->p == '\n') c->newline = 1;
+         c->p++;
+      }
+      if (*c->p != '#') break;
+      while (*c->p != '\n' && *c->p != '\0') c->p++;
+   }
+   c->skipped = c->p;
+}
+
+
+static struct Value Constant( double value ) {
+   struct Value v;
+
+   v.reg = -1;
+   v.constant = value;
+   return v;
+}
+
+
+static struct Value Apply( struct Compiler *c, int op, struct Value a,
+                                                         struct Value b ) {
+   struct Value v;
+   int ra, rb;
+
+   if (c->failed) return Constant(0.0);
+   if ( a.reg < 0 && (b.reg < 0 || !BINARY(op)) )
+      return Constant( Fold(op, a.constant, b.constant) );
+   if (op == OP_POW && b.reg < 0 && b.constant == 2.0) op = OP_SQR;
+   if (op == OP_POW && b.reg < 0 && b.constant == 0.5) op = OP_SQRT;
+   ra = In_Register( c, a );
+   rb = BINARY(op) ? In_Register( c, b ) : 0;
+   Release( c, a );
+   if ( BINARY(op) ) Release( c, b );
+   v.reg = New_Register( c, 0 );
+   v.constant = 0.0;
+   Emit( c, op, v.reg, ra, rb );
+   return v;
+}
+
+
+static struct Value Primary( struct Compiler *c ) {
+
+   struct Value v, w;
+   char name[MAX_NAME];
+   const char *start;
+   int len, k, index;
+
+   Skip_Space( c );
+   start = c->p;
+   if ( isdigit((unsigned char) *c->p) || *c->p == '.' ) {
+      v = Constant( strtod( c->p, (char**) &c->p ) );
+      if (c->p == start) { c->failed = -1; c->error = c->p; }
+      return v;
+   }
+   if (*c->p == '(') {
+      c->p++;
+      v = Expression( c );
+      Skip_Space( c );
+      if (*c->p != ')' && !c->failed) { c->failed = -1; c->error = c->p; }
+      else c->p++;
+      return v;
+   }
+   if ( !isalpha((unsigned char) *c->p) && *c->p != '_' ) {
+      c->failed = -1; c->error = c->p;
+      return Constant(0.0);
+   }
+   for (len = 0; isalnum((unsigned char) c->p[len]) || c->p[len] == '_'; len++)
+      if (len < MAX_NAME - 1) name[len] = c->p[len];
+   name[(len < MAX_NAME - 1) ? len : MAX_NAME - 1] = '\0';
+   c->p += len;
+
+   if ( strcmp(name, "pi") == 0 ) return Constant( 4.0 * atan(1.0) );
+   if ( strcmp(name, "x") == 0 ) {
+      if (c->x_reg < 0) {
+         c->x_reg = New_Register( c, 1 );
+         Emit( c, OP_LOAD_X, c->x_reg, 0, 0 );
+      }
+      v.reg = c->x_reg;
+      return v;
+   }
+   if ( strcmp(name, "y") == 0 ) {
+      Skip_Space( c );
+      if (*c->p != '[') {
+         c->failed = -1; c->error = c->p; return Constant(0.0);
+      }
+      c->p++;
+      index = (int) strtol( c->p, (char**) &c->p, 10 );
+      Skip_Space( c );
+      if (*c->p != ']' || index < 0 || index >= c->n) {
+         c->failed = -1; c->error = c->p; return Constant(0.0);
+      }
+      c->p++;
+      if (c->y_reg[index] < 0) {
+         c->y_reg[index] = New_Register( c, 1 );
+         Emit( c, OP_LOAD_Y, c->y_reg[index], index, 0 );
+      }
+      v.reg = c->y_reg[index];
+      return v;
+   }
+   for (k = 0; k < c->locals; k++)
+      if ( strcmp(c->local_name[k], name) == 0 ) return c->local[k];
+
+                          // A function call. //
+
+   for (k = 0; k < NUMBER_OF_FUNCTIONS; k++)
+      if ( strcmp(functions[k].name, name) == 0 ) break;
+   Skip_Space( c );
+   if (k == NUMBER_OF_FUNCTIONS || *c->p != '(') {
+      c->failed = -1; c->error = start;
+      return Constant(0.0);
+   }
+   c->p++;
+   v = Expression( c );
+   w = Constant(0.0);
+   if (functions[k].arguments == 2) {
+      Skip_Space( c );
+      if (*c->p != ',') { c->failed = -1; c->error = c->p; }
+      else { c->p++; w = Expression( c ); }
+   }
+   Skip_Space( c );
+   if (*c->p != ')') { c->failed = -1; c->error = c->p; }
+   else c->p++;
+   return Apply( c, functions[k].op, v, w );
+}
+
+
+static struct Value Unary( struct Compiler *c );
+
+static struct Value Power( struct Compiler *c ) {
+
+   struct Value v = Primary( c );
+
+   Skip_Space( c );
+   if (*c->p == '^' && !c->failed) {
+      c->p++;
+      return Apply( c, OP_POW, v, Unary( c ) );
+   }
+   return v;
+}
+
+
+static struct Value Unary( struct Compiler *c ) {
+
+   Skip_Space( c );
+   if (*c->p == '-') {
+      c->p++;
+      return Apply( c, OP_NEG, Unary( c ), Constant(0.0) );
+   }
+   if (*c->p == '+') c->p++;
+   return Power( c );
+}
+
+
+static struct Value Term( struct Compiler *c ) {
+
+   struct Value v = Unary( c );
+   int op;
+
+   for (;;) {
+      Skip_Space( c );
+      if (c->failed || (*c->p != '*' && *c->p != '/')) return v;
+      op = (*c->p == '*') ? OP_MUL : OP_DIV;
+      c->p++;
+      v = Apply( c, op, v, Unary( c ) );
+   }
+}
+
+
+static struct Value Expression( struct Compiler *c ) {
+
+   struct Value v = Term( c );
+   int op;
+
+   for (;;) {
+      Skip_Space( c );
+      if (c->failed || (*c->p != '+' && *c->p != '-')) return v;
+      op = (*c->p == '+') ? OP_ADD : OP_SUB;
+      c->p++;
+      v = Apply( c, op, v, Term( c ) );
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  Registers and code.  A pinned register (x, y[i], a local or a constant)   //
+//  is never reused; pinned[r] = 2 marks a register holding a constant.       //
+////////////////////////////////////////////////////////////////////////////////
+
+static int New_Register( struct Compiler *c, int pinned ) {
+
+   int r;
+   void *p;
+
+   if (!pinned && c->free_count > 0) return c->free_list[--c->free_count];
+   if (c->registers == c->register_size) {
+      c->register_size = (c->register_size > 0) ? 2 * c->register_size : 64;
+      if ( (p = realloc( c->constant, c->register_size * sizeof(double) ))
+                                                                    == NULL )
+         { c->failed = -2; return 0; }
+      c->constant = (double*) p;
+      if ( (p = realloc( c->pinned, c->register_size )) == NULL )
+         { c->failed = -2; return 0; }
+      c->pinned = (char*) p;
+      if ( (p = realloc( c->free_list, c->register_size * sizeof(int) ))
+                                                                    == NULL )
+         { c->failed = -2; return 0; }
+      c->free_list = (int*) p;
+   }
+   r = c->registers++;
+   c->pinned[r] = (char) pinned;
+   c->constant[r] = 0.0;
+   return r;
+}
+
+
+static void Release( struct Compiler *c, struct Value v ) {
+
+   if (v.reg >= 0 && !c->pinned[v.reg] && !c->failed)
+      c->free_list[c->free_count++] = v.reg;
+}
+
+
+static int In_Register( struct Compiler *c, struct Value v ) {
+
+   int r;
+
+   if (v.reg >= 0) return v.reg;
+   for (r = 0; r < c->registers; r++)
+      if (c->pinned[r] == 2 && c->constant[r] == v.constant) return r;
+   r = New_Register( c, 2 );
+   if (!c->failed) c->constant[r] = v.constant;
+   return r;
+}
+
+
+static int Emit( struct Compiler *c, int op, int dst, int a, int b ) {
+
+   void *p;
+
+   if (c->failed) return -1;
+   if (c->count == c->code_size) {
+      c->code_size = (c->code_size > 0) ? 2 * c->code_size : 64;
+      p = realloc( c->code, c->code_size * sizeof(struct Instruction) );
+      if (p == NULL) { c->failed = -2; return -1; }
+      c->code = (struct Instruction*) p;
+   }
+   c->code[c->count].op = op;
+   c->code[c->count].dst = dst;
+   c->code[c->count].a = a;
+   c->code[c->count].b = b;
+   return c->count++;
+}
+
+
+static double Fold( int op, double a, double b ) {
+
+   switch (op) {
+      case OP_NEG:   return -a;
+      case OP_ADD:   return a + b;
+      case OP_SUB:   return a - b;
+      case OP_MUL:   return a * b;
+      case OP_DIV:   return a / b;
+      case OP_SQR:   return a * a;
+      case OP_POW:   return pow(a, b);
+      case OP_ATAN2: return atan2(a, b);
+      case OP_MIN:   return (b < a) ? b : a;
+      case OP_MAX:   return (b > a) ? b : a;
+      case OP_SIN:   return sin(a);
+      case OP_COS:   return cos(a);
+      case OP_TAN:   return tan(a);
+      case OP_ASIN:  return asin(a);
+      case OP_ACOS:  return acos(a);
+      case OP_ATAN:  return atan(a);
+      case OP_SINH:  return sinh(a);
+      case OP_COSH:  return cosh(a);
+      case OP_TANH:  return tanh(a);
+      case OP_EXP:   return exp(a);
+      case OP_LOG:   return log(a);
+      case OP_LOG10: return log10(a);
+      case OP_SQRT:  return sqrt(a);
+      case OP_ABS:   return fabs(a);
+   }
+   return 0.0;
+}
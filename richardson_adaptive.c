@@ -0,0 +1,226 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: richardson_adaptive.c                                                //
+// Routines:                                                                  //
+//    Richardson_Adaptive_Integrate                                           //
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Description:                                                              //
+//     The *_Richardson routines of Euler's method and of the Runge-Kutta     //
+//     methods take each step h with 1, 2, 4, ..., 2^(c-1) substeps of the    //
+//     underlying method of order p and extrapolate the c results to the      //
+//     limit.  In row j of the tableau T[j][0..j] the last correction         //
+//                   e[c] = | T[j][j] - T[j][j-1] |,   c = j + 1,             //
+//     is an estimate of the local error of T[j][j-1], of order p + c - 1,    //
+//     obtained at no extra cost, which Richardson_Adaptive_Integrate() uses  //
+//     to integrate from x0 to x1 to a tolerance, choosing the step size and  //
+//     the number of columns jointly as in the extrapolation code ODEX of     //
+//     Hairer and Wanner:                                                     //
+//                                                                            //
+//     A step of size h with target column count k is accepted as soon as     //
+//     e[c] <= tolerance for c = k - 1 or c = k, or for c = k + 1 after one   //
+//     extra row.  Otherwise it is rejected and retried with a smaller step.  //
+//     After an accepted step using c columns, the step size which would make //
+//                   e[c'] = 0.9 tolerance,   i.e.                            //
+//             H[c'] = 0.9 h (tolerance / e[c'])^(1 / (p + c' - 1)),          //
+//     is found for c' = c - 1 and c, and the column count c' with the least  //
+//     work W[c'] = s (2^c' - 1) per unit step H[c'] is chosen, s being the   //
+//     number of evaluations of f per step of the underlying method.  If c'   //
+//     = c = k and the step was not retried, the next step tries k + 1        //
+//     columns with the step size H[k] W[k+1] / W[k].  The ratio of           //
+//     successive step sizes is kept in [0.2, 4].                             //
+//                                                                            //
+//     If a step size controller (see step_size_controller.c) is supplied,    //
+//     the step size of a retry and H[c] after an accepted step are proposed  //
+//     by the controller from e[c] / tolerance, its order being set to        //
+//     p + c - 1, and H[c-1] is the elementary step size above multiplied by  //
+//     the factor by which the controller changed H[c].  The choice of the    //
+//     column count is unchanged.                                             //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+#include <math.h>                               // required for fabs(), pow()
+#include <float.h>                              // required for DBL_EPSILON
+#include <stddef.h>                             // required for NULL
+
+#define MAX_TABLEAU 16
+#define MAX_REJECTIONS 20
+#define MIN_RATIO 0.2
+#define MAX_RATIO 4.0
+#define SAFETY 0.9
+
+struct Step_Controller;
+void Step_Controller_Reset( struct Step_Controller *c );
+void Step_Controller_Set_Order( struct Step_Controller *c, double order );
+double Step_Controller_Next( struct Step_Controller *c, double h,
+                                                double error, int *accept );
+
+static double Step_Ratio( double error, double tolerance, int order );
+
+////////////////////////////////////////////////////////////////////////////////
+//  double Richardson_Adaptive_Integrate(                                     //
+//       double (*method)(double (*)(double, double), double, double,         //
+//       double, int), int order, int stages, const double richardson[],      //
+//       int max_columns, double (*f)(double, double), double y0, double x0,  //
+//       double x1, double *h, double tolerance,                              //
+//       struct Step_Controller *controller, int *columns, int *err )         //
+//                                                                            //
+//  Description:                                                              //
+//     Integrates y' = f(x,y), y(x0) = y0, from x0 to x1 by the method        //
+//     'method' with Richardson extrapolation, choosing the step size and the //
+//     number of columns as described above.  This routine is called by the   //
+//     *_Richardson_Adaptive routines of the individual methods.              //
+//                                                                            //
+//  Arguments:                                                                //
+//     double *method      The underlying method, e.g. Runge_Kutta_Gill.      //
+//     int    order        The order p of the underlying method.              //
+//     int    stages       The evaluations of f per step of the method.       //
+//     double richardson[] richardson[j] = 1 / (2^(p+j) - 1).                 //
+//     int    max_columns  The maximum number of columns, 1 + the number of   //
+//                         elements of richardson[].                          //
+//     double *f           The slope function f(x,y).                         //
+//     double y0           The initial value of y at x0.                      //
+//     double x0           The initial value of x.                            //
+//     double x1           The final value of x, x1 > x0.                     //
+//     double *h           On input the initial step size, on output the      //
+//                         step size proposed for a step beyond x1.  If *h    //
+//                         <= 0 on input, x1 - x0 is used.                    //
+//     double tolerance    The acceptable estimated local error per step.     //
+//     struct Step_Controller *controller  The step size controller created   //
+//                         by Step_Controller_Create(), or NULL for the       //
+//                         elementary step size rule above.                   //
+//     int    *columns     On input the initial number of columns, on output  //
+//                         the number proposed for a step beyond x1.          //
+//     int    *err         0 if successful, -1 if the step size became too    //
+//                         small or MAX_REJECTIONS steps in succession were   //
+//                         rejected.  In that case the solution at the point  //
+//                         reached is returned.                               //
+//                                                                            //
+//  Return Values:                                                            //
+//     The approximation of y(x1).                                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double Richardson_Adaptive_Integrate(
+        double (*method)(double (*)(double, double), double, double, double,
+        int), int order, int stages, const double richardson[],
+        int max_columns, double (*f)(double, double), double y0, double x0,
+        double x1, double *h, double tolerance,
+        struct Step_Controller *controller, int *columns, int *err ) {
+
+   double dt[MAX_TABLEAU];         // dt[i] is the last element in column i.
+   double e[MAX_TABLEAU + 1];      // e[c] is the error estimate using c columns
+   double integral = y0, delta = 0.0;
+   double h_used, hh, h_next, H, best_H, work, best_work;
+   double adjust = 1.0;            // the controller's change of H[c]
+   int k, c, j, m, best, number_sub_intervals, accept;
+   int accepted, last, rejections = 0, retried = 0;
+
+   *err = 0;
+   if (max_columns > MAX_TABLEAU) max_columns = MAX_TABLEAU;
+   if (max_columns < 2) max_columns = 2;
+   k = *columns;
+   if (k < 2) k = 2;
+   if (k > max_columns) k = max_columns;
+   hh = (*h > 0.0) ? *h : x1 - x0;
+   h_next = hh;
+   if (controller != NULL) Step_Controller_Reset( controller );
+
+   while ( x0 < x1 ) {
+      last = ( x0 + hh >= x1 );
+      if (last) hh = x1 - x0;
+
+               // Build the tableau row by row until converged. //
+
+      accepted = 0;
+      h_used = hh;
+      number_sub_intervals = 1;
+      for (c = 1, j = 0; j < max_columns; j++, c++) {
+         integral = (*method)( f, y0, x0, h_used, number_sub_intervals);
+         for (m = 0; m < j; m++) {
+            delta = integral - dt[m];
+            dt[m] = integral;
+            integral += richardson[m] * delta;
+         }
+         dt[j] = integral;
+         h_used *= 0.5;
+         number_sub_intervals += number_sub_intervals;
+         if (j == 0) continue;
+         e[c] = fabs( richardson[j-1] * delta );
+         if ( c >= k - 1 && e[c] <= tolerance ) { accepted = 1; break; }
+         if ( c > k ) break;
+      }
+      if (c > max_columns) c = max_columns;
+
+      if (!accepted) {
+         if (++rejections > MAX_REJECTIONS) { *err = -1; break; }
+         retried = 1;
+         if (controller != NULL) {
+            Step_Controller_Set_Order( controller, order + c - 1 );
+            H = Step_Controller_Next( controller, hh, e[c] / tolerance,
+                                                                  &accept );
+         }
+         else H = hh * Step_Ratio( e[c], tolerance, order + c - 1 );
+         if (H > SAFETY * hh) H = SAFETY * hh;
+         if ( H <= 16.0 * DBL_EPSILON * fmax(fabs(x0), fabs(x1)) ) {
+            *err = -1;
+            break;
+         }
+         hh = H;
+         continue;
+      }
+
+               // Accept the step and choose the next columns and h. //
+
+      y0 = integral;
+      x0 = (last) ? x1 : x0 + hh;
+      best = c;
+      best_H = hh * Step_Ratio( e[c], tolerance, order + c - 1 );
+      if (controller != NULL) {
+         Step_Controller_Set_Order( controller, order + c - 1 );
+         H = Step_Controller_Next( controller, hh, e[c] / tolerance, &accept );
+         adjust = H / best_H;
+         best_H = H;
+      }
+      best_work = stages * (pow(2.0, c) - 1.0) / best_H;
+      if (c > 2) {
+         H = hh * Step_Ratio( e[c-1], tolerance, order + c - 2 ) * adjust;
+         work = stages * (pow(2.0, c - 1) - 1.0) / H;
+         if (work < best_work) { best = c - 1; best_H = H; best_work = work; }
+      }
+      if (best == c && c == k && !retried && k < max_columns) {
+         best = k + 1;
+         best_H *= (pow(2.0, k + 1) - 1.0) / (pow(2.0, k) - 1.0);
+         if (best_H > MAX_RATIO * hh) best_H = MAX_RATIO * hh;
+      }
+      k = best;
+      h_next = best_H;
+      hh = best_H;
+      rejections = 0;
+      retried = 0;
+   }
+   *h = (*err == 0) ? h_next : hh;
+   *columns = k;
+   return y0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static double Step_Ratio( double error, double tolerance, int order )     //
+//                                                                            //
+//  Description:                                                              //
+//     Returns SAFETY (tolerance / error)^(1/order) limited to the interval   //
+//     [MIN_RATIO, MAX_RATIO].                                                //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static double Step_Ratio( double error, double tolerance, int order ) {
+
+   double ratio;
+
+   if ( !(error > 0.0) ) return (error == 0.0) ? MAX_RATIO : MIN_RATIO;
+   ratio = SAFETY * pow( tolerance / error, 1.0 / (double) order );
+   if (ratio < MIN_RATIO) ratio = MIN_RATIO;
+   if (ratio > MAX_RATIO) ratio = MAX_RATIO;
+   return ratio;
+}
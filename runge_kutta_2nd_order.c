@@ -2,6 +2,7 @@
 // File: runge_kutta_2nd_order.c                                              //
 // Routines:                                                                  //
 //    Runge_Kutta_2nd_Order                                                   //
+//    Runge_Kutta_2nd_Order_Embedded_System                                   //
 ////////////////////////////////////////////////////////////////////////////////
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -24,6 +25,10 @@
 //                                                                            //
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <stdlib.h>                             // required for malloc()
+#include <math.h>                               // required for pow(), fabs()
+#include <float.h>                              // required for DBL_EPSILON
+
 static const double one_sixth = 1.0 / 6.0;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -73,3 +78,299 @@ void Runge_Kutta_2nd_Order( double (*f)(double, double, double), double x0,
       c += one_sixth * ( k1 + k2 + k2 + k3 + k3 + k4 );
    }
 }
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  The coefficients of the Runge-Kutta-Nystrom 6(4) pair for the special     //
+//  equations y'' = f(x,y) of J.R. Dormand, M.E.A. El-Mikkawy and P.J. Prince,//
+//  Families of Runge-Kutta-Nystrom formulae, IMA J. Numer. Anal. 7 (1987).   //
+//  The 6th order formula is determined by the nodes c[] together with the    //
+//  row sums abar[i][0] + ... = c[i]^2/2 and the FSAL property, the last row  //
+//  of abar being the weights bbar[] of the new y, bbar[j] = b[j](1 - c[j]).  //
+//  The embedded 4th order formula is that of its one parameter family which  //
+//  does not use the fifth stage.  d[] = b - bhat and dbar[j] = d[j](1 - c[j])//
+//  are the weights of the error estimates of y' and y.                       //
+////////////////////////////////////////////////////////////////////////////////
+
+#define RKN6_STAGES 6
+
+static const double rkn6_c[RKN6_STAGES] = {
+   0.0, 1.0 / 10.0, 3.0 / 10.0, 7.0 / 10.0, 17.0 / 25.0, 1.0
+};
+
+static const double rkn6_abar[RKN6_STAGES][RKN6_STAGES - 1] = {
+   { 0.0 },
+   { 1.0 / 200.0 },
+   { -1.0 / 2200.0, 1.0 / 22.0 },
+   { 637.0 / 6600.0, -7.0 / 110.0, 7.0 / 33.0 },
+   { 225437.0 / 1968750.0, -30073.0 / 281250.0, 65569.0 / 281250.0,
+                                                       -9367.0 / 984375.0 },
+   { 151.0 / 2142.0, 5.0 / 116.0, 385.0 / 1368.0, 55.0 / 168.0,
+                                                        -6250.0 / 28101.0 }
+};
+
+static const double rkn6_b[RKN6_STAGES] = {
+   151.0 / 2142.0, 25.0 / 522.0, 275.0 / 684.0, 275.0 / 252.0,
+   -78125.0 / 112404.0, 1.0 / 12.0
+};
+
+static const double rkn6_d[RKN6_STAGES] = {
+   625.0 / 4284.0, -625.0 / 2088.0, 625.0 / 2736.0, 625.0 / 1008.0,
+   -78125.0 / 112404.0, 0.0
+};
+
+static const double rkn6_dbar[RKN6_STAGES] = {
+   625.0 / 4284.0, -125.0 / 464.0, 875.0 / 5472.0, 125.0 / 672.0,
+   -6250.0 / 28101.0, 0.0
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//  The coefficients of the embedded Runge-Kutta-Nystrom pair for the general //
+//  equations y'' = f(x,y,y') induced by the Dormand-Prince 5(4) pair:        //
+//  a[i][j] are the Dormand-Prince coefficients, abar = a^2, the last rows of //
+//  a and abar are the weights of the 5th order solution, and d[] = b - bhat, //
+//  dbar[] = (b - bhat) a are the weights of the error estimates of y' and y. //
+////////////////////////////////////////////////////////////////////////////////
+
+#define DP_STAGES 7
+
+static const double dp_c[DP_STAGES] = {
+   0.0, 1.0 / 5.0, 3.0 / 10.0, 4.0 / 5.0, 8.0 / 9.0, 1.0, 1.0
+};
+
+static const double dp_a[DP_STAGES][DP_STAGES - 1] = {
+   { 0.0 },
+   { 1.0 / 5.0 },
+   { 3.0 / 40.0, 9.0 / 40.0 },
+   { 44.0 / 45.0, -56.0 / 15.0, 32.0 / 9.0 },
+   { 19372.0 / 6561.0, -25360.0 / 2187.0, 64448.0 / 6561.0, -212.0 / 729.0 },
+   { 9017.0 / 3168.0, -355.0 / 33.0, 46732.0 / 5247.0, 49.0 / 176.0,
+                                                        -5103.0 / 18656.0 },
+   { 35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0, -2187.0 / 6784.0,
+                                                              11.0 / 84.0 }
+};
+
+static const double dp_abar[DP_STAGES][DP_STAGES - 1] = {
+   { 0.0 },
+   { 0.0 },
+   { 9.0 / 200.0, 0.0 },
+   { -12.0 / 25.0, 4.0 / 5.0, 0.0 },
+   { -12248.0 / 6561.0, 7208.0 / 2187.0, -6784.0 / 6561.0, 0.0 },
+   { -533.0 / 264.0, 91.0 / 22.0, -56.0 / 33.0, 7.0 / 88.0, 0.0 },
+   { 35.0 / 384.0, 0.0, 50.0 / 159.0, 25.0 / 192.0, -243.0 / 6784.0, 0.0 }
+};
+
+static const double dp_d[DP_STAGES] = {
+   71.0 / 57600.0, 0.0, -71.0 / 16695.0, 71.0 / 1920.0, -17253.0 / 339200.0,
+   22.0 / 525.0, -1.0 / 40.0
+};
+
+static const double dp_dbar[DP_STAGES] = {
+   611.0 / 230400.0, 0.0, -514.0 / 83475.0, 391.0 / 38400.0,
+   -4617.0 / 1356800.0, -11.0 / 3360.0, 0.0
+};
+
+#define RKN_MAX_STAGES 7
+#define RKN_ORDER 5.0
+#define RKN_MAX_STEPS 100000
+
+double Weighted_RMS_Norm( double e[], double y0[], double y1[], double atol[],
+                                                       double rtol[], int n );
+struct Step_Controller;
+void Step_Controller_Reset( struct Step_Controller *c );
+void Step_Controller_Set_Order( struct Step_Controller *c, double order );
+double Step_Controller_Next( struct Step_Controller *c, double h,
+                                                double error, int *accept );
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Runge_Kutta_2nd_Order_Embedded_System(                                //
+//         void (*f)(double, double[], double[], double[]), double y[],       //
+//         double yp[], int n, double x0, double x1, double *h, double atol[],//
+//         double rtol[], int special, struct Step_Controller *controller,    //
+//                                                        int *evaluations )  //
+//                                                                            //
+//  Description:                                                              //
+//     This routine integrates the system of second order differential        //
+//     equations y'' = f(x,y,y'), y an n-vector, from x0 to x1 with adaptive  //
+//     step sizes by an embedded Runge-Kutta-Nystrom pair.  The stages are    //
+//          Y[i]  = y + c[i] h y' + h^2 Sum abar[i][j] k[j],                  //
+//          Y'[i] = y' + h Sum a[i][j] k[j],                                  //
+//          k[i]  = f(x + c[i] h, Y[i], Y'[i]).                               //
+//     In each pair the last stage is evaluated at the new point and is the   //
+//     first stage of the next step.  The differences between the solutions   //
+//     of y and y' of the two orders are combined in the weighted RMS norm    //
+//     (see weighted_rms_norm.c) of 2n components.                            //
+//                                                                            //
+//     If special is nonzero the differential equations are y'' = f(x,y) and  //
+//     the 6(4) pair of Dormand, El-Mikkawy and Prince is used.  There are no //
+//     velocity stages Y'[i], f is called with NULL in place of Y'[i], and    //
+//          y[n+1] = Y[6],   y'[n+1] = y' + h Sum b[j] k[j],   j = 1,...,6,   //
+//     are both of 6th order for five evaluations of f per step.  Reducing    //
+//     the equations to a first order system of 2n equations and solving it   //
+//     by the Dormand-Prince 5(4) pair costs six evaluations per step for a   //
+//     method of 5th order.                                                   //
+//                                                                            //
+//     If special is zero the stages, i = 1,...,7, are those of the           //
+//     Dormand-Prince 5(4) pair applied to the first order system             //
+//     (y,y')' = (y', f), with abar = a^2, but the stages of the trivial half //
+//     y' of the system are never formed.  The new y = Y[7] and y' = Y'[7]    //
+//     are of 5th order and a step costs six evaluations of f.                //
+//                                                                            //
+//     If controller is NULL the next step size is                            //
+//          h min(5, max(0.2, 0.9 error^(-1/5))),                             //
+//     otherwise it is proposed by the step size controller (see              //
+//     step_size_controller.c), whose order is set to 5, the order of the     //
+//     error estimate of both pairs.                                          //
+//                                                                            //
+//  Arguments:                                                                //
+//     void (*f)(double x, double y[], double yp[], double ypp[])             //
+//            Pointer to the function which evaluates ypp[] = f(x,y[],yp[]).  //
+//     double y[]                                                             //
+//            On input the value of y at x0, on output the value at x1.       //
+//     double yp[]                                                            //
+//            On input the value of y' at x0, on output the value at x1.      //
+//     int    n                                                               //
+//            The number of equations.                                        //
+//     double x0                                                              //
+//            The initial value of x.                                         //
+//     double x1                                                              //
+//            The final value of x, x1 > x0.                                  //
+//     double *h                                                              //
+//            On input the initial step size (if *h <= 0, (x1 - x0) / 100 is  //
+//            used), on output the step size proposed for continuing beyond   //
+//            x1.                                                             //
+//     double atol[]                                                          //
+//            The absolute tolerances, atol[0],...,atol[n-1] for y and        //
+//            atol[n],...,atol[2n-1] for y'.                                  //
+//     double rtol[]                                                          //
+//            The relative tolerances, arranged as atol[].                    //
+//     int    special                                                         //
+//            Nonzero if f does not depend on y'.                             //
+//     struct Step_Controller *controller                                     //
+//            A step size controller or NULL.                                 //
+//     int    *evaluations                                                    //
+//            If not NULL, set to the number of evaluations of f.             //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -1 if the step size became too small or more than     //
+//     RKN_MAX_STEPS steps were taken, in which case y[] and yp[] are the     //
+//     solution at the point reached, and -2 if memory could not be           //
+//     allocated.                                                             //
+//                                                                            //
+//  Example:                                                                  //
+//     #define N 3                                                            //
+//     double y[N], yp[N], atol[2*N], rtol[2*N];                              //
+//     double h = 0.0;                                                        //
+//     void f(double x, double y[], double yp[], double ypp[]);               //
+//                                                                            //
+//     (set the initial values and the tolerances)                            //
+//     if ( Runge_Kutta_2nd_Order_Embedded_System( f, y, yp, N, 0.0, 100.0,   //
+//                                  &h, atol, rtol, 1, NULL, NULL ) < 0 ) ... //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Runge_Kutta_2nd_Order_Embedded_System(
+         void (*f)(double, double[], double[], double[]), double y[],
+         double yp[], int n, double x0, double x1, double *h, double atol[],
+         double rtol[], int special, struct Step_Controller *controller,
+                                                         int *evaluations ) {
+
+   const double *c = (special) ? rkn6_c : dp_c;
+   const double *abar = (special) ? rkn6_abar[0] : dp_abar[0];
+   const double *d = (special) ? rkn6_d : dp_d;
+   const double *dbar = (special) ? rkn6_dbar : dp_dbar;
+   int stages = (special) ? RKN6_STAGES : DP_STAGES;
+   int stride = stages - 1;                    // the row length of abar, a
+   double *work, *k[RKN_MAX_STAGES], *z0, *z1, *e, *swap;
+   double hh, h2, error, ratio, sum, sum_p;
+   int i, j, m, accept, last, steps = 0, count = 0;
+   int status = 0;
+
+   work = (double*) malloc( (stages + 6) * n * sizeof(double) );
+   if (work == NULL) return -2;
+   for (i = 0; i < stages; i++) k[i] = work + i * n;
+   z0 = work + stages * n;               // (y, y') at the start of the step
+   z1 = z0 + 2 * n;                      // the stages and the new (y, y')
+   e = z1 + 2 * n;
+
+   for (m = 0; m < n; m++) { z0[m] = y[m]; z0[n+m] = yp[m]; }
+   if (controller != NULL) {
+      Step_Controller_Reset( controller );
+      Step_Controller_Set_Order( controller, RKN_ORDER );
+   }
+   hh = (*h > 0.0) ? *h : 0.01 * (x1 - x0);
+   (*f)(x0, z0, (special) ? NULL : z0 + n, k[0]);
+   count++;
+
+   while ( x0 < x1 ) {
+      if (++steps > RKN_MAX_STEPS) { status = -1; break; }
+      last = ( x0 + hh >= x1 );
+      if (last) hh = x1 - x0;
+      h2 = hh * hh;
+
+            // The stages.  The last is evaluated at Y[stages], which //
+            // is the new y.                                          //
+
+      for (i = 1; i < stages; i++) {
+         for (m = 0; m < n; m++) {
+            sum = 0.0;
+            for (j = 0; j < i; j++) sum += abar[i * stride + j] * k[j][m];
+            z1[m] = z0[m] + hh * (c[i] * z0[n+m] + hh * sum);
+         }
+         if (!special)
+            for (m = 0; m < n; m++) {
+               sum_p = 0.0;
+               for (j = 0; j < i; j++) sum_p += dp_a[i][j] * k[j][m];
+               z1[n+m] = z0[n+m] + hh * sum_p;
+            }
+         (*f)(x0 + c[i] * hh, z1, (special) ? NULL : z1 + n, k[i]);
+         count++;
+      }
+      if (special)
+         for (m = 0; m < n; m++) {
+            sum_p = 0.0;
+            for (j = 0; j < stages; j++) sum_p += rkn6_b[j] * k[j][m];
+            z1[n+m] = z0[n+m] + hh * sum_p;
+         }
+
+                  // The error estimates of y and y'. //
+
+      for (m = 0; m < n; m++) {
+         sum = 0.0;
+         sum_p = 0.0;
+         for (j = 0; j < stages; j++) {
+            sum += dbar[j] * k[j][m];
+            sum_p += d[j] * k[j][m];
+         }
+         e[m] = h2 * sum;
+         e[n+m] = hh * sum_p;
+      }
+      error = Weighted_RMS_Norm( e, z0, z1, atol, rtol, 2 * n );
+
+      if (controller != NULL)
+         ratio = Step_Controller_Next( controller, hh, error, &accept ) / hh;
+      else {
+         accept = (error <= 1.0);
+         ratio = (error > 0.0) ? 0.9 * pow(error, -1.0 / RKN_ORDER) : 5.0;
+         if ( !(ratio >= 0.2) ) ratio = 0.2;
+         if (ratio > 5.0) ratio = 5.0;
+         if (!accept && ratio > 0.9) ratio = 0.9;
+      }
+
+      if (accept) {
+         x0 = (last) ? x1 : x0 + hh;
+         swap = z0; z0 = z1; z1 = swap;
+         swap = k[0]; k[0] = k[stages - 1]; k[stages - 1] = swap;
+      }
+      else if ( hh * ratio <= 16.0 * DBL_EPSILON * fmax(fabs(x0), fabs(x1)) ) {
+         status = -1;
+         break;
+      }
+      hh *= ratio;
+   }
+
+   for (m = 0; m < n; m++) { y[m] = z0[m]; yp[m] = z0[n+m]; }
+   *h = hh;
+   if (evaluations != NULL) *evaluations = count;
+   free(work);
+   return status;
+}
@@ -5,6 +5,9 @@
 //    Runge_Kutta_Gill_Richardson                                             //
 //    Runge_Kutta_Gill_Integral_Curve                                         //
 //    Runge_Kutta_Gill_Richardson_Integral_Curve                              //
+//    Runge_Kutta_Gill_Richardson_Adaptive                                    //
+//    Runge_Kutta_Gill_Batch_Float                                            //
+//    Runge_Kutta_Gill_Batch_Mixed                                            //
 ////////////////////////////////////////////////////////////////////////////////
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -289,3 +292,197 @@ void Runge_Kutta_Gill_Richardson_Integral_Curve( double (*f)(double, double),
    }
    return;
 }
+
+
+struct Step_Controller;
+double Richardson_Adaptive_Integrate(
+        double (*method)(double (*)(double, double), double, double, double,
+        int), int order, int stages, const double richardson[],
+        int max_columns, double (*f)(double, double), double y0, double x0,
+        double x1, double *h, double tolerance,
+        struct Step_Controller *controller, int *columns, int *err );
+
+////////////////////////////////////////////////////////////////////////////////
+//  double Runge_Kutta_Gill_Richardson_Adaptive(                              //
+//           double (*f)(double, double), double y0, double x0, double x1,    //
+//                   double *h, double tolerance,                             //
+//           struct Step_Controller *controller, int *columns, int *err )     //
+//                                                                            //
+//  Description:                                                              //
+//     This routine uses the Runge-Kutta-Gill method described above with     //
+//     Richardson extrapolation as in Runge_Kutta_Gill_Richardson() but       //
+//     integrates from x0 to x1 to a tolerance.  The difference of the last   //
+//     two entries of the last row of the Richardson tableau is used as an    //
+//     estimate of the local error to accept or reject each step and to       //
+//     choose the size of the next step together with the number of columns,  //
+//     see richardson_adaptive.c.                                             //
+//                                                                            //
+//  Arguments:                                                                //
+//     double *f                                                              //
+//            Pointer to the function which returns the slope at (x,y) of the //
+//            integral curve of the differential equation y' = f(x,y) which   //
+//            passes through the point (x0,y0).                               //
+//     double y0                                                              //
+//            The initial value of y at x = x0.                               //
+//     double x0                                                              //
+//            The initial value of x.                                         //
+//     double x1                                                              //
+//            The final value of x, x1 > x0.                                  //
+//     double *h                                                              //
+//            On input the initial step size (if *h <= 0, x1 - x0 is used),   //
+//            on output the step size proposed for continuing beyond x1.      //
+//     double tolerance                                                       //
+//            The acceptable estimated local error of each step.              //
+//     struct Step_Controller *controller                                     //
+//            The step size controller created by Step_Controller_Create()    //
+//            (see step_size_controller.c), or NULL for the elementary step   //
+//            size rule of richardson_adaptive.c.                             //
+//     int    *columns                                                        //
+//            On input the initial number of columns, at least 2, on output   //
+//            the number proposed for continuing beyond x1.                   //
+//     int    *err                                                            //
+//            0 if successful, -1 if the step size became too small or too    //
+//            many steps in succession were rejected.                         //
+//                                                                            //
+//  Return Values:                                                            //
+//     The solution of the initial value problem y' = f(x,y), y(x0) = y0 at   //
+//     x = x1, or at the point reached if *err is -1.                         //
+//                                                                            //
+//  Example:                                                                  //
+//     double h = 0.1;                                                        //
+//     int columns = 3, err;                                                  //
+//                                                                            //
+//     y1 = Runge_Kutta_Gill_Richardson_Adaptive( f, y0, 0.0, 10.0, &h,       //
+//                                       1.e-10, NULL, &columns, &err );      //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double Runge_Kutta_Gill_Richardson_Adaptive( double (*f)(double, double),
+            double y0, double x0, double x1, double *h, double tolerance,
+               struct Step_Controller *controller, int *columns, int *err ) {
+
+   return Richardson_Adaptive_Integrate( Runge_Kutta_Gill, 4, 4, richardson,
+      MAX_COLUMNS, f, y0, x0, x1, h, tolerance, controller, columns, err );
+}
+
+
+// The stages k1,...,k4 of a single precision step of size h from x0 of the
+// lanes y[], stored in work[0],...,work[4m-1]; the intermediate values are
+// formed in work[4m],...,work[5m-1].
+
+static void Gill_Stages_Float( void (*f)(float, float[], float[], int),
+                     double x0, double h, float y[], float work[], int m ) {
+
+   float *k1 = work, *k2 = work + m, *k3 = work + 2 * m, *k4 = work + 3 * m;
+   float *ytmp = work + 4 * m;
+   const float hf = (float) h, h2 = (float) (0.5 * h);
+   const float a31 = (float) b31, a32 = (float) b32;
+   const float a42 = (float) b42, a43 = (float) b43;
+   int j;
+
+   (*f)((float) x0, y, k1, m);
+   #pragma omp simd
+   for (j = 0; j < m; j++) ytmp[j] = y[j] + h2 * k1[j];
+   (*f)((float) (x0 + 0.5 * h), ytmp, k2, m);
+   #pragma omp simd
+   for (j = 0; j < m; j++) ytmp[j] = y[j] + hf * (a31 * k1[j] + a32 * k2[j]);
+   (*f)((float) (x0 + 0.5 * h), ytmp, k3, m);
+   #pragma omp simd
+   for (j = 0; j < m; j++) ytmp[j] = y[j] + hf * (a42 * k2[j] + a43 * k3[j]);
+   (*f)((float) (x0 + h), ytmp, k4, m);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Runge_Kutta_Gill_Batch_Float(                                        //
+//                  void (*f)(float, float[], float[], int), float y[], int m,//
+//             double x0, double h, int number_of_steps, float work[] )       //
+//                                                                            //
+//  Description:                                                              //
+//     This routine uses the Runge-Kutta-Gill method described above in       //
+//     single precision to advance the m lanes y[0],...,y[m-1] of a batch,    //
+//     e.g. an ensemble of independent equations, by number_of_steps steps    //
+//     of size h.  Each stage is a single loop over the lanes so that, when   //
+//     compiled for AVX-512, sixteen lanes are processed per instruction.     //
+//     Use it when an accuracy of about 1.e-5 suffices.                       //
+//                                                                            //
+//  Arguments:                                                                //
+//     void (*f)(float, float[], float[], int)                                //
+//            The right hand side, f(x, y, dy, m) sets dy[j] for the lanes    //
+//            j = 0,...,m-1 of y at x.                                        //
+//     float  y[]                                                             //
+//            On input the initial values at x = x0, on output the values at  //
+//            x = x0 + number_of_steps * h.                                   //
+//     int    m                                                               //
+//            The number of lanes.                                            //
+//     double x0                                                              //
+//            The initial value of x.                                         //
+//     double h                                                               //
+//            The step size.                                                  //
+//     int    number_of_steps                                                 //
+//            The number of steps. Must be a nonnegative integer.             //
+//     float  work[]                                                          //
+//            Working storage of dimension at least 5 * m.                    //
+//                                                                            //
+//  Return Values:                                                            //
+//     This routine is of type void and hence does not return a value.        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Runge_Kutta_Gill_Batch_Float( void (*f)(float, float[], float[], int),
+                    float y[], int m, double x0, double h, int number_of_steps,
+                                                               float work[] ) {
+
+   float *k1 = work, *k2 = work + m, *k3 = work + 2 * m, *k4 = work + 3 * m;
+   const float h6 = (float) (one_sixth * h);
+   const float fc2 = (float) c2, fc3 = (float) c3;
+   int i, j;
+
+   for (i = 0; i < number_of_steps; i++) {
+      Gill_Stages_Float( f, x0 + i * h, h, y, work, m );
+      #pragma omp simd
+      for (j = 0; j < m; j++)
+         y[j] += h6 * ( k1[j] + fc2 * k2[j] + fc3 * k3[j] + k4[j] );
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Runge_Kutta_Gill_Batch_Mixed(                                        //
+//                 void (*f)(float, float[], float[], int), double y[], int m,//
+//             double x0, double h, int number_of_steps, float work[] )       //
+//                                                                            //
+//  Description:                                                              //
+//     As Runge_Kutta_Gill_Batch_Float() but the lanes y[] are kept in double //
+//     precision.  The stages and the increment of each step are computed in  //
+//     single precision and the increment is then added in double precision,  //
+//     so that the rounding errors of the accumulation do not grow with the   //
+//     number of steps.                                                       //
+//                                                                            //
+//  Arguments:                                                                //
+//     As for Runge_Kutta_Gill_Batch_Float() except that y[] is of type       //
+//     double and work[] must be of dimension at least 6 * m.                 //
+//                                                                            //
+//  Return Values:                                                            //
+//     This routine is of type void and hence does not return a value.        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Runge_Kutta_Gill_Batch_Mixed( void (*f)(float, float[], float[], int),
+                   double y[], int m, double x0, double h, int number_of_steps,
+                                                               float work[] ) {
+
+   float *k1 = work, *k2 = work + m, *k3 = work + 2 * m, *k4 = work + 3 * m;
+   float *ysingle = work + 5 * m;
+   const float h6 = (float) (one_sixth * h);
+   const float fc2 = (float) c2, fc3 = (float) c3;
+   int i, j;
+
+   for (i = 0; i < number_of_steps; i++) {
+      #pragma omp simd
+      for (j = 0; j < m; j++) ysingle[j] = (float) y[j];
+      Gill_Stages_Float( f, x0 + i * h, h, ysingle, work, m );
+      #pragma omp simd
+      for (j = 0; j < m; j++)
+         y[j] += (double) (h6 * ( k1[j] + fc2 * k2[j] + fc3 * k3[j] + k4[j] ));
+   }
+}
@@ -5,6 +5,7 @@
 //    Runge_Kutta_Nystrom_Richardson                                          //
 //    Runge_Kutta_Nystrom_Integral_Curve                                      //
 //    Runge_Kutta_Nystrom_Richardson_Integral_Curve                           //
+//    Runge_Kutta_Nystrom_Richardson_Adaptive                                 //
 ////////////////////////////////////////////////////////////////////////////////
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -312,3 +313,74 @@ void Runge_Kutta_Nystrom_Richardson_Integral_Curve( double (*f)(double, double),
    }
    return;
 }
+
+
+struct Step_Controller;
+double Richardson_Adaptive_Integrate(
+        double (*method)(double (*)(double, double), double, double, double,
+        int), int order, int stages, const double richardson[],
+        int max_columns, double (*f)(double, double), double y0, double x0,
+        double x1, double *h, double tolerance,
+        struct Step_Controller *controller, int *columns, int *err );
+
+////////////////////////////////////////////////////////////////////////////////
+//  double Runge_Kutta_Nystrom_Richardson_Adaptive(                           //
+//           double (*f)(double, double), double y0, double x0, double x1,    //
+//                   double *h, double tolerance,                             //
+//           struct Step_Controller *controller, int *columns, int *err )     //
+//                                                                            //
+//  Description:                                                              //
+//     This routine uses the Runge-Kutta-Nystrom method described above with  //
+//     Richardson extrapolation as in Runge_Kutta_Nystrom_Richardson() but    //
+//     integrates from x0 to x1 to a tolerance.  The difference of the last   //
+//     two entries of the last row of the Richardson tableau is used as an    //
+//     estimate of the local error to accept or reject each step and to       //
+//     choose the size of the next step together with the number of columns,  //
+//     see richardson_adaptive.c.                                             //
+//                                                                            //
+//  Arguments:                                                                //
+//     double *f                                                              //
+//            Pointer to the function which returns the slope at (x,y) of the //
+//            integral curve of the differential equation y' = f(x,y) which   //
+//            passes through the point (x0,y0).                               //
+//     double y0                                                              //
+//            The initial value of y at x = x0.                               //
+//     double x0                                                              //
+//            The initial value of x.                                         //
+//     double x1                                                              //
+//            The final value of x, x1 > x0.                                  //
+//     double *h                                                              //
+//            On input the initial step size (if *h <= 0, x1 - x0 is used),   //
+//            on output the step size proposed for continuing beyond x1.      //
+//     double tolerance                                                       //
+//            The acceptable estimated local error of each step.              //
+//     struct Step_Controller *controller                                     //
+//            The step size controller created by Step_Controller_Create()    //
+//            (see step_size_controller.c), or NULL for the elementary step   //
+//            size rule of richardson_adaptive.c.                             //
+//     int    *columns                                                        //
+//            On input the initial number of columns, at least 2, on output   //
+//            the number proposed for continuing beyond x1.                   //
+//     int    *err                                                            //
+//            0 if successful, -1 if the step size became too small or too    //
+//            many steps in succession were rejected.                         //
+//                                                                            //
+//  Return Values:                                                            //
+//     The solution of the initial value problem y' = f(x,y), y(x0) = y0 at   //
+//     x = x1, or at the point reached if *err is -1.                         //
+//                                                                            //
+//  Example:                                                                  //
+//     double h = 0.1;                                                        //
+//     int columns = 3, err;                                                  //
+//                                                                            //
+//     y1 = Runge_Kutta_Nystrom_Richardson_Adaptive( f, y0, 0.0, 10.0, &h,    //
+//                                       1.e-10, NULL, &columns, &err );      //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double Runge_Kutta_Nystrom_Richardson_Adaptive( double (*f)(double, double),
+            double y0, double x0, double x1, double *h, double tolerance,
+               struct Step_Controller *controller, int *columns, int *err ) {
+
+   return Richardson_Adaptive_Integrate( Runge_Kutta_Nystrom, 5, 6, richardson,
+      MAX_COLUMNS, f, y0, x0, x1, h, tolerance, controller, columns, err );
+}
@@ -5,6 +5,10 @@
 //    Runge_Kutta_Verner_Richardson                                           //
 //    Runge_Kutta_Verner_Integral_Curve                                       //
 //    Runge_Kutta_Verner_Richardson_Integral_Curve                            //
+//    Runge_Kutta_Verner_Richardson_Adaptive                                  //
+//    Runge_Kutta_Verner_System                                               //
+//    Runge_Kutta_Verner_Batch_Float                                          //
+//    Runge_Kutta_Verner_Batch_Mixed                                          //
 ////////////////////////////////////////////////////////////////////////////////
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -93,6 +97,26 @@ static const double  b1  = 9.0 / 180.0;
 static const double  b8  = 49.0 / 180.0;
 static const double  b9  = 64.0 / 180.0;
 
+//  The vector versions keep each stage vector k1,...,k11 only while it is
+//  needed.  Reading the tableau above, the last use of each stage is
+//
+//     k2                in the input of k4,
+//     k3, k4            in the input of k7,
+//     k5, k6, k7        in the input of k11,
+//     k1, k8, ..., k11  in the update of y,
+//
+//  and since the input of a stage is formed before the stage is evaluated,
+//  the stage may overwrite a vector whose last use is its own input.  The
+//  stages are therefore assigned to the slots below, k4 and k8 reuse the
+//  slot of k2, k7 that of k3 and k11 that of k5.  While k10 is evaluated
+//  k1 and k5,...,k9 are live besides the stage input and k10 itself, so
+//  that eight vectors, instead of twelve, is the least working storage of
+//  a step.
+
+static const int stage_slot[11] = { 0, 1, 2, 1, 3, 4, 2, 1, 5, 6, 3 };
+
+#define STAGE_SLOTS 7
+
 ////////////////////////////////////////////////////////////////////////////////
 //  double Runge_Kutta_Verner( double (*f)(double, double), double y0,        //
 //                               double x0, double h, int number_of_steps );  //
@@ -366,3 +390,368 @@ void Runge_Kutta_Verner_Richardson_Integral_Curve( double (*f)(double, double),
    }
    return;
 }
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Runge_Kutta_Verner_System( void (*f)(double, double[], double[]),    //
+//      double y[], int n, double x0, double h, int number_of_steps,          //
+//                                                          double work[] )   //
+//                                                                            //
+//  Description:                                                              //
+//     This routine uses the Runge-Kutta-Verner method described above to     //
+//     approximate the solution at x = x0 + h * number_of_steps of the initial//
+//     value problem y'=f(x,y), y(x0) = y[], where y is an n-vector.          //
+//                                                                            //
+//     Each stage input y + h * (a[i][1]*f1 + ... ) and the final update are  //
+//     formed by Vector_Linear_Combination() (see vector_kernels.c) which     //
+//     reads each stage vector once and, if compiled with OpenMP, divides the //
+//     work among threads.  For very large n the work array should be         //
+//     allocated by Vector_Alloc() so that its pages are placed on the NUMA   //
+//     nodes of the threads which use them.                                   //
+//                                                                            //
+//     The stage vectors share the slots of the working storage as described  //
+//     with stage_slot[] above, which both reduces the working storage to     //
+//     8 * n and keeps the vectors read by the later stages fewer and more    //
+//     likely to remain in the cache.                                         //
+//                                                                            //
+//  Arguments:                                                                //
+//     void (*f)(double x, double y[], double dy[])                           //
+//            Pointer to the function which evaluates the derivatives         //
+//            dy[] = f(x,y[]).                                                //
+//     double y[]                                                             //
+//            On input the initial value of y at x = x0, on output the value  //
+//            at x = x0 + number_of_steps * h.                                //
+//     int    n                                                               //
+//            The number of equations.                                        //
+//     double x0                                                              //
+//            The initial value of x.                                         //
+//     double h                                                               //
+//            The step size.                                                  //
+//     int    number_of_steps                                                 //
+//            The number of steps. Must be a nonnegative integer.             //
+//     double work[]                                                          //
+//            Working storage of dimension at least 8 * n.                    //
+//                                                                            //
+//  Return Values:                                                            //
+//     This routine is of type void and hence does not return a value.        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Vector_Linear_Combination( double z[], double y[], double a[],
+                                                 double *v[], int m, int n );
+
+static void Verner_Stage( void (*f)(double, double[], double[]), double x,
+                 double y[], double ytmp[], double k[], int n, double a[],
+                                                          double *v[], int m ) {
+
+   Vector_Linear_Combination( ytmp, y, a, v, m, n );
+   (*f)(x, ytmp, k);
+}
+
+void Runge_Kutta_Verner_System( void (*f)(double, double[], double[]),
+                 double y[], int n, double x0, double h, int number_of_steps,
+                                                             double work[] ) {
+
+   double *k[11];
+   double *ytmp = work + STAGE_SLOTS * n;
+   double *v[6];
+   double a[6];
+   double c1h = c1 * h, c2h = c2 * h, c3h = c3 * h;
+   int i;
+
+   for (i = 0; i < 11; i++) k[i] = work + stage_slot[i] * n;
+
+   while ( --number_of_steps >= 0 ) {
+      (*f)(x0, y, k[0]);
+
+      a[0] = h * a21; v[0] = k[0];
+      Verner_Stage(f, x0 + c1h, y, ytmp, k[1], n, a, v, 1);
+
+      a[0] = h * a31; a[1] = h * a32; v[1] = k[1];
+      Verner_Stage(f, x0 + c1h, y, ytmp, k[2], n, a, v, 2);
+
+      a[0] = h * a41; a[1] = h * a42; a[2] = h * a43; v[2] = k[2];
+      Verner_Stage(f, x0 + c2h, y, ytmp, k[3], n, a, v, 3);
+
+      a[0] = h * a51; a[1] = h * a53; a[2] = h * a54;
+      v[1] = k[2]; v[2] = k[3];
+      Verner_Stage(f, x0 + c2h, y, ytmp, k[4], n, a, v, 3);
+
+      a[0] = h * a61; a[1] = h * a63; a[2] = h * a64; a[3] = h * a65;
+      v[3] = k[4];
+      Verner_Stage(f, x0 + c1h, y, ytmp, k[5], n, a, v, 4);
+
+      a[0] = h * a71; a[1] = h * a73; a[2] = h * a74; a[3] = h * a75;
+      a[4] = h * a76; v[4] = k[5];
+      Verner_Stage(f, x0 + c3h, y, ytmp, k[6], n, a, v, 5);
+
+      a[0] = h * a81; a[1] = h * a85; a[2] = h * a86; a[3] = h * a87;
+      v[1] = k[4]; v[2] = k[5]; v[3] = k[6];
+      Verner_Stage(f, x0 + c3h, y, ytmp, k[7], n, a, v, 4);
+
+      a[0] = h * a91; a[1] = h * a95; a[2] = h * a96; a[3] = h * a97;
+      a[4] = h * a98; v[4] = k[7];
+      Verner_Stage(f, x0 + c1h, y, ytmp, k[8], n, a, v, 5);
+
+      a[0] = h * a10_1; a[1] = h * a10_5; a[2] = h * a10_6; a[3] = h * a10_7;
+      a[4] = h * a10_8; a[5] = h * a10_9; v[5] = k[8];
+      Verner_Stage(f, x0 + c2h, y, ytmp, k[9], n, a, v, 6);
+
+      x0 += h;
+      a[0] = h * a11_5; a[1] = h * a11_6; a[2] = h * a11_7; a[3] = h * a11_8;
+      a[4] = h * a11_9; a[5] = h * a11_10;
+      v[0] = k[4]; v[1] = k[5]; v[2] = k[6]; v[3] = k[7]; v[4] = k[8];
+      v[5] = k[9];
+      Verner_Stage(f, x0, y, ytmp, k[10], n, a, v, 6);
+
+      a[0] = h * b1; a[1] = h * b8; a[2] = h * b9; a[3] = h * b8; a[4] = h * b1;
+      v[0] = k[0]; v[1] = k[7]; v[2] = k[8]; v[3] = k[9]; v[4] = k[10];
+      Vector_Linear_Combination( y, y, a, v, 5, n );
+   }
+}
+
+
+struct Step_Controller;
+double Richardson_Adaptive_Integrate(
+        double (*method)(double (*)(double, double), double, double, double,
+        int), int order, int stages, const double richardson[],
+        int max_columns, double (*f)(double, double), double y0, double x0,
+        double x1, double *h, double tolerance,
+        struct Step_Controller *controller, int *columns, int *err );
+
+////////////////////////////////////////////////////////////////////////////////
+//  double Runge_Kutta_Verner_Richardson_Adaptive(                            //
+//           double (*f)(double, double), double y0, double x0, double x1,    //
+//                   double *h, double tolerance,                             //
+//           struct Step_Controller *controller, int *columns, int *err )     //
+//                                                                            //
+//  Description:                                                              //
+//     This routine uses Verner's method described above with Richardson      //
+//     extrapolation as in Runge_Kutta_Verner_Richardson() but integrates     //
+//     from x0 to x1 to a tolerance.  The difference of the last two entries  //
+//     of the last row of the Richardson tableau is used as an estimate of    //
+//     the local error to accept or reject each step and to choose the size   //
+//     of the next step together with the number of columns, see              //
+//     richardson_adaptive.c.                                                 //
+//                                                                            //
+//  Arguments:                                                                //
+//     double *f                                                              //
+//            Pointer to the function which returns the slope at (x,y) of the //
+//            integral curve of the differential equation y' = f(x,y) which   //
+//            passes through the point (x0,y0).                               //
+//     double y0                                                              //
+//            The initial value of y at x = x0.                               //
+//     double x0                                                              //
+//            The initial value of x.                                         //
+//     double x1                                                              //
+//            The final value of x, x1 > x0.                                  //
+//     double *h                                                              //
+//            On input the initial step size (if *h <= 0, x1 - x0 is used),   //
+//            on output the step size proposed for continuing beyond x1.      //
+//     double tolerance                                                       //
+//            The acceptable estimated local error of each step.              //
+//     struct Step_Controller *controller                                     //
+//            The step size controller created by Step_Controller_Create()    //
+//            (see step_size_controller.c), or NULL for the elementary step   //
+//            size rule of richardson_adaptive.c.                             //
+//     int    *columns                                                        //
+//            On input the initial number of columns, at least 2, on output   //
+//            the number proposed for continuing beyond x1.                   //
+//     int    *err                                                            //
+//            0 if successful, -1 if the step size became too small or too    //
+//            many steps in succession were rejected.                         //
+//                                                                            //
+//  Return Values:                                                            //
+//     The solution of the initial value problem y' = f(x,y), y(x0) = y0 at   //
+//     x = x1, or at the point reached if *err is -1.                         //
+//                                                                            //
+//  Example:                                                                  //
+//     double h = 0.1;                                                        //
+//     int columns = 3, err;                                                  //
+//                                                                            //
+//     y1 = Runge_Kutta_Verner_Richardson_Adaptive( f, y0, 0.0, 10.0, &h,     //
+//                                       1.e-10, NULL, &columns, &err );      //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double Runge_Kutta_Verner_Richardson_Adaptive( double (*f)(double, double),
+            double y0, double x0, double x1, double *h, double tolerance,
+               struct Step_Controller *controller, int *columns, int *err ) {
+
+   return Richardson_Adaptive_Integrate( Runge_Kutta_Verner, 8, 11, richardson,
+      MAX_COLUMNS, f, y0, x0, x1, h, tolerance, controller, columns, err );
+}
+
+
+// The stages k1,...,k11 of a single precision step of size h from x0 of the
+// lanes y[], stored in the slots of work[] given by stage_slot[]; the
+// intermediate values are formed in the slot STAGE_SLOTS.
+
+static void Verner_Stages_Float( void (*f)(float, float[], float[], int),
+                     double x0, double h, float y[], float work[], int m ) {
+
+   float *k1 = work + stage_slot[0] * m, *k2 = work + stage_slot[1] * m;
+   float *k3 = work + stage_slot[2] * m, *k4 = work + stage_slot[3] * m;
+   float *k5 = work + stage_slot[4] * m, *k6 = work + stage_slot[5] * m;
+   float *k7 = work + stage_slot[6] * m, *k8 = work + stage_slot[7] * m;
+   float *k9 = work + stage_slot[8] * m, *k10 = work + stage_slot[9] * m;
+   float *k11 = work + stage_slot[10] * m, *ytmp = work + STAGE_SLOTS * m;
+   const float hf = (float) h;
+   const float f21 = a21, f31 = a31, f32 = a32, f41 = a41, f42 = a42;
+   const float f43 = a43, f51 = a51, f53 = a53, f54 = a54, f61 = a61;
+   const float f63 = a63, f64 = a64, f65 = a65, f71 = a71, f73 = a73;
+   const float f74 = a74, f75 = a75, f76 = a76, f81 = a81, f85 = a85;
+   const float f86 = a86, f87 = a87, f91 = a91, f95 = a95, f96 = a96;
+   const float f97 = a97, f98 = a98, f10_1 = a10_1, f10_5 = a10_5;
+   const float f10_6 = a10_6, f10_7 = a10_7, f10_8 = a10_8, f10_9 = a10_9;
+   const float f11_5 = a11_5, f11_6 = a11_6, f11_7 = a11_7, f11_8 = a11_8;
+   const float f11_9 = a11_9, f11_10 = a11_10;
+   int j;
+
+   (*f)((float) x0, y, k1, m);
+   #pragma omp simd
+   for (j = 0; j < m; j++) ytmp[j] = y[j] + hf * f21 * k1[j];
+   (*f)((float) (x0 + c1 * h), ytmp, k2, m);
+   #pragma omp simd
+   for (j = 0; j < m; j++) ytmp[j] = y[j] + hf * (f31 * k1[j] + f32 * k2[j]);
+   (*f)((float) (x0 + c1 * h), ytmp, k3, m);
+   #pragma omp simd
+   for (j = 0; j < m; j++)
+      ytmp[j] = y[j] + hf * (f41 * k1[j] + f42 * k2[j] + f43 * k3[j]);
+   (*f)((float) (x0 + c2 * h), ytmp, k4, m);
+   #pragma omp simd
+   for (j = 0; j < m; j++)
+      ytmp[j] = y[j] + hf * (f51 * k1[j] + f53 * k3[j] + f54 * k4[j]);
+   (*f)((float) (x0 + c2 * h), ytmp, k5, m);
+   #pragma omp simd
+   for (j = 0; j < m; j++)
+      ytmp[j] = y[j] + hf * (f61 * k1[j] + f63 * k3[j] + f64 * k4[j]
+                                                             + f65 * k5[j]);
+   (*f)((float) (x0 + c1 * h), ytmp, k6, m);
+   #pragma omp simd
+   for (j = 0; j < m; j++)
+      ytmp[j] = y[j] + hf * (f71 * k1[j] + f73 * k3[j] + f74 * k4[j]
+                                              + f75 * k5[j] + f76 * k6[j]);
+   (*f)((float) (x0 + c3 * h), ytmp, k7, m);
+   #pragma omp simd
+   for (j = 0; j < m; j++)
+      ytmp[j] = y[j] + hf * (f81 * k1[j] + f85 * k5[j] + f86 * k6[j]
+                                                             + f87 * k7[j]);
+   (*f)((float) (x0 + c3 * h), ytmp, k8, m);
+   #pragma omp simd
+   for (j = 0; j < m; j++)
+      ytmp[j] = y[j] + hf * (f91 * k1[j] + f95 * k5[j] + f96 * k6[j]
+                                              + f97 * k7[j] + f98 * k8[j]);
+   (*f)((float) (x0 + c1 * h), ytmp, k9, m);
+   #pragma omp simd
+   for (j = 0; j < m; j++)
+      ytmp[j] = y[j] + hf * (f10_1 * k1[j] + f10_5 * k5[j] + f10_6 * k6[j]
+                          + f10_7 * k7[j] + f10_8 * k8[j] + f10_9 * k9[j]);
+   (*f)((float) (x0 + c2 * h), ytmp, k10, m);
+   #pragma omp simd
+   for (j = 0; j < m; j++)
+      ytmp[j] = y[j] + hf * (f11_5 * k5[j] + f11_6 * k6[j] + f11_7 * k7[j]
+                        + f11_8 * k8[j] + f11_9 * k9[j] + f11_10 * k10[j]);
+   (*f)((float) (x0 + h), ytmp, k11, m);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Runge_Kutta_Verner_Batch_Float(                                      //
+//                  void (*f)(float, float[], float[], int), float y[], int m,//
+//              double x0, double h, int number_of_steps, float work[] )      //
+//                                                                            //
+//  Description:                                                              //
+//     This routine uses Verner's method described above in single precision  //
+//     to advance the m lanes y[0],...,y[m-1] of a batch, e.g. an ensemble of //
+//     independent equations, by number_of_steps steps of size h.  Each stage //
+//     is a single loop over the lanes, sixteen lanes per instruction when    //
+//     compiled for AVX-512.  The accuracy is limited to about 1.e-6 relative //
+//     by the precision rather than by the order of the method, so that the   //
+//     step size may be taken large.                                          //
+//                                                                            //
+//  Arguments:                                                                //
+//     void (*f)(float, float[], float[], int)                                //
+//            The right hand side, f(x, y, dy, m) sets dy[j] for the lanes    //
+//            j = 0,...,m-1 of y at x.                                        //
+//     float  y[]                                                             //
+//            On input the initial values at x = x0, on output the values at  //
+//            x = x0 + number_of_steps * h.                                   //
+//     int    m                                                               //
+//            The number of lanes.                                            //
+//     double x0                                                              //
+//            The initial value of x.                                         //
+//     double h                                                               //
+//            The step size.                                                  //
+//     int    number_of_steps                                                 //
+//            The number of steps. Must be a nonnegative integer.             //
+//     float  work[]                                                          //
+//            Working storage of dimension at least 8 * m.                    //
+//                                                                            //
+//  Return Values:                                                            //
+//     This routine is of type void and hence does not return a value.        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Runge_Kutta_Verner_Batch_Float( void (*f)(float, float[], float[], int),
+                    float y[], int m, double x0, double h, int number_of_steps,
+                                                               float work[] ) {
+
+   float *k1 = work + stage_slot[0] * m, *k8 = work + stage_slot[7] * m;
+   float *k9 = work + stage_slot[8] * m, *k10 = work + stage_slot[9] * m;
+   float *k11 = work + stage_slot[10] * m;
+   const float hb1 = (float) (h * b1), hb8 = (float) (h * b8);
+   const float hb9 = (float) (h * b9);
+   int i, j;
+
+   for (i = 0; i < number_of_steps; i++) {
+      Verner_Stages_Float( f, x0 + i * h, h, y, work, m );
+      #pragma omp simd
+      for (j = 0; j < m; j++)
+         y[j] += hb1 * (k1[j] + k11[j]) + hb8 * (k8[j] + k10[j]) + hb9 * k9[j];
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Runge_Kutta_Verner_Batch_Mixed(                                      //
+//                 void (*f)(float, float[], float[], int), double y[], int m,//
+//              double x0, double h, int number_of_steps, float work[] )      //
+//                                                                            //
+//  Description:                                                              //
+//     As Runge_Kutta_Verner_Batch_Float() but the lanes y[] are kept in      //
+//     double precision.  The stages and the increment of each step are       //
+//     computed in single precision and only the accumulation of the          //
+//     increments into y[] is done in double precision, so that the rounding  //
+//     errors of the accumulation do not grow with the number of steps.       //
+//                                                                            //
+//  Arguments:                                                                //
+//     As for Runge_Kutta_Verner_Batch_Float() except that y[] is of type     //
+//     double and work[] must be of dimension at least 9 * m.                 //
+//                                                                            //
+//  Return Values:                                                            //
+//     This routine is of type void and hence does not return a value.        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Runge_Kutta_Verner_Batch_Mixed( void (*f)(float, float[], float[], int),
+                   double y[], int m, double x0, double h, int number_of_steps,
+                                                               float work[] ) {
+
+   float *k1 = work + stage_slot[0] * m, *k8 = work + stage_slot[7] * m;
+   float *k9 = work + stage_slot[8] * m, *k10 = work + stage_slot[9] * m;
+   float *k11 = work + stage_slot[10] * m;
+   float *ysingle = work + (STAGE_SLOTS + 1) * m;
+   const float hb1 = (float) (h * b1), hb8 = (float) (h * b8);
+   const float hb9 = (float) (h * b9);
+   int i, j;
+
+   for (i = 0; i < number_of_steps; i++) {
+      #pragma omp simd
+      for (j = 0; j < m; j++) ysingle[j] = (float) y[j];
+      Verner_Stages_Float( f, x0 + i * h, h, ysingle, work, m );
+      #pragma omp simd
+      for (j = 0; j < m; j++)
+         y[j] += (double) ( hb1 * (k1[j] + k11[j]) + hb8 * (k8[j] + k10[j])
+                                                            + hb9 * k9[j] );
+   }
+}
@@ -2,6 +2,9 @@
 // File: simpson_simpson.c                                                    //
 // Routines:                                                                  //
 //    Simpson_Simpson_Adapative                                               //
+//    Simpson_Simpson_Adaptive_Fixed                                          //
+//    Simpson_Simpson_Adaptive_Batch                                          //
+//    Simpson_Simpson_Adaptive_Vector                                         //
 ////////////////////////////////////////////////////////////////////////////////
 #include <stdlib.h>                            // required for malloc()
 #include <math.h>                              // required for fabs()
@@ -20,6 +23,24 @@ static double (*fnc)(double);
 
 static void Simpsons_Rule_Update();
 
+struct Batch_Interval {
+   double lower_limit;
+   double upper_limit;
+   double function[3];             // f at the lower limit, midpoint, upper
+};
+
+struct Vector_Interval {
+   double upper_limit;
+   double lower_limit;
+   double *function;               // the m values at each of the 5 points
+   struct Vector_Interval *interval;
+};
+
+static struct Vector_Interval *New_Vector_Interval( int m,
+                                         struct Vector_Interval **free_list );
+static double Vector_Simpsons_Rule_Update( struct Vector_Interval *p,
+                        void (*f)(double, double[]), int m, double s2[] );
+
 ////////////////////////////////////////////////////////////////////////////////
 //  double Simpson_Simpson_Adaptive( double a, double b, double tolerance,    //
 //                             double (*f)(double), double min_h, int *err ); //
@@ -132,9 +153,10 @@ double Simpson_Simpson_Adaptive(double a, double b, double tolerance,
                                                     - pinterval->lower_limit);
    }
 
-            // The process failed, free all allocated memory.  //
+            // The process failed, free all allocated memory, i.e.    //
+            // every subinterval except the static initial interval.  //
 
-   while (pinterval != NULL) {
+   while (pinterval != NULL && pinterval != &interval) {
       qinterval = pinterval->interval;
       free(pinterval); 
       pinterval = qinterval;
@@ -162,3 +184,506 @@ static void Simpsons_Rule_Update( ) {
          + pinterval->function[4];
    s2 *= 0.0833333333333333333333333 * h;
 }
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  double Simpson_Simpson_Adaptive_Fixed( double a, double b,                //
+//               double tolerance, double (*f)(double), double stack[],       //
+//                          int max_depth, int max_evaluations, int *err );   //
+//                                                                            //
+//  Description:                                                              //
+//                                                                            //
+//    A version of Simpson_Simpson_Adaptive for real-time use, with bounded   //
+//    work and no memory allocation.  The subintervals waiting to be          //
+//    integrated are kept in the array stack[] supplied by the caller, a      //
+//    subinterval is not halved more than max_depth times and f(x) is         //
+//    evaluated at most max_evaluations times.  If a subinterval of length    //
+//    (b-a) / 2^max_depth does not meet its pro-rated tolerance its composite //
+//    Simpson's rule is accepted nevertheless.  If the evaluations are        //
+//    exhausted, the current subinterval and each waiting subinterval is      //
+//    integrated by Simpson's rule through the three values of f(x) already   //
+//    known on it.  In both cases *err is set to -1 and the resulting         //
+//    estimate of the integral is returned.  Unlike Simpson_Simpson_Adaptive  //
+//    this routine keeps no static state and may be called concurrently.      //
+//                                                                            //
+//  Arguments:                                                                //
+//     double a          The lower limit of the integration interval.         //
+//     double b          The upper limit of integration.                      //
+//     double tolerance  The acceptable error estimate of the integral.       //
+//     double *f         Pointer to the integrand, a function of a single     //
+//                       variable of type double.                             //
+//     double stack[]    Working storage of dimension at least                //
+//                       4 * max_depth.                                       //
+//     int    max_depth  The maximum number of times the interval [a,b] is    //
+//                       halved, 0 <= max_depth.                              //
+//     int    max_evaluations  The maximum number of evaluations of f(x),     //
+//                       at least 5.                                          //
+//     int    *err       0 if the process terminates successfully; -1 if a    //
+//                       limit was reached, -3 if max_depth < 0 or            //
+//                       max_evaluations < 5.                                 //
+//                                                                            //
+//  Return Values:                                                            //
+//     The integral of f(x) from a to b.                                      //
+//                                                                            //
+//  Example:                                                                  //
+//     double stack[4 * 20];                                                  //
+//     int err;                                                               //
+//                                                                            //
+//     integral = Simpson_Simpson_Adaptive_Fixed( 0.0, 1.0, 1.e-10, f,        //
+//                                                   stack, 20, 201, &err );  //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double Simpson_Simpson_Adaptive_Fixed(double a, double b, double tolerance,
+                         double (*f)(double), double stack[], int max_depth,
+                                           int max_evaluations, int *err) {
+
+   double integral = 0.0;
+   double epsilon_density = 2.0 * tolerance / ( b - a );
+   double lower = a;
+   double upper = b;
+   double function[5];
+   double h_min = 1.5 * ( b - a );
+   double h, simpson, composite, *top;
+   int waiting = 0;
+   int evaluations = 5;
+   int i;
+
+   *err = -3;
+   if (max_depth < 0 || max_evaluations < 5) return 0.0;
+   *err = 0;
+   for (i = 0; i < max_depth; i++) h_min *= 0.5;
+
+      // The current subinterval [lower, upper] keeps f(x) at its five  //
+      // equally spaced points, each waiting subinterval on the stack   //
+      // its upper limit and f(x) at its three equally spaced points.   //
+
+   h = upper - lower;
+   function[0] = (*f)(lower);
+   function[1] = (*f)(lower + 0.25 * h);
+   function[2] = (*f)(0.5 * (lower + upper));
+   function[3] = (*f)(upper - 0.25 * h);
+   function[4] = (*f)(upper);
+
+   while (1) {
+      h = upper - lower;
+      simpson = ( function[0] + 4.0 * function[2] + function[4] )
+                                           * 0.166666666666666666666667 * h;
+      composite = ( function[0] + 4.0 * function[1] + 2.0 * function[2]
+                          + 4.0 * function[3] + function[4] )
+                                           * 0.0833333333333333333333333 * h;
+      if ( fabs( simpson - composite ) < epsilon_density * h
+                                                          || h < h_min ) {
+         if ( fabs( simpson - composite ) >= epsilon_density * h ) *err = -1;
+
+            // Accept the subinterval and continue with the waiting  //
+            // subinterval on top of the stack, if any.              //
+
+         integral += composite;
+         if (waiting == 0) return integral;
+         waiting--;
+         top = stack + 4 * waiting;
+         lower = upper;
+         upper = top[0];
+         function[0] = top[1];
+         function[2] = top[2];
+         function[4] = top[3];
+      }
+      else {
+
+            // Push the right half and continue with the left half.  //
+
+         top = stack + 4 * waiting;
+         top[0] = upper;
+         top[1] = function[2];
+         top[2] = function[3];
+         top[3] = function[4];
+         waiting++;
+         upper = 0.5 * (lower + upper);
+         function[4] = function[2];
+         function[2] = function[1];
+      }
+      if ( evaluations + 2 > max_evaluations ) break;
+      h = upper - lower;
+      function[1] = (*f)(lower + 0.25 * h);
+      function[3] = (*f)(upper - 0.25 * h);
+      evaluations += 2;
+   }
+
+            // The evaluations are exhausted, use the values of f(x) //
+            // which are known.                                      //
+
+   *err = -1;
+   integral += ( function[0] + 4.0 * function[2] + function[4] )
+                         * 0.166666666666666666666667 * (upper - lower);
+   while (waiting > 0) {
+      waiting--;
+      top = stack + 4 * waiting;
+      integral += ( top[1] + 4.0 * top[2] + top[3] )
+                         * 0.166666666666666666666667 * (top[0] - upper);
+      upper = top[0];
+   }
+   return integral;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  double Simpson_Simpson_Adaptive_Batch( double a, double b,                //
+//                double tolerance, void (*f)(double[], double[], int),       //
+//                                                double min_h, int *err );   //
+//                                                                            //
+//  Description:                                                              //
+//                                                                            //
+//    A level synchronous (breadth-first) version of Simpson_Simpson_Adaptive //
+//    above for integrands which are evaluated more efficiently many points   //
+//    at a time, e.g. by SIMD instructions, by several threads or remotely.   //
+//                                                                            //
+//    All subintervals of the current level which have not yet converged are  //
+//    collected, the two new abscissas of each (at one quarter and three      //
+//    quarters of the subinterval) are evaluated by a single call of the      //
+//    integrand, and then Simpson's rule and the composite Simpson's rule are //
+//    compared on every subinterval.  A subinterval for which the difference  //
+//    is less than twice the tolerance * (length of the subinterval)/(b-a)    //
+//    is accepted, otherwise it is bisected and both halves, which inherit    //
+//    the five function values already computed, form the next level.  The    //
+//    same subintervals are accepted as by Simpson_Simpson_Adaptive, only the //
+//    order of evaluation differs.                                            //
+//                                                                            //
+//  Arguments:                                                                //
+//     double a          The lower limit of the integration interval.         //
+//     double b          The upper limit of integration.                      //
+//     double tolerance  The acceptable error estimate of the integral.       //
+//     void   *f         Pointer to the integrand, f(x, fx, n) must set       //
+//                       fx[i] = f(x[i]) for i = 0,...,n-1.                   //
+//     double min_h      The minimum subinterval length.  If a subinterval of //
+//                       length <= min_h has not converged, the process       //
+//                       terminates after setting *err to -1.                 //
+//     int    *err       0 if the process terminates successfully; -1 if no   //
+//                       subinterval of length > min_h was found for which    //
+//                       the estimated error was less that the pro-rated      //
+//                       error, -2 if memory could not be allocated to        //
+//                       proceed with a new level.                            //
+//                                                                            //
+//  Return Values:                                                            //
+//     The integral of f(x) from a to b, or 0.0 if *err is not 0.             //
+//                                                                            //
+//  Example:                                                                  //
+//     void f(double x[], double fx[], int n) {                               //
+//        int i;                                                              //
+//        for (i = 0; i < n; i++) fx[i] = exp(-x[i] * x[i]);                  //
+//     }                                                                      //
+//     ...                                                                    //
+//     integral = Simpson_Simpson_Adaptive_Batch(0.0, 1.0, 1.e-10, f,         //
+//                                                           1.e-6, &err);    //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double Simpson_Simpson_Adaptive_Batch(double a, double b, double tolerance, 
+            void (*f)(double[], double[], int), double min_h, int *err) {
+
+   double integral = 0.0;
+   double epsilon_density = 2.0 * tolerance / ( b - a );
+   double h, h4, s1, s2;
+   double *x;
+   double *fx;
+   double *p;
+   double x0[3];
+   double f0[3];
+   struct Batch_Interval *level;
+   struct Batch_Interval *next;
+   struct Batch_Interval *q;
+   struct Batch_Interval *tmp;
+   int capacity = 16;
+   int count = 1;
+   int next_count;
+   int i;
+
+   *err = -2;
+   level = (struct Batch_Interval*) malloc( 2 * capacity
+                                           * sizeof(struct Batch_Interval) );
+   p = (double*) malloc( 4 * capacity * sizeof(double) );
+   if ( level == NULL || p == NULL ) { free(level); free(p); return 0.0; }
+   next = level + capacity;
+   x = p;
+   fx = p + 2 * capacity;
+
+      // Create the initial level, with lower_limit = a, upper_limit = b,  //   
+      // and f(x) evaluated at a, (a + b) / 2, and b.                      //
+
+   x0[0] = a;
+   x0[1] = 0.5 * ( a + b );
+   x0[2] = b;
+   (*f)(x0, f0, 3);
+   level[0].lower_limit = a;
+   level[0].upper_limit = b;
+   for (i = 0; i < 3; i++) level[0].function[i] = f0[i];
+
+   *err = 0;
+   while ( count > 0 ) {
+
+            // Evaluate the quarter points of every subinterval of the  //
+            // level in one call.                                       //
+
+      for (i = 0; i < count; i++) {
+         h4 = 0.25 * ( level[i].upper_limit - level[i].lower_limit );
+         x[2*i] = level[i].lower_limit + h4;
+         x[2*i+1] = level[i].upper_limit - h4;
+      }
+      (*f)(x, fx, 2 * count);
+
+            // Accept the subintervals which have converged and bisect  //
+            // the others.                                              //
+
+      next_count = 0;
+      for (i = 0; i < count; i++) {
+         q = &level[i];
+         h = q->upper_limit - q->lower_limit;
+         if ( h <= min_h ) { *err = -1; break; }
+         s1 = q->function[0] + 4.0 * q->function[1] + q->function[2];
+         s1 *= 0.166666666666666666666667 * h;
+         s2 = q->function[0] + 4.0 * fx[2*i] + 2.0 * q->function[1]
+              + 4.0 * fx[2*i+1] + q->function[2];
+         s2 *= 0.0833333333333333333333333 * h;
+         if ( fabs( s1 - s2 ) < epsilon_density * h ) {
+            integral += s2;
+            continue;
+         }
+         next[next_count].lower_limit = q->lower_limit;
+         next[next_count].upper_limit = 0.5 * ( q->lower_limit 
+                                                        + q->upper_limit );
+         next[next_count].function[0] = q->function[0];
+         next[next_count].function[1] = fx[2*i];
+         next[next_count].function[2] = q->function[1];
+         next_count++;
+         next[next_count].lower_limit = next[next_count-1].upper_limit;
+         next[next_count].upper_limit = q->upper_limit;
+         next[next_count].function[0] = q->function[1];
+         next[next_count].function[1] = fx[2*i+1];
+         next[next_count].function[2] = q->function[2];
+         next_count++;
+      }
+      if ( *err != 0 ) break;
+
+            // Swap the levels, enlarging the storage if the next level  //
+            // could outgrow it.                                         //
+
+      tmp = level; level = next; next = tmp;
+      count = next_count;
+      if ( 2 * count > capacity ) {
+         capacity = 2 * count;
+         tmp = (level < next) ? level : next;
+         q = (struct Batch_Interval*) malloc( 2 * capacity
+                                           * sizeof(struct Batch_Interval) );
+         free(p);
+         p = (double*) malloc( 4 * capacity * sizeof(double) );
+         if ( q == NULL || p == NULL ) {
+            free(tmp); free(q); free(p);
+            *err = -2;
+            return 0.0;
+         }
+         for (i = 0; i < count; i++) q[i] = level[i];
+         free(tmp);
+         level = q;
+         next = q + capacity;
+         x = p;
+         fx = p + 2 * capacity;
+      }
+   }
+
+   free( (level < next) ? level : next );
+   free(p);
+   if ( *err != 0 ) return 0.0;
+   return integral;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Simpson_Simpson_Adaptive_Vector( double a, double b,                 //
+//                double tolerance, void (*f)(double, double[]), int m,       //
+//                           double min_h, double integral[], int *err );     //
+//                                                                            //
+//  Description:                                                              //
+//                                                                            //
+//    A version of Simpson_Simpson_Adaptive above for a vector valued         //
+//    integrand f(x) = (f[0](x),...,f[m-1](x)), e.g. the moments of one       //
+//    distribution, whose components share the expensive part of their        //
+//    evaluation.  All m components are integrated over the same subintervals //
+//    and a single call of the integrand returns all m values at an abscissa. //
+//    Each subinterval holds a block of 5 * m values in place of the five     //
+//    values of struct Subinterval.  A subinterval is accepted when the       //
+//    maximum over the components of the difference between Simpson's rule    //
+//    and the composite Simpson's rule is less than twice the tolerance *     //
+//    (length of the subinterval)/(b-a), so that the component which is the   //
+//    hardest to integrate determines the refinement.                         //
+//                                                                            //
+//    Unlike Simpson_Simpson_Adaptive this routine keeps no static state.     //
+//                                                                            //
+//  Arguments:                                                                //
+//     double a          The lower limit of the integration interval.         //
+//     double b          The upper limit of integration.                      //
+//     double tolerance  The acceptable error estimate of each component of   //
+//                       the integral.                                        //
+//     void   *f         Pointer to the integrand, f(x, fx) must set fx[j] to //
+//                       the j-th component at x for j = 0,...,m-1.           //
+//     int    m          The number of components of the integrand, m >= 1.   //
+//     double min_h      The minimum subinterval length.  If no subinterval   //
+//                       of length > min_h is found for which the estimated   //
+//                       error falls below the pro-rated tolerance, the       //
+//                       process terminates after setting *err to -1.         //
+//     double integral[] The integrals of the m components from a to b.  If   //
+//                       *err is not 0, integral[] is set to 0.               //
+//     int    *err       0 if the process terminates successfully; -1 if no   //
+//                       subinterval of length > min_h was found for which    //
+//                       the estimated error was less that the pro-rated      //
+//                       error, -2 if memory could not be allocated to        //
+//                       proceed with a new subinterval.                      //
+//                                                                            //
+//  Return Values:                                                            //
+//     none                                                                   //
+//                                                                            //
+//  Example:                                                                  //
+//     void moments(double x, double fx[]) {                                  //
+//        double w = expensive_density(x);                                    //
+//        int j;                                                              //
+//        for (j = 0; j < 200; j++) { fx[j] = w; w *= x; }                    //
+//     }                                                                      //
+//     ...                                                                    //
+//     double integral[200];                                                  //
+//     Simpson_Simpson_Adaptive_Vector(0.0, 1.0, 1.e-10, moments, 200,        //
+//                                                   1.e-6, integral, &err);  //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Simpson_Simpson_Adaptive_Vector(double a, double b, double tolerance, 
+                         void (*f)(double, double[]), int m, double min_h,
+                                                double integral[], int *err) {
+
+   double epsilon_density = 2.0 * tolerance / ( b - a );
+   double *s2;
+   double difference;
+   struct Vector_Interval *pinterval;
+   struct Vector_Interval *qinterval;
+   struct Vector_Interval *free_list = NULL;
+   int done = 0;
+   int j;
+
+   for (j = 0; j < m; j++) integral[j] = 0.0;
+   *err = -2;
+   s2 = (double*) malloc( m * sizeof(double) );
+   if (s2 == NULL) return;
+   pinterval = New_Vector_Interval( m, &free_list );
+   if (pinterval == NULL) { free(s2); return; }
+
+      // Create the initial level, with lower_limit = a, upper_limit = b,  //   
+      // and f(x) evaluated at a, b, and (a + b) / 2.                      //
+
+   pinterval->interval = NULL;
+   pinterval->upper_limit = b;
+   pinterval->lower_limit = a;
+   (*f)(a, pinterval->function);
+   (*f)(0.5 * (a + b), pinterval->function + 2 * m);
+   (*f)(b, pinterval->function + 4 * m);
+
+   *err = 0;
+   difference = Vector_Simpsons_Rule_Update( pinterval, f, m, s2 );
+
+   while ( pinterval->upper_limit - pinterval->lower_limit > min_h ) {
+      if ( difference < epsilon_density * (pinterval->upper_limit
+                                                 - pinterval->lower_limit) ) {
+
+            // The estimates are close, add the composite rule to the  //
+            // integral and continue with the right half of the parent //
+            // whose left half is now complete.                        //
+
+         for (j = 0; j < m; j++) integral[j] += s2[j];
+         qinterval = pinterval->interval;
+         pinterval->interval = free_list;
+         free_list = pinterval;
+         if (qinterval == NULL) { done = 1; break; }
+         qinterval->lower_limit = free_list->upper_limit;
+         for (j = 0; j < m; j++) {
+            qinterval->function[j] = qinterval->function[2*m+j];
+            qinterval->function[2*m+j] = qinterval->function[3*m+j];
+         }
+         pinterval = qinterval;
+      }
+      else {
+            // The estimates are not close, continue with the left     //
+            // half of the current interval.                           //
+
+         qinterval = New_Vector_Interval( m, &free_list );
+         if ( qinterval == NULL ) { *err = -2; break; }
+         qinterval->interval = pinterval;
+         qinterval->lower_limit = pinterval->lower_limit;
+         qinterval->upper_limit = 0.5 * (pinterval->upper_limit
+                                           + pinterval->lower_limit);
+         for (j = 0; j < m; j++) {
+            qinterval->function[j] = pinterval->function[j];
+            qinterval->function[2*m+j] = pinterval->function[m+j];
+            qinterval->function[4*m+j] = pinterval->function[2*m+j];
+         }
+         pinterval = qinterval;
+      }
+      difference = Vector_Simpsons_Rule_Update( pinterval, f, m, s2 );
+   }
+
+            // Free the subintervals, those still on the stack if the  //
+            // process failed and those kept for reuse.                //
+
+   if ( !done ) {
+      if (*err == 0) *err = -1;
+      for (j = 0; j < m; j++) integral[j] = 0.0;
+      while (pinterval != NULL) {
+         qinterval = pinterval->interval;
+         free(pinterval); 
+         pinterval = qinterval;
+      }
+   }
+   while (free_list != NULL) {
+      qinterval = free_list->interval;
+      free(free_list);
+      free_list = qinterval;
+   }
+   free(s2);
+}
+
+
+static struct Vector_Interval *New_Vector_Interval( int m,
+                                        struct Vector_Interval **free_list ) {
+
+   struct Vector_Interval *p = *free_list;
+
+   if (p != NULL) { *free_list = p->interval; return p; }
+   p = (struct Vector_Interval*) malloc( sizeof(struct Vector_Interval)
+                                                   + 5 * m * sizeof(double) );
+   if (p == NULL) return NULL;
+   p->function = (double*) (p + 1);
+   return p;
+}
+
+
+static double Vector_Simpsons_Rule_Update( struct Vector_Interval *p,
+                         void (*f)(double, double[]), int m, double s2[] ) {
+
+   double h = p->upper_limit - p->lower_limit;
+   double h4 = 0.25 * h;
+   double *f0 = p->function;
+   double *f1 = f0 + m;
+   double *f2 = f1 + m;
+   double *f3 = f2 + m;
+   double *f4 = f3 + m;
+   double s1;
+   double d;
+   double difference = 0.0;
+   int j;
+
+   (*f)(p->lower_limit + h4, f1);
+   (*f)(p->upper_limit - h4, f3);
+
+   for (j = 0; j < m; j++) {
+      s1 = f0[j] + 4.0 * f2[j] + f4[j];
+      s1 *= 0.166666666666666666666667 * h;
+      s2[j] = f0[j] + 4.0 * f1[j] + 2.0 * f2[j] + 4.0 * f3[j] + f4[j];
+      s2[j] *= 0.0833333333333333333333333 * h;
+      d = fabs( s1 - s2[j] );
+      if ( d > difference || d != d ) difference = d;
+   }
+   return difference;
+}
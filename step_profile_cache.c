@@ -0,0 +1,291 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: step_profile_cache.c                                                 //
+// Routines:                                                                  //
+//    Step_Profile_Begin                                                      //
+//    Step_Profile_Record                                                     //
+//    Step_Profile_End                                                        //
+//    Step_Profile_Predict                                                    //
+//    Step_Profile_Free                                                       //
+//    Step_Profile_Free_All                                                   //
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Description:                                                              //
+//     In a parameter sweep successive calls of an adaptive integrator solve  //
+//     nearly identical problems.  Rather than starting each run from a user  //
+//     guessed step size and relearning the step size profile through failed  //
+//     steps, the accepted steps (x, h, columns) of one run of a trajectory   //
+//     family are recorded and proposed as the step sizes of the next run of  //
+//     the same family.                                                       //
+//                                                                            //
+//     A family is identified by a non-negative integer key chosen by the     //
+//     caller.  A run is bracketed by Step_Profile_Begin() and                //
+//     Step_Profile_End(); the steps recorded in between replace the profile  //
+//     of the family at Step_Profile_End().  During the run the previous      //
+//     profile remains available to Step_Profile_Predict().                   //
+//                                                                            //
+//     The cache is kept in static storage and is not thread safe; each       //
+//     thread running a sweep should use its own family keys and must not     //
+//     call these routines concurrently.                                      //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>                    // required for malloc(), realloc()
+
+struct Step_Record {
+   double x;
+   double h;
+   int columns;
+};
+
+struct Step_Profile {
+   int family;
+   int size;                         // the number of steps in the profile
+   int capacity;
+   int recording_size;               // the number of steps being recorded
+   int recording_capacity;
+   struct Step_Record *profile;
+   struct Step_Record *recording;
+   struct Step_Profile *next;
+};
+
+static struct Step_Profile *profiles = NULL;
+
+static struct Step_Profile *Find_Profile( int family );
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Step_Profile_Begin( int family )                                      //
+//                                                                            //
+//  Description:                                                              //
+//     Starts recording a new run of the trajectory family 'family'.  Any     //
+//     unfinished recording of the family is discarded.                       //
+//                                                                            //
+//  Arguments:                                                                //
+//     int family  The key of the trajectory family, family >= 0.             //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -1 if family < 0 and -2 if memory could not be        //
+//     allocated.                                                             //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Step_Profile_Begin( int family ) {
+
+   struct Step_Profile *p;
+
+   if (family < 0) return -1;
+   p = Find_Profile( family );
+   if (p == NULL) {
+      p = (struct Step_Profile*) malloc( sizeof(struct Step_Profile) );
+      if (p == NULL) return -2;
+      p->family = family;
+      p->size = 0;
+      p->capacity = 0;
+      p->recording_capacity = 0;
+      p->profile = NULL;
+      p->recording = NULL;
+      p->next = profiles;
+      profiles = p;
+   }
+   p->recording_size = 0;
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Step_Profile_Record( int family, double x, double h, int columns )    //
+//                                                                            //
+//  Description:                                                              //
+//     Appends the accepted step from x to x + h, which required 'columns'    //
+//     extrapolation columns, to the current recording of the family.         //
+//                                                                            //
+//  Arguments:                                                                //
+//     int    family   The key of the trajectory family.                      //
+//     double x        The start of the accepted step.                        //
+//     double h        The size of the accepted step.                         //
+//     int    columns  The number of extrapolation columns (or the order)     //
+//                     used by the accepted step.                             //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -1 if no recording of the family was begun and -2 if  //
+//     memory could not be allocated.                                         //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Step_Profile_Record( int family, double x, double h, int columns ) {
+
+   struct Step_Profile *p = Find_Profile( family );
+   struct Step_Record *r;
+   int capacity;
+
+   if (p == NULL) return -1;
+   if (p->recording_size == p->recording_capacity) {
+      capacity = (p->recording_capacity == 0) ? 64 : 2 * p->recording_capacity;
+      r = (struct Step_Record*) realloc( p->recording,
+                                       capacity * sizeof(struct Step_Record) );
+      if (r == NULL) return -2;
+      p->recording = r;
+      p->recording_capacity = capacity;
+   }
+   r = &p->recording[p->recording_size++];
+   r->x = x;
+   r->h = h;
+   r->columns = columns;
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Step_Profile_End( int family )                                        //
+//                                                                            //
+//  Description:                                                              //
+//     Ends the recording of the current run of the family.  The recorded     //
+//     steps become the profile proposed to the next run.  An empty           //
+//     recording leaves the previous profile in place.                        //
+//                                                                            //
+//  Arguments:                                                                //
+//     int family  The key of the trajectory family.                          //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -1 if no recording of the family was begun.           //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Step_Profile_End( int family ) {
+
+   struct Step_Profile *p = Find_Profile( family );
+   struct Step_Record *r;
+   int capacity;
+
+   if (p == NULL) return -1;
+   if (p->recording_size == 0) return 0;
+
+          // Swap the recording and the profile so that the storage of the //
+          // old profile is reused by the next recording.                  //
+
+   r = p->profile;
+   capacity = p->capacity;
+   p->profile = p->recording;
+   p->capacity = p->recording_capacity;
+   p->size = p->recording_size;
+   p->recording = r;
+   p->recording_capacity = capacity;
+   p->recording_size = 0;
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Step_Profile_Predict( int family, double x, double *h, int *columns ) //
+//                                                                            //
+//  Description:                                                              //
+//     Proposes the step at x from the profile of the family, that is the     //
+//     size and the number of columns of the recorded step which started at   //
+//     or last before x.  If the family has no profile or x lies before the   //
+//     first recorded step or beyond the last, no prediction is made and *h   //
+//     is unchanged.                                                          //
+//                                                                            //
+//  Arguments:                                                                //
+//     int    family     The key of the trajectory family.                    //
+//     double x          The start of the next step.                          //
+//     double *h         Set to the proposed step size if a prediction is     //
+//                       made.                                                //
+//     int    *columns   If not NULL, set to the number of columns recorded   //
+//                       for the proposed step, or 0 if no prediction is      //
+//                       made.                                                //
+//                                                                            //
+//  Return Values:                                                            //
+//     1 if a prediction is made, 0 if not.                                   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Step_Profile_Predict( int family, double x, double *h, int *columns ) {
+
+   struct Step_Profile *p = Find_Profile( family );
+   struct Step_Record *r;
+   int lo, hi, mid;
+
+   if (columns != NULL) *columns = 0;
+   if (p == NULL || p->size == 0) return 0;
+   r = p->profile;
+   if ( x < r[0].x || x >= r[p->size-1].x + r[p->size-1].h ) return 0;
+
+                 // Binary search for the last step with r[lo].x <= x. //
+
+   lo = 0;
+   hi = p->size - 1;
+   while (lo < hi) {
+      mid = (lo + hi + 1) / 2;
+      if (r[mid].x <= x) lo = mid;
+      else hi = mid - 1;
+   }
+   if (columns != NULL) *columns = r[lo].columns;
+   *h = r[lo].h;
+   return 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Step_Profile_Free( int family )                                      //
+//                                                                            //
+//  Description:                                                              //
+//     Removes the family from the cache and frees its storage.               //
+//                                                                            //
+//  Arguments:                                                                //
+//     int family  The key of the trajectory family.                          //
+//                                                                            //
+//  Return Values:                                                            //
+//     none                                                                   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Step_Profile_Free( int family ) {
+
+   struct Step_Profile **pp = &profiles;
+   struct Step_Profile *p;
+
+   for (; *pp != NULL; pp = &(*pp)->next)
+      if ( (*pp)->family == family ) {
+         p = *pp;
+         *pp = p->next;
+         free(p->profile);
+         free(p->recording);
+         free(p);
+         return;
+      }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Step_Profile_Free_All( void )                                        //
+//                                                                            //
+//  Description:                                                              //
+//     Removes all families from the cache and frees their storage.           //
+//                                                                            //
+//  Return Values:                                                            //
+//     none                                                                   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Step_Profile_Free_All( void ) {
+
+   struct Step_Profile *p;
+
+   while (profiles != NULL) {
+      p = profiles;
+      profiles = p->next;
+      free(p->profile);
+      free(p->recording);
+      free(p);
+   }
+}
+
+
+static struct Step_Profile *Find_Profile( int family ) {
+
+   struct Step_Profile *p;
+
+   for (p = profiles; p != NULL; p = p->next)
+      if (p->family == family) return p;
+   return NULL;
+}
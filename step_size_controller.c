@@ -0,0 +1,307 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: step_size_controller.c                                               //
+// Routines:                                                                  //
+//    Step_Controller_Create                                                  //
+//    Step_Controller_Set_Limits                                              //
+//    Step_Controller_Set_Filter                                              //
+//    Step_Controller_Set_Order                                               //
+//    Step_Controller_Next                                                    //
+//    Step_Controller_Reset                                                   //
+//    Step_Controller_Free                                                    //
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Description:                                                              //
+//     An adaptive method estimates the error of each step of size h[n] and   //
+//     compares its norm e[n], scaled so that the tolerance is 1, with 1.     //
+//     The step is accepted if e[n] <= 1 and a controller then proposes the   //
+//     size of the next step, or of the retry if the step is rejected.  With  //
+//     k the order of the error estimate, i.e. e ~ C h^k, the controllers are //
+//     instances of the digital filter of Soderlind ("Digital filters in      //
+//     adaptive time-stepping", ACM TOMS 29 (2003)):                          //
+//                                                                            //
+//       h[n+1] / h[n] = safety * e[n]^(-b1/k) e[n-1]^(-b2/k) e[n-2]^(-b3/k)  //
+//                         * (h[n]/h[n-1])^(-a2) * (h[n-1]/h[n-2])^(-a3),     //
+//                                                                            //
+//     STEP_CONTROLLER_I          b1 = 1, the elementary controller,          //
+//     STEP_CONTROLLER_PI         b1 = 0.7, b2 = -0.4, the PI controller of   //
+//                                Gustafsson (1991),                          //
+//     STEP_CONTROLLER_PID        b1 = 1/18, b2 = 1/9, b3 = 1/18, Soderlind's //
+//                                H312PID filter,                             //
+//     STEP_CONTROLLER_PREDICTIVE the predictive controller of Gustafsson     //
+//                                (1994) which takes the smaller of the       //
+//                                elementary ratio and the ratio              //
+//                             (h[n]/h[n-1]) (e[n-1]/e[n])^(1/k) e[n]^(-1/k), //
+//                                so that the step size decreases in time     //
+//                                when the error grows.                       //
+//                                                                            //
+//     The filter coefficients may be replaced by Step_Controller_Set_Filter()//
+//     e.g. by the H211b filter b1 = b2 = 1/4, a2 = 1/4.  A rejected step is  //
+//     retried with the elementary ratio, which never exceeds the safety      //
+//     factor, and the step following a rejection may not grow.  The ratio is //
+//     always limited to the interval [min_ratio, max_ratio].  The defaults   //
+//     are safety = 0.9, min_ratio = 0.2 and max_ratio = 5.                   //
+//                                                                            //
+//     A controller keeps the history of the accepted steps of a single       //
+//     integration and must not be shared by concurrent integrations.         //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+#include <math.h>                               // required for exp(), log()
+#include <stdlib.h>                             // required for malloc()
+
+#define STEP_CONTROLLER_I          0
+#define STEP_CONTROLLER_PI         1
+#define STEP_CONTROLLER_PID        2
+#define STEP_CONTROLLER_PREDICTIVE 3
+
+#define MIN_ERROR 1.0e-10
+
+struct Step_Controller {
+   int type;
+   double order;
+   double safety;
+   double min_ratio;
+   double max_ratio;
+   double beta[3];
+   double alpha[2];
+   int history;                      // the number of accepted steps, at most 2
+   int rejected;                     // the last step was rejected
+   double log_error[2];              // log e[n-1], log e[n-2]
+   double log_ratio;                 // log h[n-1]/h[n-2]
+   double h_old;                     // the last accepted step size h[n-1]
+};
+
+void Step_Controller_Reset( struct Step_Controller *c );
+
+////////////////////////////////////////////////////////////////////////////////
+//  struct Step_Controller* Step_Controller_Create( int type, double order )  //
+//                                                                            //
+//  Description:                                                              //
+//     Creates a controller of the given type for an error estimate of order  //
+//     'order' with the default limits and filter coefficients.               //
+//                                                                            //
+//  Arguments:                                                                //
+//     int    type   0 (I), 1 (PI), 2 (PID) or 3 (predictive).                //
+//     double order  The order k of the error estimate, e ~ C h^k, k > 0.     //
+//                   For an embedded pair of orders p(q) this is min(p,q)+1.  //
+//                                                                            //
+//  Return Values:                                                            //
+//     A pointer to the controller, which must be released with               //
+//     Step_Controller_Free(), or NULL if the type is invalid or memory could //
+//     not be allocated.                                                      //
+//                                                                            //
+//  Example:                                                                  //
+//     struct Step_Controller *c = Step_Controller_Create( 1, 5.0 );          //
+//     double h = 1.e-3;                                                      //
+//     int accept;                                                            //
+//                                                                            //
+//     while (x < x1) {                                                       //
+//        (take a step of size h with error norm e)                           //
+//        h_next = Step_Controller_Next( c, h, e, &accept );                  //
+//        if (accept) { x += h; (advance the solution) }                      //
+//        h = h_next;                                                         //
+//     }                                                                      //
+//     Step_Controller_Free( c );                                             //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+struct Step_Controller* Step_Controller_Create( int type, double order ) {
+
+   struct Step_Controller *c;
+   int i;
+
+   if (type < STEP_CONTROLLER_I || type > STEP_CONTROLLER_PREDICTIVE)
+      return NULL;
+   c = (struct Step_Controller*) malloc( sizeof(struct Step_Controller) );
+   if (c == NULL) return NULL;
+   c->type = type;
+   c->order = (order > 0.0) ? order : 1.0;
+   c->safety = 0.9;
+   c->min_ratio = 0.2;
+   c->max_ratio = 5.0;
+   for (i = 0; i < 3; i++) c->beta[i] = 0.0;
+   c->alpha[0] = c->alpha[1] = 0.0;
+   switch (type) {
+      case STEP_CONTROLLER_PI:
+         c->beta[0] = 0.7;
+         c->beta[1] = -0.4;
+         break;
+      case STEP_CONTROLLER_PID:
+         c->beta[0] = 1.0 / 18.0;
+         c->beta[1] = 1.0 / 9.0;
+         c->beta[2] = 1.0 / 18.0;
+         break;
+      default:
+         c->beta[0] = 1.0;
+   }
+   Step_Controller_Reset( c );
+   return c;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Step_Controller_Set_Limits( struct Step_Controller *c, double safety,//
+//                                       double min_ratio, double max_ratio ) //
+//                                                                            //
+//  Description:                                                              //
+//     Sets the safety factor, 0 < safety <= 1, and the limits of the ratio   //
+//     of successive step sizes, 0 < min_ratio < 1 < max_ratio.               //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Step_Controller_Set_Limits( struct Step_Controller *c, double safety,
+                                        double min_ratio, double max_ratio ) {
+
+   c->safety = safety;
+   c->min_ratio = min_ratio;
+   c->max_ratio = max_ratio;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Step_Controller_Set_Filter( struct Step_Controller *c, double b1,    //
+//                         double b2, double b3, double a2, double a3 )       //
+//                                                                            //
+//  Description:                                                              //
+//     Replaces the filter coefficients of an I, PI or PID controller by      //
+//     b1, b2, b3, a2 and a3 as in the formula above.                         //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Step_Controller_Set_Filter( struct Step_Controller *c, double b1,
+                                   double b2, double b3, double a2, double a3 ) {
+
+   c->beta[0] = b1;
+   c->beta[1] = b2;
+   c->beta[2] = b3;
+   c->alpha[0] = a2;
+   c->alpha[1] = a3;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Step_Controller_Set_Order( struct Step_Controller *c, double order ) //
+//                                                                            //
+//  Description:                                                              //
+//     Sets the order k of the error estimate of the next step, for methods   //
+//     such as extrapolation methods whose order varies from step to step.    //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Step_Controller_Set_Order( struct Step_Controller *c, double order ) {
+
+   if (order > 0.0) c->order = order;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  double Step_Controller_Next( struct Step_Controller *c, double h,         //
+//                                                double error, int *accept ) //
+//                                                                            //
+//  Description:                                                              //
+//     Given the scaled error norm of a step of size h, decides whether the   //
+//     step is accepted and returns the size of the next step if it is, or    //
+//     the size with which to retry the step if it is not.                    //
+//                                                                            //
+//  Arguments:                                                                //
+//     struct Step_Controller *c  The controller.                             //
+//     double h                   The size of the step just taken.            //
+//     double error               The error norm of the step, scaled so that  //
+//                                the step is acceptable if error <= 1.       //
+//     int    *accept             Set to 1 if the step is accepted, 0 if not. //
+//                                                                            //
+//  Return Values:                                                            //
+//     The proposed step size.                                                //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double Step_Controller_Next( struct Step_Controller *c, double h,
+                                                double error, int *accept ) {
+
+   double log_e;
+   double log_h;                                        // log h[n]/h[n-1]
+   double log_ratio;
+   double log_predict;
+   double ratio;
+   double k = c->order;
+
+   if ( !(error <= 1.0) ) {                    // rejected, or error is NaN
+
+      *accept = 0;
+      c->rejected = 1;
+      ratio = (error == error) ? c->safety * pow(error, -1.0 / k) : 0.0;
+      if (ratio > c->safety) ratio = c->safety;
+      if (ratio < c->min_ratio) ratio = c->min_ratio;
+      return h * ratio;
+   }
+
+   *accept = 1;
+   log_e = log( (error > MIN_ERROR) ? error : MIN_ERROR );
+   log_h = (c->history > 0) ? log(h / c->h_old) : 0.0;
+   log_ratio = -log_e / k;
+
+   if (c->type == STEP_CONTROLLER_PREDICTIVE) {
+      if (c->history > 0) {
+         log_predict = log_h + (c->log_error[0] - 2.0 * log_e) / k;
+         if (log_predict < log_ratio) log_ratio = log_predict;
+      }
+   }
+   else {
+
+            // Missing history is replaced by the current error and by  //
+            // constant step sizes.                                      //
+
+      log_ratio = -c->beta[0] * log_e
+                  - c->beta[1] * ( (c->history > 0) ? c->log_error[0] : log_e )
+                  - c->beta[2] * ( (c->history > 1) ? c->log_error[1] : log_e );
+      log_ratio /= k;
+      log_ratio -= c->alpha[0] * log_h + c->alpha[1] * c->log_ratio;
+   }
+
+   ratio = c->safety * exp(log_ratio);
+   if (c->rejected && ratio > 1.0) ratio = 1.0;
+   if (ratio > c->max_ratio) ratio = c->max_ratio;
+   if (ratio < c->min_ratio) ratio = c->min_ratio;
+
+               // Shift the history of the accepted steps. //
+
+   c->log_error[1] = c->log_error[0];
+   c->log_error[0] = log_e;
+   c->log_ratio = log_h;
+   c->h_old = h;
+   if (c->history < 2) c->history++;
+   c->rejected = 0;
+   return h * ratio;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Step_Controller_Reset( struct Step_Controller *c )                   //
+//                                                                            //
+//  Description:                                                              //
+//     Clears the history of the controller before a new integration.         //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Step_Controller_Reset( struct Step_Controller *c ) {
+
+   c->history = 0;
+   c->rejected = 0;
+   c->log_error[0] = c->log_error[1] = 0.0;
+   c->log_ratio = 0.0;
+   c->h_old = 0.0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Step_Controller_Free( struct Step_Controller *c )                    //
+//                                                                            //
+//  Description:                                                              //
+//     Releases a controller created by Step_Controller_Create().             //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Step_Controller_Free( struct Step_Controller *c ) {
+
+   free(c);
+}
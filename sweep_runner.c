@@ -0,0 +1,372 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: sweep_runner.c                                                       //
+// Purpose:                                                                   //
+//    Run a parameter sweep of initial value problems, one configuration per  //
+//    line of a specification file, on all the processors of a node.          //
+//                                                                            //
+// Usage: sweep_runner [-p processes] specification [output]                  //
+//                                                                            //
+// Each line of the specification, other than blank lines and lines starting  //
+// with '#', is                                                               //
+//                                                                            //
+//    method problem rtol atol h x0 x1 dx y0[0] ... y0[n-1]                   //
+//                                                                            //
+// where method is gbs (Gragg_Bulirsch_Stoer_System_Integrate with polynomial //
+// extrapolation), gbs-rational (with rational extrapolation) or verner       //
+// (Runge_Kutta_Verner_System with the fixed step h), problem is one of the   //
+// built in problems below, rtol and atol are the tolerances of every         //
+// component, h is the (initial) step size, and the solution is output at     //
+// x0, x0 + dx, ..., x1.                                                      //
+//                                                                            //
+//    xy      y' = x y,                                        n = 1          //
+//    kepler  the two body problem r'' = -r / |r|^3, y = (r,r'),  n = 4       //
+//    vdp     the van der Pol oscillator, mu = 1,              n = 2          //
+//    lorenz  the Lorenz system, sigma = 10, rho = 28, beta = 8/3,  n = 3     //
+//                                                                            //
+// The configurations are claimed one at a time, through an atomic counter    //
+// in shared memory, by worker processes forked from the runner (by default   //
+// one per online processor), so that long and short runs balance.  Since     //
+// the number of output points of each configuration is known in advance,     //
+// every configuration owns a fixed slot of records in a shared mapping,      //
+// either anonymous or of the output file, which the workers fill in place.   //
+// The output is therefore merged, in the order of the specification, as      //
+// soon as the workers have finished, without copying.  The output file is a  //
+// sequence of struct Sweep_Record in the native binary format.               //
+//                                                                            //
+// At the end the throughput (configurations, output records and evaluations  //
+// of the right hand side per second) is reported, in total and per worker.   //
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#define SWEEP_MAX_DIM 4
+#define MAX_WORKERS 256
+#define MAX_LINE 1024
+
+struct Step_Controller;
+
+int Gragg_Bulirsch_Stoer_System_Integrate(
+     void (*f)(double, double[], double[]), double y[], int n, double x0,
+     double x1, double h, double atol[], double rtol[],
+                        int rational_extrapolate, int family,
+                        struct Step_Controller *controller, int *rejections );
+void Runge_Kutta_Verner_System( void (*f)(double, double[], double[]),
+                 double y[], int n, double x0, double h, int number_of_steps,
+                                                             double work[] );
+
+struct Sweep_Record {
+   int config;                          // the line of the configuration
+   int status;                          // 0 or the error of the integrator
+   double x;
+   double y[SWEEP_MAX_DIM];
+};
+
+struct Configuration {
+   int method;
+   int problem;
+   int line;
+   double rtol, atol, h, x0, x1, dx;
+   double y0[SWEEP_MAX_DIM];
+   long first;                          // the index of its first record
+   long records;
+};
+
+struct Shard_Statistics {
+   long configurations;
+   long records;
+   long evaluations;
+   double seconds;
+};
+
+struct Shared_Control {
+   atomic_int next;
+   struct Shard_Statistics shard[MAX_WORKERS];
+};
+
+static const char *method_name[] = { "gbs", "gbs-rational", "verner" };
+static const char *problem_name[] = { "xy", "kepler", "vdp", "lorenz" };
+static const int problem_dim[] = { 1, 4, 2, 3 };
+
+static long evaluations;                // of the current worker process
+
+static void Xy( double x, double y[], double dy[] ) {
+   evaluations++;
+   dy[0] = x * y[0];
+}
+
+static void Kepler( double x, double y[], double dy[] ) {
+   double r = sqrt( y[0] * y[0] + y[1] * y[1] );
+   double r3 = r * r * r;
+
+   (void) x;
+   evaluations++;
+   dy[0] = y[2];
+   dy[1] = y[3];
+   dy[2] = -y[0] / r3;
+   dy[3] = -y[1] / r3;
+}
+
+static void Van_der_Pol( double x, double y[], double dy[] ) {
+   (void) x;
+   evaluations++;
+   dy[0] = y[1];
+   dy[1] = (1.0 - y[0] * y[0]) * y[1] - y[0];
+}
+
+static void Lorenz( double x, double y[], double dy[] ) {
+   (void) x;
+   evaluations++;
+   dy[0] = 10.0 * (y[1] - y[0]);
+   dy[1] = y[0] * (28.0 - y[2]) - y[1];
+   dy[2] = y[0] * y[1] - (8.0 / 3.0) * y[2];
+}
+
+static void (*problem_function[])(double, double[], double[]) =
+                                      { Xy, Kepler, Van_der_Pol, Lorenz };
+
+static double Seconds( void ) {
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (double) t.tv_sec + 1.e-9 * (double) t.tv_nsec;
+}
+
+static int Lookup( const char *name, const char *table[], int entries ) {
+   int i;
+
+   for (i = 0; i < entries; i++) if ( strcmp(name, table[i]) == 0 ) return i;
+   return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Read the specification.  Returns the number of configurations or -1.       //
+////////////////////////////////////////////////////////////////////////////////
+
+static int Read_Specification( const char *filename,
+                                         struct Configuration **configs ) {
+   FILE *in = fopen(filename, "r");
+   char line[MAX_LINE], method[64], problem[64];
+   struct Configuration *c = NULL, *grown;
+   int count = 0, allocated = 0, line_number = 0;
+   int offset, used, i, n;
+   long first = 0;
+
+   if (in == NULL) { perror(filename); return -1; }
+   while ( fgets(line, MAX_LINE, in) != NULL ) {
+      line_number++;
+      if ( sscanf(line, " %63s", method) != 1 || method[0] == '#' ) continue;
+      if (count == allocated) {
+         allocated = (allocated > 0) ? 2 * allocated : 64;
+         grown = (struct Configuration*) realloc( c,
+                                 allocated * sizeof(struct Configuration) );
+         if (grown == NULL) { free(c); fclose(in); return -1; }
+         c = grown;
+      }
+      if ( sscanf(line, " %63s %63s %lf %lf %lf %lf %lf %lf%n", method,
+            problem, &c[count].rtol, &c[count].atol, &c[count].h,
+            &c[count].x0, &c[count].x1, &c[count].dx, &offset) != 8 ) {
+         fprintf(stderr, "%s:%d: expected 8 fields\n", filename, line_number);
+         free(c); fclose(in); return -1;
+      }
+      c[count].method = Lookup(method, method_name, 3);
+      c[count].problem = Lookup(problem, problem_name, 4);
+      if (c[count].method < 0 || c[count].problem < 0) {
+         fprintf(stderr, "%s:%d: unknown method or problem\n", filename,
+                                                              line_number);
+         free(c); fclose(in); return -1;
+      }
+      n = problem_dim[c[count].problem];
+      for (i = 0; i < n; i++, offset += used)
+         if ( sscanf(line + offset, "%lf%n", &c[count].y0[i], &used) != 1 ) {
+            fprintf(stderr, "%s:%d: expected %d initial values\n", filename,
+                                                           line_number, n);
+            free(c); fclose(in); return -1;
+         }
+      if ( !(c[count].dx > 0.0) || !(c[count].x1 >= c[count].x0)
+                                                   || !(c[count].h > 0.0) ) {
+         fprintf(stderr, "%s:%d: invalid interval\n", filename, line_number);
+         free(c); fclose(in); return -1;
+      }
+      c[count].line = line_number;
+      c[count].first = first;
+      c[count].records = (long) floor( (c[count].x1 - c[count].x0)
+                                                / c[count].dx + 1.e-9 ) + 1;
+      first += c[count].records;
+      count++;
+   }
+   fclose(in);
+   *configs = c;
+   return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Integrate one configuration, writing its records.                          //
+////////////////////////////////////////////////////////////////////////////////
+
+static void Run_Configuration( struct Configuration *c,
+                                                struct Sweep_Record *out ) {
+   void (*f)(double, double[], double[]) = problem_function[c->problem];
+   int n = problem_dim[c->problem];
+   double y[SWEEP_MAX_DIM], atol[SWEEP_MAX_DIM], rtol[SWEEP_MAX_DIM];
+   double work[8 * SWEEP_MAX_DIM];
+   double x = c->x0, x_next;
+   int status = 0, steps;
+   long k;
+   int i;
+
+   for (i = 0; i < n; i++) {
+      y[i] = c->y0[i];
+      atol[i] = c->atol;
+      rtol[i] = c->rtol;
+   }
+   for (k = 0; k < c->records; k++) {
+      x_next = (k == c->records - 1 && k > 0) ? c->x1 : c->x0 + k * c->dx;
+      if (k > 0 && status == 0) {
+         if (c->method == 2) {
+            steps = (int) ceil( (x_next - x) / c->h - 1.e-9 );
+            if (steps < 1) steps = 1;
+            Runge_Kutta_Verner_System( f, y, n, x, (x_next - x) / steps,
+                                                             steps, work );
+         }
+         else
+            status = Gragg_Bulirsch_Stoer_System_Integrate( f, y, n, x,
+                   x_next, c->h, atol, rtol, c->method == 1, -1, NULL, NULL );
+         x = x_next;
+      }
+      out[k].config = c->line;
+      out[k].status = status;
+      out[k].x = x_next;
+      for (i = 0; i < SWEEP_MAX_DIM; i++) out[k].y[i] = (i < n) ? y[i] : 0.0;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The loop of a worker: claim configurations until none are left.            //
+////////////////////////////////////////////////////////////////////////////////
+
+static void Worker( int id, struct Configuration *configs, int count,
+                  struct Sweep_Record *records, struct Shared_Control *ctl ) {
+   struct Shard_Statistics *s = &ctl->shard[id];
+   double start = Seconds();
+   int i;
+
+   evaluations = 0;
+   while ( (i = atomic_fetch_add( &ctl->next, 1 )) < count ) {
+      Run_Configuration( &configs[i], records + configs[i].first );
+      s->configurations++;
+      s->records += configs[i].records;
+   }
+   s->evaluations = evaluations;
+   s->seconds = Seconds() - start;
+}
+
+int main(int argc, char *argv[])
+{
+   struct Configuration *configs;
+   struct Shared_Control *ctl;
+   struct Sweep_Record *records;
+   const char *spec = NULL, *output = NULL;
+   long total_records, total_evaluations = 0;
+   size_t bytes;
+   double start, elapsed;
+   int workers = (int) sysconf( _SC_NPROCESSORS_ONLN );
+   int count, fd = -1, failed = 0, status;
+   int i;
+   pid_t pid;
+
+   for (i = 1; i < argc; i++) {
+      if ( strcmp(argv[i], "-p") == 0 && i + 1 < argc )
+         workers = atoi(argv[++i]);
+      else if (spec == NULL) spec = argv[i];
+      else output = argv[i];
+   }
+   if (spec == NULL) {
+      fprintf(stderr, "Usage: %s [-p processes] specification [output]\n",
+                                                                  argv[0]);
+      return 1;
+   }
+   if (workers < 1) workers = 1;
+   if (workers > MAX_WORKERS) workers = MAX_WORKERS;
+
+   if ( (count = Read_Specification( spec, &configs )) < 0 ) return 1;
+   if (count == 0) { fprintf(stderr, "%s: no configurations\n", spec);
+                     return 1; }
+   total_records = configs[count-1].first + configs[count-1].records;
+   if (workers > count) workers = count;
+
+            // The shared control block and the shared records. //
+
+   ctl = (struct Shared_Control*) mmap( NULL, sizeof(struct Shared_Control),
+                 PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0 );
+   if (ctl == MAP_FAILED) { perror("mmap"); return 1; }
+   memset( ctl, 0, sizeof(struct Shared_Control) );
+   atomic_init( &ctl->next, 0 );
+
+   bytes = (size_t) total_records * sizeof(struct Sweep_Record);
+   if (output == NULL)
+      records = (struct Sweep_Record*) mmap( NULL, bytes,
+                 PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0 );
+   else {
+      fd = open( output, O_RDWR | O_CREAT | O_TRUNC, 0644 );
+      if (fd < 0 || ftruncate( fd, (off_t) bytes ) != 0) {
+         perror(output);
+         return 1;
+      }
+      records = (struct Sweep_Record*) mmap( NULL, bytes,
+                                PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+      close(fd);
+   }
+   if (records == MAP_FAILED) { perror("mmap"); return 1; }
+
+            // Fork the workers and wait for them. //
+
+   start = Seconds();
+   for (i = 0; i < workers; i++) {
+      pid = fork();
+      if (pid == 0) {
+         Worker( i, configs, count, records, ctl );
+         _exit(0);
+      }
+      if (pid < 0) { perror("fork"); workers = i; break; }
+   }
+   if (workers == 0) Worker( workers++, configs, count, records, ctl );
+   while ( wait(&status) > 0 )
+      if ( !WIFEXITED(status) || WEXITSTATUS(status) != 0 ) failed++;
+   elapsed = Seconds() - start;
+   if (output != NULL) msync( records, bytes, MS_SYNC );
+
+            // Report. //
+
+   printf("Prog: sweep_runner.c\n");
+   printf("%d configurations, %ld records, %d workers, %.3f s\n", count,
+                                           total_records, workers, elapsed);
+   printf("\n worker  configurations   records  evaluations   seconds\n");
+   for (i = 0; i < workers; i++) {
+      printf("%6d %14ld %10ld %12ld %9.3f\n", i,
+            ctl->shard[i].configurations, ctl->shard[i].records,
+            ctl->shard[i].evaluations, ctl->shard[i].seconds);
+      total_evaluations += ctl->shard[i].evaluations;
+   }
+   printf("\nthroughput: %.1f configurations/s, %.1f records/s, "
+          "%.4g evaluations/s\n", count / elapsed, total_records / elapsed,
+                                                total_evaluations / elapsed);
+   for (i = 0, status = 0; i < total_records; i++)
+      if (records[i].status != 0) status++;
+   if (status > 0) printf("%d records after a failed integration\n", status);
+   if (failed > 0) printf("%d workers failed\n", failed);
+   if (output != NULL) printf("output: %s\n", output);
+
+   munmap( records, bytes );
+   munmap( ctl, sizeof(struct Shared_Control) );
+   free(configs);
+   return (failed > 0) ? 1 : 0;
+}
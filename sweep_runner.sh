@@ -0,0 +1,53 @@
+#  Run a parameter sweep with the runner in the file sweep_runner.c
+#
+#  Dependent on: bulirsch_stoer.c, weighted_rms_norm.c, step_profile_cache.c,
+#                step_size_controller.c, runge_kutta_verner.c,
+#                vector_kernels.c, richardson_adaptive.c
+#
+#  After downloading change permissions: chmod 744 sweep_runner.sh
+#  Execute as ./sweep_runner.sh [specification [output]]
+#
+#  Without a specification an example sweep of the Kepler problem over
+#  eccentricities and tolerances is written to sweep_example.txt and run.
+#  Set PROCESSES to limit the number of worker processes.
+#
+# Change! if the source files are in a different directory.
+gcc -O2 -c -o x1.o bulirsch_stoer.c
+gcc -O2 -c -o x2.o weighted_rms_norm.c
+gcc -O2 -c -o x3.o step_profile_cache.c
+gcc -O2 -c -o x4.o step_size_controller.c
+gcc -O2 -c -o x5.o runge_kutta_verner.c
+gcc -O2 -c -o x6.o vector_kernels.c
+gcc -O2 -c -o x7.o richardson_adaptive.c
+
+# Change! if sweep_runner.c is in a different directory.
+gcc -O2 -o svers sweep_runner.c x1.o x2.o x3.o x4.o x5.o x6.o x7.o \
+                                                                        -lm
+
+SPEC=$1
+if [ -z "$SPEC" ]; then
+   SPEC=sweep_example.txt
+   echo "# method problem rtol atol h x0 x1 dx y0..." > $SPEC
+   for e in 0.0 0.1 0.2 0.3 0.4 0.5 0.6 0.7 0.8 0.9; do
+      v=`awk "BEGIN { printf \"%.17g\", sqrt((1+$e)/(1-$e)) }"`
+      r=`awk "BEGIN { printf \"%.17g\", 1-$e }"`
+      for tol in 1e-6 1e-8 1e-10 1e-12; do
+         echo "gbs kepler $tol $tol 0.1 0 62.83185307179586 0.1 $r 0 0 $v" \
+                                                                    >> $SPEC
+         echo "gbs-rational kepler $tol $tol 0.1 0 62.83185307179586 0.1" \
+                                                     "$r 0 0 $v" >> $SPEC
+      done
+      echo "verner kepler 0 0 0.01 0 62.83185307179586 0.1 $r 0 0 $v" >> $SPEC
+   done
+fi
+
+# Change! if you profile has a PATH set to this directory.
+if [ -n "$PROCESSES" ]; then
+   ./svers -p $PROCESSES $SPEC $2
+else
+   ./svers $SPEC $2
+fi
+
+# Delete temporary files.
+rm svers
+rm x1.o x2.o x3.o x4.o x5.o x6.o x7.o
@@ -6,6 +6,11 @@
 //                                                                            //
 // Solve the initial value problem, y' = xy, y(0) = 1.0.                      //
 // From x = 0.0 to 1.0, epsilon = 1.0e-10.                                    //
+//                                                                            //
+// Then solve the van der Pol equation for four nearby values of mu with      //
+// Gragg_Bulirsch_Stoer_System_Integrate, warm starting each run from the     //
+// step profile of the previous one, and compare the evaluations and the      //
+// rejected steps of the warm runs with those of the cold first run.          //
 ////////////////////////////////////////////////////////////////////////////////
 #include <stdio.h>
 #include <math.h>
@@ -13,6 +18,13 @@
 int Gragg_Bulirsch_Stoer( double (*f)(double, double), double y0, double *y1,
 double x, double h, double *h_new, double epsilon, double yscale, 
 int rational_extrapolate  );
+struct Step_Controller;
+int Gragg_Bulirsch_Stoer_System_Integrate( 
+     void (*f)(double, double[], double[]), double y[], int n, double x0, 
+     double x1, double h, double atol[], double rtol[],
+                        int rational_extrapolate, int family,
+                        struct Step_Controller *controller, int *rejections );
+void Step_Profile_Free_All( void );
 
 // y' = f(x,y) = xy, y(0) = 1
 double f(double x, double y) { return x*y; }
@@ -20,6 +32,17 @@ double f(double x, double y) { return x*y; }
 // The actual solution
 double If(double x) { return exp(0.5*x*x); }
 
+// The van der Pol equation y'' = mu (1 - y^2) y' - y as a system.
+double mu = 5.0;
+int evaluations;
+
+void van_der_Pol(double x, double y[], double dy[]) {
+   (void) x;
+   evaluations++;
+   dy[0] = y[1];
+   dy[1] = mu * (1.0 - y[0] * y[0]) * y[1] - y[0];
+}
+
 
 double tolerance = 1.e-10;          
 double a = 1.0;               // y(x0).
@@ -171,6 +194,41 @@ void Print_Rational_Extrapolation_Integral_Test() {
    }
 }
             
+void Print_Warm_Start_Test() {
+   double atol[2] = { 1.e-10, 1.e-10 };
+   double rtol[2] = { 1.e-10, 1.e-10 };
+   double y[2];
+   int cold_evaluations, cold_rejections, rejections, err;
+   int run;
+ 
+   fprintf(out,"\n\n\nGragg_Bulirsch_Stoer_System_Integrate\n\n");
+   fprintf(out,"Problem: Solve y'' = mu (1 - y^2) y' - y, y(0) = 2, y'(0) = 0,\n");
+   fprintf(out,"from x = 0 to 10 for mu = 5.00, 5.01, 5.02, 5.03, the first\n");
+   fprintf(out,"run cold, the others warm started from the step profile of\n");
+   fprintf(out,"the previous run\n\n");
+   fprintf(out,"   mu     evaluations  rejections       y(10)\n");
+   cold_evaluations = cold_rejections = 0;
+   for (run = 0; run < 4; run++) {
+      mu = 5.0 + 0.01 * run;
+      y[0] = 2.0;
+      y[1] = 0.0;
+      evaluations = 0;
+      err = Gragg_Bulirsch_Stoer_System_Integrate( van_der_Pol, y, 2, 0.0,
+                       10.0, 0.5, atol, rtol, 0, 7, NULL, &rejections );
+      fprintf(out,"  %5.2lf  %11d  %10d  %+20.15le", mu, evaluations,
+                                                            rejections, y[0]);
+      if (err != 0) fprintf(out,"  failed with %d", err);
+      fprintf(out,"\n");
+      if (run == 0) {
+         cold_evaluations = evaluations;
+         cold_rejections = rejections;
+      }
+      else if (rejections > cold_rejections || evaluations >= cold_evaluations)
+         fprintf(out,"FAIL: the warm run is no cheaper than the cold run\n");
+   }
+   Step_Profile_Free_All();
+}
+
 int main() 
 {
    out = fopen("Bulirsch_Stoer.txt","w");
@@ -179,6 +237,8 @@ int main()
    Print_Polynomial_Extrapolation_Integral_Test();
    fprintf(out,"\n\n\n");
    Print_Rational_Extrapolation_Integral_Test();
+   fprintf(out,"\n\n\n");
+   Print_Warm_Start_Test();
    fclose(out);
 
    return 0;
@@ -1,6 +1,7 @@
 #  Test the Bulirsch_Stoer method in the file bulirsch_stoer.c
 #
-#  Dependent on: (no external dependencies)
+#  Dependent on: weighted_rms_norm.c, step_profile_cache.c,
+#                step_size_controller.c
 #
 #  After downloading change permissions: chmod 744 test_Bulirsch_Stoer.sh
 #  Execute as ./test_Bulirsch_Stoer.sh (unless your profile has a PATH set to
@@ -10,12 +11,18 @@
 # Change! if bulirsch_stoer.c is in a different directory.
 gcc -c -o x1.o bulirsch_stoer.c
 
+# Change! if weighted_rms_norm.c, step_profile_cache.c or
+# step_size_controller.c are in a different directory.
+gcc -c -o x2.o weighted_rms_norm.c
+gcc -c -o x3.o step_profile_cache.c
+gcc -c -o x4.o step_size_controller.c
+
 # Change! if test_Bulirsch_Stoer.c is in a different directory.
-gcc -o cvers test_Bulirsch_Stoer.c x1.o -lm
+gcc -o cvers test_Bulirsch_Stoer.c x1.o x2.o x3.o x4.o -lm
 
 # Change! if you profile has a PATH set to this directory.
 ./cvers
 
 # Delete temporary files.
 rm cvers
-rm x1.o
+rm x1.o x2.o x3.o x4.o
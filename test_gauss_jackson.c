@@ -0,0 +1,136 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: test_gauss_jackson.c                                                 //
+// Purpose:                                                                   //
+//    Test the Gauss-Jackson integrator in the file gauss_jackson.c.          //
+//                                                                            //
+// The Kepler problem y'' = -y / |y|^3 with eccentricity e = 0.5, y(0) =      //
+// (1 - e, 0), y'(0) = (0, sqrt((1 + e) / (1 - e))), has the period 2 pi.  It //
+// is integrated over 10 periods with N = 200, 400 and 800 steps per period   //
+// for q = 4 and q = 6 back points, and the orders observed from the errors   //
+// at the end, log2(error(N) / error(2N)), must be near q + 2.  The harmonic  //
+// oscillator y'' = -y, y(0) = 1, y'(0) = 0, is integrated with q = 8, h =    //
+// 0.1 in both the PEC and the PECE modes, and Gauss_Jackson_Dense() must     //
+// reproduce cos(x) and -sin(x) within the last step.  The program prints     //
+// each check and returns the number of checks which failed.                  //
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <math.h>
+
+struct Gauss_Jackson;
+struct Gauss_Jackson* Gauss_Jackson_Create(
+         void (*f)(double, double[], double[], double[]), int n, int order,
+                                           double h, int pece, int *err );
+double Gauss_Jackson_Start( struct Gauss_Jackson *s, double x0, double y[],
+                                                              double yp[] );
+double Gauss_Jackson_Step( struct Gauss_Jackson *s, double y[], double yp[] );
+int Gauss_Jackson_Dense( struct Gauss_Jackson *s, double x, double y[],
+                                                              double yp[] );
+void Gauss_Jackson_Free( struct Gauss_Jackson *s );
+
+static int failures = 0;
+
+static void Kepler(double x, double y[], double yp[], double ypp[]) {
+   double r = sqrt(y[0] * y[0] + y[1] * y[1]);
+   double r3 = r * r * r;
+
+   (void) x;
+   (void) yp;
+   ypp[0] = -y[0] / r3;
+   ypp[1] = -y[1] / r3;
+}
+
+static void Oscillator(double x, double y[], double yp[], double ypp[]) {
+   (void) x;
+   (void) yp;
+   ypp[0] = -y[0];
+}
+
+static void Check( int passed, const char *what ) {
+   printf("%s  %s\n", passed ? "pass" : "FAIL", what);
+   if (!passed) failures++;
+}
+
+// The distance from the starting point after 10 periods of the Kepler
+// problem with N steps per period and q back points, or 1.e10 on failure.
+
+static double Kepler_Error( int q, int N ) {
+   struct Gauss_Jackson *s;
+   double e = 0.5, h = 2.0 * M_PI / N;
+   double y[2], yp[2];
+   int i, err;
+
+   y[0] = 1.0 - e; y[1] = 0.0;
+   yp[0] = 0.0; yp[1] = sqrt((1.0 + e) / (1.0 - e));
+   s = Gauss_Jackson_Create( Kepler, 2, q, h, 0, &err );
+   if (s == NULL) return 1.e10;
+   if (Gauss_Jackson_Start( s, 0.0, y, yp ) == 0.0) {
+      Gauss_Jackson_Free( s );
+      return 1.e10;
+   }
+   for (i = q - 1; i < 10 * N; i++) Gauss_Jackson_Step( s, y, yp );
+   Gauss_Jackson_Free( s );
+   return sqrt((y[0] - 1.0 + e) * (y[0] - 1.0 + e) + y[1] * y[1]);
+}
+
+// The largest error of y and y' of the harmonic oscillator at the steps and
+// at the interpolated points x[m] - h/4, x[m] - h/2 and x[m] - 3h/4 over 200
+// steps of h = 0.1, or 1.e10 on failure.
+
+static double Oscillator_Error( int pece ) {
+   struct Gauss_Jackson *s;
+   double y[1] = { 1.0 }, yp[1] = { 0.0 }, yd[1], ypd[1];
+   double x, t, error = 0.0;
+   int i, k, err;
+
+   s = Gauss_Jackson_Create( Oscillator, 1, 8, 0.1, pece, &err );
+   if (s == NULL) return 1.e10;
+   x = Gauss_Jackson_Start( s, 0.0, y, yp );
+   if (x == 0.0) { Gauss_Jackson_Free( s ); return 1.e10; }
+   for (i = 0; i < 200; i++) {
+      x = Gauss_Jackson_Step( s, y, yp );
+      error = fmax(error, fabs(y[0] - cos(x)));
+      error = fmax(error, fabs(yp[0] + sin(x)));
+      for (k = 1; k <= 3; k++) {
+         t = x - 0.025 * k;
+         if (Gauss_Jackson_Dense( s, t, yd, ypd ) != 0) error = 1.e10;
+         error = fmax(error, fabs(yd[0] - cos(t)));
+         error = fmax(error, fabs(ypd[0] + sin(t)));
+      }
+   }
+   Gauss_Jackson_Free( s );
+   return error;
+}
+
+int main()
+{
+   struct Gauss_Jackson *s;
+   double e1, e2, e3, p1, p2, error;
+   int q, err;
+   char line[100];
+
+   s = Gauss_Jackson_Create( Kepler, 2, 1, 0.1, 0, &err );
+   Check( s == NULL && err == -3, "order 1 is rejected" );
+
+   for (q = 4; q <= 6; q += 2) {
+      e1 = Kepler_Error( q, 200 );
+      e2 = Kepler_Error( q, 400 );
+      e3 = Kepler_Error( q, 800 );
+      p1 = log(e1 / e2) / log(2.0);
+      p2 = log(e2 / e3) / log(2.0);
+      sprintf(line, "Kepler, q = %d: errors %.2le %.2le %.2le, orders %.2lf"
+                                          " %.2lf", q, e1, e2, e3, p1, p2);
+      Check( fabs(p1 - q - 2.0) < 0.6 && fabs(p2 - q - 2.0) < 0.6, line );
+   }
+
+   error = Oscillator_Error( 0 );
+   sprintf(line, "oscillator, q = 8, PEC: steps and dense output error %.2le",
+                                                                      error);
+   Check( error < 1.e-8, line );
+   error = Oscillator_Error( 1 );
+   sprintf(line, "oscillator, q = 8, PECE: steps and dense output error "
+                                                           "%.2le", error);
+   Check( error < 1.e-8, line );
+
+   printf("%d failures\n", failures);
+   return failures;
+}
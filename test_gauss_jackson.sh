@@ -0,0 +1,28 @@
+#  Test the Gauss-Jackson integrator in the file gauss_jackson.c
+#
+#  Dependent on: runge_kutta_2nd_order.c, weighted_rms_norm.c,
+#                step_size_controller.c
+#
+#  After downloading change permissions: chmod 744 test_gauss_jackson.sh
+#  Execute as ./test_gauss_jackson.sh (unless your profile has a PATH set
+#                                      to this directory)
+#
+#
+# Change! if gauss_jackson.c is in a different directory.
+gcc -c -o x1.o gauss_jackson.c
+
+# Change! if runge_kutta_2nd_order.c, weighted_rms_norm.c or
+# step_size_controller.c are in a different directory.
+gcc -c -o x2.o runge_kutta_2nd_order.c
+gcc -c -o x3.o weighted_rms_norm.c
+gcc -c -o x4.o step_size_controller.c
+
+# Change! if test_gauss_jackson.c is in a different directory.
+gcc -o gjvers test_gauss_jackson.c x1.o x2.o x3.o x4.o -lm
+
+# Change! if you profile has a PATH set to this directory.
+./gjvers
+
+# Delete temporary files.
+rm gjvers
+rm x1.o x2.o x3.o x4.o
@@ -0,0 +1,203 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: test_newmark_beta.c                                                  //
+// Purpose:                                                                   //
+//    Test the Newmark-beta, HHT-alpha and generalized-alpha methods in the   //
+//    file newmark_beta.c against closed form solutions.                      //
+//                                                                            //
+// For the linear oscillator y'' + w^2 y = 0, y(0) = 1, y'(0) = 0, the        //
+// average acceleration method (Newmark, beta = 1/4) is the trapezoidal rule, //
+// whose solution is y[n] = cos(n theta), theta = 2 atan(w h / 2): the        //
+// amplitude is preserved and the period is lengthened by the factor          //
+// w h / theta, about 1 + (w h)^2 / 12.  This is checked for w = 2, h = 0.05  //
+// over 2000 steps, the period being measured from the zero crossings of the  //
+// solution.  HHT-alpha with alpha = 0 must give the same solution, and with  //
+// alpha = -0.1 it must dissipate the energy.  The two degree of freedom      //
+// system with M = I, K = [2 -1; -1 2] and y(0) = (1, 0) has the modes w = 1  //
+// and w = sqrt(3), and checks the factorization of a matrix with off         //
+// diagonal entries.  The damped oscillator y'' + 0.4 y' + 4 y = 0 is solved  //
+// by generalized-alpha with rho = 0.8 for h = 0.02 and 0.01, the error ratio //
+// should be near 4 (second order), and Generalized_Alpha_Step_Nonlinear()    //
+// with the linear internal force 4 y must reproduce the linear steps.  The   //
+// program prints each check and returns the number of checks which failed.   //
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <math.h>
+
+struct Generalized_Alpha;
+struct Generalized_Alpha* Generalized_Alpha_Create( int n,
+                int M_row[], int M_col[], double M_val[],
+                int C_row[], int C_col[], double C_val[],
+                int K_row[], int K_col[], double K_val[],
+                          double h, int scheme, double parameter, int *err );
+int Generalized_Alpha_Initialize( struct Generalized_Alpha *s, double t0,
+            double d[], double v[], void (*force)(double, double[]),
+                     void (*internal_force)(double[], double[]), double a[] );
+void Generalized_Alpha_Step( struct Generalized_Alpha *s, double t,
+        double d[], double v[], double a[], void (*force)(double, double[]) );
+int Generalized_Alpha_Step_Nonlinear( struct Generalized_Alpha *s, double t,
+           double d[], double v[], double a[], void (*force)(double, double[]),
+           void (*internal_force)(double[], double[]), double tolerance,
+                                        int max_iterations, int *iterations );
+void Generalized_Alpha_Free( struct Generalized_Alpha *s );
+
+static int failures = 0;
+static int dof = 1;
+
+          // The matrices in CSR storage: the scalars 1, 0.4 and 4, and the //
+          // 2 x 2 identity and stiffness matrices.                         //
+
+static int one_row[] = { 0, 1 }, one_col[] = { 0 };
+static double m_val[] = { 1.0 }, c_val[] = { 0.4 }, k_val[] = { 4.0 };
+static int two_row[] = { 0, 2, 4 }, two_col[] = { 0, 1, 0, 1 };
+static int eye_row[] = { 0, 1, 2 }, eye_col[] = { 0, 1 };
+static double eye_val[] = { 1.0, 1.0 }, k2_val[] = { 2.0, -1.0, -1.0, 2.0 };
+
+static void No_Force(double t, double F[]) {
+   int i;
+
+   (void) t;
+   for (i = 0; i < dof; i++) F[i] = 0.0;
+}
+
+static void Spring(double d[], double fint[]) { fint[0] = 4.0 * d[0]; }
+
+static void Check( int passed, const char *what ) {
+   printf("%s  %s\n", passed ? "pass" : "FAIL", what);
+   if (!passed) failures++;
+}
+
+// Integrate y'' + 4 y = 0, y(0) = 1, y'(0) = 0 by the scheme for 2000 steps
+// of h = 0.05, store y[n] in d[] and return the largest change of the energy
+// (y'^2 + 4 y^2) / 2 from its initial value 2, signed, or 1.e10 on failure.
+
+static double Oscillator( int scheme, double parameter, double d[] ) {
+   struct Generalized_Alpha *s;
+   double y = 1.0, v = 0.0, a, change = 0.0, energy;
+   int i, err;
+
+   s = Generalized_Alpha_Create( 1, one_row, one_col, m_val, NULL, NULL,
+            NULL, one_row, one_col, k_val, 0.05, scheme, parameter, &err );
+   if (s == NULL) return 1.e10;
+   Generalized_Alpha_Initialize( s, 0.0, &y, &v, No_Force, NULL, &a );
+   d[0] = y;
+   for (i = 1; i <= 2000; i++) {
+      Generalized_Alpha_Step( s, 0.05 * (i - 1), &y, &v, &a, No_Force );
+      d[i] = y;
+      energy = 0.5 * v * v + 2.0 * y * y - 2.0;
+      if (fabs(energy) > fabs(change)) change = energy;
+   }
+   Generalized_Alpha_Free( s );
+   return change;
+}
+
+// The error at t = 10 of y'' + 0.4 y' + 4 y = 0, y(0) = 1, y'(0) = 0 solved
+// by generalized-alpha, rho = 0.8, with the step size h.  If nonlinear is
+// non-zero the steps are Generalized_Alpha_Step_Nonlinear() and *difference
+// is set to the largest difference from the linear steps and *iterations
+// to the largest number of iterations of a step.
+
+static double Damped( double h, int nonlinear, double *difference,
+                                                        int *iterations ) {
+   struct Generalized_Alpha *s;
+   double y = 1.0, v = 0.0, a, yl = 1.0, vl = 0.0, al;
+   double w = sqrt(4.0 - 0.04), exact;
+   int i, k, n = (int) (10.0 / h + 0.5), err;
+
+   s = Generalized_Alpha_Create( 1, one_row, one_col, m_val, one_row,
+              one_col, c_val, one_row, one_col, k_val, h, 2, 0.8, &err );
+   if (s == NULL) return 1.e10;
+   Generalized_Alpha_Initialize( s, 0.0, &y, &v, No_Force, NULL, &a );
+   al = a;
+   if (nonlinear) { *difference = 0.0; *iterations = 0; }
+   for (i = 0; i < n; i++) {
+      if (nonlinear) {
+         err = Generalized_Alpha_Step_Nonlinear( s, h * i, &y, &v, &a,
+                                   No_Force, Spring, 1.e-14, 10, &k );
+         if (err != 0) { Generalized_Alpha_Free( s ); return 1.e10; }
+         if (k > *iterations) *iterations = k;
+      }
+      Generalized_Alpha_Step( s, h * i, &yl, &vl, &al, No_Force );
+      if (nonlinear && fabs(y - yl) > *difference) *difference = fabs(y - yl);
+   }
+   Generalized_Alpha_Free( s );
+   exact = exp(-2.0) * (cos(10.0 * w) + 0.2 / w * sin(10.0 * w));
+   return fabs(yl - exact);
+}
+
+int main()
+{
+   struct Generalized_Alpha *s;
+   static double d[2001], dh[2001];
+   double change, change_h, error, theta, e1, e2, difference;
+   double first = 0.0, last = 0.0, crossing, period;
+   double y[2], v[2], a[2], t1, t2;
+   int i, err, iterations, crossings = 0;
+   char line[100];
+
+   change = Oscillator( 0, 0.25, d );
+   theta = 2.0 * atan(0.05);
+   error = 0.0;
+   for (i = 0; i <= 2000; i++)
+      error = fmax(error, fabs(d[i] - cos(i * theta)));
+   sprintf(line, "Newmark 1/4: error from cos(n theta) %.2le, energy change"
+                                                     " %.2le", error, change);
+   Check( error < 1.e-10 && fabs(change) < 1.e-12, line );
+
+          // The period from the first and the last downward zero crossing, //
+          // located by linear interpolation, against the exact period pi.  //
+
+   for (i = 0; i < 2000; i++)
+      if (d[i] > 0.0 && d[i+1] <= 0.0) {
+         crossing = 0.05 * (i + d[i] / (d[i] - d[i+1]));
+         if (crossings++ == 0) first = crossing;
+         last = crossing;
+      }
+   period = (crossings > 1) ? (last - first) / (crossings - 1) : 0.0;
+   sprintf(line, "Newmark 1/4: period elongation %.4le, (w h)^2 / 12 = %.4le",
+                                            period / M_PI - 1.0, 0.01 / 12.0);
+   Check( fabs((period / M_PI - 1.0) / (0.01 / 12.0) - 1.0) < 0.02, line );
+
+   Oscillator( 1, 0.0, dh );
+   error = 0.0;
+   for (i = 0; i <= 2000; i++)
+      if (fabs(dh[i] - d[i]) > error) error = fabs(dh[i] - d[i]);
+   sprintf(line, "HHT-alpha 0: difference from Newmark 1/4 %.2le", error);
+   Check( error == 0.0, line );
+
+   change_h = Oscillator( 1, -0.1, dh );
+   sprintf(line, "HHT-alpha -0.1: energy change %.2le", change_h);
+   Check( change_h < -1.e-3, line );
+
+   dof = 2;
+   s = Generalized_Alpha_Create( 2, eye_row, eye_col, eye_val, NULL, NULL,
+                   NULL, two_row, two_col, k2_val, 0.05, 0, 0.25, &err );
+   y[0] = 1.0; y[1] = 0.0; v[0] = v[1] = 0.0;
+   error = 1.e10;
+   if (s != NULL) {
+      Generalized_Alpha_Initialize( s, 0.0, y, v, No_Force, NULL, a );
+      t1 = 2.0 * atan(0.025);
+      t2 = 2.0 * atan(0.025 * sqrt(3.0));
+      error = 0.0;
+      for (i = 1; i <= 2000; i++) {
+         Generalized_Alpha_Step( s, 0.05 * (i - 1), y, v, a, No_Force );
+         error = fmax(error, fabs(y[0] - 0.5 * (cos(i * t1) + cos(i * t2))));
+         error = fmax(error, fabs(y[1] - 0.5 * (cos(i * t1) - cos(i * t2))));
+      }
+      Generalized_Alpha_Free( s );
+   }
+   dof = 1;
+   sprintf(line, "two degrees of freedom: error from the modes %.2le", error);
+   Check( error < 1.e-10, line );
+
+   e1 = Damped( 0.02, 0, NULL, NULL );
+   e2 = Damped( 0.01, 1, &difference, &iterations );
+   sprintf(line, "generalized-alpha 0.8: errors %.2le, %.2le, ratio %.2lf",
+                                                           e1, e2, e1 / e2);
+   Check( e1 / e2 > 3.5 && e1 / e2 < 4.5, line );
+   sprintf(line, "nonlinear steps: difference %.2le, at most %d iterations",
+                                                   difference, iterations);
+   Check( difference < 1.e-12 && iterations <= 3, line );
+
+   printf("%d failures\n", failures);
+   return failures;
+}
@@ -0,0 +1,20 @@
+#  Test the Newmark-beta, HHT-alpha and generalized-alpha methods in the
+#  file newmark_beta.c
+#
+#  After downloading change permissions: chmod 744 test_newmark_beta.sh
+#  Execute as ./test_newmark_beta.sh (unless your profile has a PATH set
+#                                     to this directory)
+#
+#
+# Change! if newmark_beta.c is in a different directory.
+gcc -c -o x1.o newmark_beta.c
+
+# Change! if test_newmark_beta.c is in a different directory.
+gcc -o newmark test_newmark_beta.c x1.o -lm
+
+# Change! if you profile has a PATH set to this directory.
+./newmark
+
+# Delete temporary files.
+rm newmark
+rm x1.o
@@ -0,0 +1,216 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: test_realtime.c                                                      //
+// Purpose:                                                                   //
+//    Test that the routines intended for real-time use allocate no memory    //
+//    and evaluate the right hand side or the integrand a bounded number of   //
+//    times per call:  Gragg_Bulirsch_Stoer_Fixed_Depth in the file           //
+//    bulirsch_stoer.c, Simpson_Simpson_Adaptive_Fixed in the file            //
+//    simpson_simpson.c, Adams_12_Steps in the file adams_12_steps.c with     //
+//    tolerance = 0, and single steps of Runge_Kutta_Gill and                 //
+//    Runge_Kutta_Verner.                                                     //
+//                                                                            //
+// The program is linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc  //
+// so that every allocation by the routines is counted.  The differential     //
+// equation is y' = xy, y(0) = 1, whose solution is exp(x^2/2), and the       //
+// integrands 1/(1+x^2), x^2 and x^5 on [0,1], whose integrals are pi/4, 1/3  //
+// and 1/6.  The program prints each check and returns the number of checks   //
+// which failed.                                                              //
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+int Gragg_Bulirsch_Stoer_Fixed_Depth( double (*f)(double, double), double y0,
+                              double *y1, double x, double h, int depth,
+                                  int rational_extrapolate, double *error );
+double Simpson_Simpson_Adaptive(double a, double b, double tolerance,
+                              double (*f)(double), double min_h, int *err);
+double Simpson_Simpson_Adaptive_Fixed(double a, double b, double tolerance,
+                         double (*f)(double), double stack[], int max_depth,
+                                           int max_evaluations, int *err);
+int Adams_12_Steps( double (*f)(double, double), double y[], double x0,
+                  double h, double f_history[], double *y_bashforth,
+                  double tolerance, int iterations );
+void Adams_12_Build_History(double (*f)(double,double), double f_history[],
+                                              double y[], double x, double h);
+double Runge_Kutta_Gill( double (*f)(double, double), double y0, double x0,
+                                             double h, int number_of_steps );
+double Runge_Kutta_Verner( double (*f)(double, double), double y0, double x0,
+                                             double h, int number_of_steps );
+
+void *__real_malloc( size_t size );
+void *__real_calloc( size_t m, size_t size );
+void *__real_realloc( void *p, size_t size );
+
+static int allocations = 0;
+static int calls = 0;
+static int failures = 0;
+
+void *__wrap_malloc( size_t size ) {
+   allocations++;
+   return __real_malloc( size );
+}
+void *__wrap_calloc( size_t m, size_t size ) {
+   allocations++;
+   return __real_calloc( m, size );
+}
+void *__wrap_realloc( void *p, size_t size ) {
+   allocations++;
+   return __real_realloc( p, size );
+}
+
+// y' = f(x,y) = xy, y(0) = 1
+static double f(double x, double y) { calls++; return x*y; }
+
+// The actual solution
+static double If(double x) { return exp(0.5*x*x); }
+
+static double q(double x) { calls++; return 1.0 / (1.0 + x * x); }
+static double p2(double x) { calls++; return x * x; }
+static double p5(double x) { calls++; return x * x * x * x * x; }
+
+static void Check( int passed, const char *what ) {
+   printf("%s  %s\n", passed ? "pass" : "FAIL", what);
+   if (!passed) failures++;
+}
+
+static void Test_Bulirsch_Stoer( void ) {
+   static const int expected[] = { 3, 8, 15, 24, 37, 54, 79, 112, 161, 226,
+                                                                 323, 452 };
+   double y1, error;
+   char line[100];
+   int depth, rational, err, ok;
+
+   for (rational = 0; rational <= 1; rational++) {
+      ok = 1;
+      for (depth = 1; depth <= 12; depth++) {
+         calls = allocations = 0;
+         err = Gragg_Bulirsch_Stoer_Fixed_Depth( f, If(0.5), &y1, 0.5, 0.1,
+                                               depth, rational, &error );
+         if (err != 0 || calls > expected[depth - 1] || allocations != 0)
+            ok = 0;
+         if (depth <= 6 && calls != expected[depth - 1]) ok = 0;
+      }
+      sprintf(line, "Gragg_Bulirsch_Stoer_Fixed_Depth %s: no allocation, "
+                              "at most 3, 8, ..., 452 evaluations",
+                              rational ? "rational" : "polynomial");
+      Check( ok, line );
+      Gragg_Bulirsch_Stoer_Fixed_Depth( f, If(0.5), &y1, 0.5, 0.1, 6,
+                                                          rational, &error );
+      sprintf(line, "Gragg_Bulirsch_Stoer_Fixed_Depth %s: depth 6 error "
+            "%.1le", rational ? "rational" : "polynomial", y1 - If(0.6));
+      Check( fabs(y1 - If(0.6)) < 1.e-12, line );
+   }
+   err = Gragg_Bulirsch_Stoer_Fixed_Depth( f, 1.0, &y1, 0.0, 0.1, 13, 0,
+                                                                     NULL );
+   Check( err == -3, "Gragg_Bulirsch_Stoer_Fixed_Depth: depth 13 rejected" );
+}
+
+static void Test_Simpson( void ) {
+   double stack[4 * 20];
+   double integral;
+   char line[100];
+   int err, budget, needed, ok;
+
+   calls = allocations = 0;
+   integral = Simpson_Simpson_Adaptive( 0.0, 1.0, 1.e-10, q, 1.e-6, &err );
+   printf("info  Simpson_Simpson_Adaptive: %d evaluations, %d allocations\n",
+                                                         calls, allocations);
+
+   calls = allocations = 0;
+   integral = Simpson_Simpson_Adaptive_Fixed( 0.0, 1.0, 1.e-10, q, stack, 20,
+                                                            1001, &err );
+   sprintf(line, "Simpson_Simpson_Adaptive_Fixed: %d evaluations, error "
+                                    "%.1le", calls, integral - M_PI / 4.0);
+   Check( err == 0 && allocations == 0 && calls <= 1001
+                     && fabs(integral - M_PI / 4.0) < 1.e-10, line );
+   ok = 1;
+   for (budget = 5; budget <= 101; budget += 4) {
+      calls = allocations = 0;
+      integral = Simpson_Simpson_Adaptive_Fixed( 0.0, 1.0, 1.e-14, q, stack,
+                                                       20, budget, &err );
+      if (err != -1 || allocations != 0 || calls > budget
+                            || fabs(integral - M_PI / 4.0) > 1.e-2) ok = 0;
+   }
+   Check( ok, "Simpson_Simpson_Adaptive_Fixed: budgets of 5 to 101 "
+                                                     "evaluations respected" );
+
+      // With a budget of exactly the number of evaluations needed the  //
+      // result is the same as with an unlimited budget.                 //
+
+   calls = 0;
+   Simpson_Simpson_Adaptive_Fixed( 0.0, 1.0, 1.e-6, p5, stack, 20, 100000,
+                                                                     &err );
+   needed = calls;
+   calls = 0;
+   integral = Simpson_Simpson_Adaptive_Fixed( 0.0, 1.0, 1.e-6, p5, stack, 20,
+                                                            needed, &err );
+   sprintf(line, "Simpson_Simpson_Adaptive_Fixed: x^5 within a budget of "
+                                      "exactly %d evaluations", needed);
+   Check( err == 0 && calls == needed
+                      && fabs(integral - 1.0 / 6.0) < 1.e-6, line );
+   integral = Simpson_Simpson_Adaptive_Fixed( 0.0, 1.0, 1.e-6, p5, stack, 20,
+                                                        needed - 1, &err );
+   Check( err == -1, "Simpson_Simpson_Adaptive_Fixed: x^5 within one "
+                                                "evaluation less rejected" );
+   calls = 0;
+   integral = Simpson_Simpson_Adaptive_Fixed( 0.0, 1.0, 1.e-10, p2, stack, 20,
+                                                                 5, &err );
+   Check( err == 0 && calls == 5 && fabs(integral - 1.0 / 3.0) < 1.e-15,
+             "Simpson_Simpson_Adaptive_Fixed: x^2 within a budget of 5" );
+   calls = 0;
+   integral = Simpson_Simpson_Adaptive_Fixed( 0.0, 1.0, 1.e-14, q, stack, 3,
+                                                          100000, &err );
+   sprintf(line, "Simpson_Simpson_Adaptive_Fixed: depth 3, %d evaluations",
+                                                                     calls);
+   Check( err == -1 && calls == 33 && fabs(integral - M_PI / 4.0) < 1.e-6,
+                                                                     line );
+}
+
+static void Test_Adams( void ) {
+   double f_history[12], y_start[12], y[2];
+   double x, yb, h = 1.0 / 128.0;
+   int i, k, ok = 1;
+
+   for (i = 0; i < 12; i++) y_start[i] = If(i * h);
+   Adams_12_Build_History( f, f_history, y_start, 0.0, h );
+   x = 11.0 * h;
+   y[0] = y_start[11];
+   for (i = 0; i < 64; i++) {
+      calls = allocations = 0;
+      k = Adams_12_Steps( f, y, x, h, f_history, &yb, 0.0, 2 );
+      if (k != 3 || calls != 3 || allocations != 0) ok = 0;
+      y[0] = y[1];
+      x += h;
+   }
+   Check( ok && fabs(y[0] - If(x)) < 1.e-12,
+       "Adams_12_Steps: tolerance 0, 2 corrections, 3 evaluations, returns 3" );
+}
+
+static void Test_Runge_Kutta( void ) {
+   int i, gill = 0, verner = 0, ok = 1;
+
+   for (i = 0; i < 8; i++) {
+      calls = allocations = 0;
+      Runge_Kutta_Gill( f, 1.0, 0.1 * i, 0.1, 1 );
+      if (i == 0) gill = calls;
+      if (calls != gill || allocations != 0) ok = 0;
+      calls = 0;
+      Runge_Kutta_Verner( f, 1.0, 0.1 * i, 0.1, 1 );
+      if (i == 0) verner = calls;
+      if (calls != verner || allocations != 0) ok = 0;
+   }
+   printf("info  Runge_Kutta_Gill %d, Runge_Kutta_Verner %d evaluations\n",
+                                                              gill, verner);
+   Check( ok, "Runge_Kutta_Gill, Runge_Kutta_Verner: single steps" );
+}
+
+int main()
+{
+   Test_Bulirsch_Stoer();
+   Test_Simpson();
+   Test_Adams();
+   Test_Runge_Kutta();
+   printf("%d failures\n", failures);
+   return failures;
+}
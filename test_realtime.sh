@@ -0,0 +1,39 @@
+#  Test the routines for real-time use in the files bulirsch_stoer.c,
+#  simpson_simpson.c and adams_12_steps.c for allocations and bounded
+#  numbers of function evaluations.
+#
+#  Dependent on: bulirsch_stoer.c, simpson_simpson.c, adams_12_steps.c,
+#                runge_kutta_gill.c, runge_kutta_verner.c,
+#                weighted_rms_norm.c, step_profile_cache.c,
+#                step_size_controller.c, richardson_adaptive.c,
+#                vector_kernels.c
+#
+#  After downloading change permissions: chmod 744 test_realtime.sh
+#  Execute as ./test_realtime.sh (unless your profile has a PATH set to
+#                                 this directory)
+#
+#  The allocations are counted by wrapping malloc, calloc and realloc with
+#  the GNU linker.
+#
+# Change! if the files are in a different directory.
+gcc -c -o x1.o bulirsch_stoer.c
+gcc -c -o x2.o simpson_simpson.c
+gcc -c -o x3.o adams_12_steps.c
+gcc -c -o x4.o runge_kutta_gill.c
+gcc -c -o x5.o runge_kutta_verner.c
+gcc -c -o x6.o weighted_rms_norm.c
+gcc -c -o x7.o step_profile_cache.c
+gcc -c -o x8.o step_size_controller.c
+gcc -c -o x9.o richardson_adaptive.c
+gcc -c -o x10.o vector_kernels.c
+
+# Change! if test_realtime.c is in a different directory.
+gcc -o rtvers test_realtime.c x1.o x2.o x3.o x4.o x5.o x6.o x7.o x8.o x9.o \
+      x10.o -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc -lm
+
+# Change! if you profile has a PATH set to this directory.
+./rtvers
+
+# Delete temporary files.
+rm rtvers
+rm x1.o x2.o x3.o x4.o x5.o x6.o x7.o x8.o x9.o x10.o
@@ -0,0 +1,136 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: test_runge_kutta_2nd_order.c                                         //
+// Purpose:                                                                   //
+//    Test Runge_Kutta_2nd_Order_Embedded_System in the file                  //
+//    runge_kutta_2nd_order.c.                                                //
+//                                                                            //
+// The special equations are those of the Kepler problem                      //
+//       y'' = -y / |y|^3,  y(0) = (1-e, 0),  y'(0) = (0, sqrt((1+e)/(1-e)))  //
+// with eccentricity e = 0.5, whose solution is given by Kepler's equation.   //
+// First the local error of a single step of the 6(4) pair is compared for    //
+// the step sizes h and h/2, the ratio should be near 2^7 = 128.  Then the    //
+// problem is integrated over two periods for tolerances from 1.e-6 to        //
+// 1.e-12, once as a special equation and once as a general equation, which   //
+// uses the pair induced by Dormand-Prince 5(4).  The 6(4) pair should take   //
+// fewer evaluations for a smaller error.  Finally the general pair is        //
+// tested on the damped oscillator y'' = -y - 0.1 y', y(0) = 1, y'(0) = 0.    //
+// The program prints each check and returns the number of checks which       //
+// failed.                                                                    //
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <math.h>
+
+struct Step_Controller;
+int Runge_Kutta_2nd_Order_Embedded_System(
+         void (*f)(double, double[], double[], double[]), double y[],
+         double yp[], int n, double x0, double x1, double *h, double atol[],
+         double rtol[], int special, struct Step_Controller *controller,
+                                                         int *evaluations );
+
+static const double e = 0.5;
+static int failures = 0;
+
+static void Kepler(double x, double y[], double yp[], double ypp[]) {
+   double r = sqrt(y[0] * y[0] + y[1] * y[1]);
+   double r3 = r * r * r;
+
+   (void) x;
+   (void) yp;
+   ypp[0] = -y[0] / r3;
+   ypp[1] = -y[1] / r3;
+}
+
+static void Damped(double x, double y[], double yp[], double ypp[]) {
+   (void) x;
+   ypp[0] = -y[0] - 0.1 * yp[0];
+}
+
+// The solution of the Kepler problem at x.
+
+static void Kepler_Solution(double x, double y[], double yp[]) {
+   double E = x, w = sqrt(1.0 - e * e);
+   int i;
+
+   for (i = 0; i < 50; i++) E -= (E - e * sin(E) - x) / (1.0 - e * cos(E));
+   y[0] = cos(E) - e;
+   y[1] = w * sin(E);
+   yp[0] = -sin(E) / (1.0 - e * cos(E));
+   yp[1] = w * cos(E) / (1.0 - e * cos(E));
+}
+
+static void Check( int passed, const char *what ) {
+   printf("%s  %s\n", passed ? "pass" : "FAIL", what);
+   if (!passed) failures++;
+}
+
+// The error of (y,y') after a single step of size h from x = 0.
+
+static double Local_Error( double h ) {
+   double y[2], yp[2], ye[2], ype[2], atol[4], rtol[4];
+   double hh = h;
+   int i;
+
+   for (i = 0; i < 4; i++) { atol[i] = 1.e10; rtol[i] = 0.0; }
+   Kepler_Solution( 0.0, y, yp );
+   Runge_Kutta_2nd_Order_Embedded_System( Kepler, y, yp, 2, 0.0, h, &hh,
+                                                 atol, rtol, 1, NULL, NULL );
+   Kepler_Solution( h, ye, ype );
+   return fmax( fmax(fabs(y[0] - ye[0]), fabs(y[1] - ye[1])),
+                fmax(fabs(yp[0] - ype[0]), fabs(yp[1] - ype[1])) );
+}
+
+// Integrate the Kepler problem over two periods, return the maximum error
+// and set *evaluations.
+
+static double Orbit( double tolerance, int special, int *evaluations ) {
+   double y[2], yp[2], ye[2], ype[2], atol[4], rtol[4];
+   double h = 0.0, x1 = 4.0 * M_PI;
+   int i, err;
+
+   for (i = 0; i < 4; i++) { atol[i] = tolerance; rtol[i] = tolerance; }
+   Kepler_Solution( 0.0, y, yp );
+   err = Runge_Kutta_2nd_Order_Embedded_System( Kepler, y, yp, 2, 0.0, x1,
+                            &h, atol, rtol, special, NULL, evaluations );
+   if (err != 0) return 1.0;
+   Kepler_Solution( x1, ye, ype );
+   return fmax( fmax(fabs(y[0] - ye[0]), fabs(y[1] - ye[1])),
+                fmax(fabs(yp[0] - ype[0]), fabs(yp[1] - ype[1])) );
+}
+
+int main()
+{
+   double e1, e2, error6, error5, tolerance, y, yp, h, atol[2], rtol[2];
+   double w = sqrt(1.0 - 0.0025), exact;
+   int evaluations6, evaluations5, err;
+   char line[100];
+
+   e1 = Local_Error( 0.05 );
+   e2 = Local_Error( 0.025 );
+   sprintf(line, "6(4) pair: local errors %.2le, %.2le, ratio %.1lf",
+                                                           e1, e2, e1 / e2);
+   Check( e1 / e2 > 100.0 && e1 / e2 < 160.0, line );
+
+   printf("  tolerance   error 6(4)  evaluations   error 5(4)  evaluations\n");
+   for (tolerance = 1.e-6; tolerance > 1.e-13; tolerance *= 0.01) {
+      error6 = Orbit( tolerance, 1, &evaluations6 );
+      error5 = Orbit( tolerance, 0, &evaluations5 );
+      printf("  %9.1le  %11.2le  %11d  %11.2le  %11d\n", tolerance, error6,
+                                        evaluations6, error5, evaluations5);
+      sprintf(line, "Kepler problem, tolerance %.0le", tolerance);
+      Check( error6 < 10.0 * tolerance && error5 < 1000.0 * tolerance
+                                 && evaluations6 < evaluations5, line );
+   }
+
+   y = 1.0;
+   yp = 0.0;
+   h = 0.0;
+   atol[0] = atol[1] = rtol[0] = rtol[1] = 1.e-10;
+   err = Runge_Kutta_2nd_Order_Embedded_System( Damped, &y, &yp, 1, 0.0,
+                                   20.0, &h, atol, rtol, 0, NULL, NULL );
+   exact = exp(-1.0) * (cos(20.0 * w) + 0.05 / w * sin(20.0 * w));
+   sprintf(line, "damped oscillator, tolerance 1e-10, error %.2le",
+                                                                y - exact);
+   Check( err == 0 && fabs(y - exact) < 1.e-8, line );
+   printf("%d failures\n", failures);
+   return failures;
+}
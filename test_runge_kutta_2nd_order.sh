@@ -0,0 +1,28 @@
+#  Test the embedded Runge-Kutta-Nystrom pairs in the file
+#  runge_kutta_2nd_order.c
+#
+#  Dependent on: weighted_rms_norm.c, step_size_controller.c
+#
+#  After downloading change permissions:
+#                                 chmod 744 test_runge_kutta_2nd_order.sh
+#  Execute as ./test_runge_kutta_2nd_order.sh (unless your profile has a PATH
+#                                             set to this directory)
+#
+#
+# Change! if runge_kutta_2nd_order.c is in a different directory.
+gcc -c -o x1.o runge_kutta_2nd_order.c
+
+# Change! if weighted_rms_norm.c or step_size_controller.c are in a
+# different directory.
+gcc -c -o x2.o weighted_rms_norm.c
+gcc -c -o x3.o step_size_controller.c
+
+# Change! if test_runge_kutta_2nd_order.c is in a different directory.
+gcc -o rknvers test_runge_kutta_2nd_order.c x1.o x2.o x3.o -lm
+
+# Change! if you profile has a PATH set to this directory.
+./rknvers
+
+# Delete temporary files.
+rm rknvers
+rm x1.o x2.o x3.o
@@ -0,0 +1,134 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: test_step_size_controller.c                                          //
+// Purpose:                                                                   //
+//    Test the step size controllers in the file step_size_controller.c.      //
+//                                                                            //
+// The elementary controller must propose h * 0.9 * e^(-1/k).  The            //
+// predictive controller is fed a sequence of 1000 pseudo-random error norms  //
+// between 1.e-12 and 3, and every proposed ratio must lie within the limits  //
+// [0.5, 2] set by Step_Controller_Set_Limits(), a retry must not exceed the  //
+// safety factor and the step after a rejection must not grow.  Then the van  //
+// der Pol equation y'' = mu (1 - y^2) y' - y, mu = 5, y(0) = 2, y'(0) = 0,   //
+// is integrated from 0 to 20 with tolerances 1.e-8 by                        //
+// Gragg_Bulirsch_Stoer_System_Integrate() with each controller: the PI and   //
+// PID controllers must reject fewer steps than the I controller, and all     //
+// solutions must agree with that of the integrator's own step size rule.     //
+// The program prints each check and returns the number of checks which       //
+// failed.                                                                    //
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <math.h>
+
+struct Step_Controller;
+struct Step_Controller* Step_Controller_Create( int type, double order );
+void Step_Controller_Set_Limits( struct Step_Controller *c, double safety,
+                                         double min_ratio, double max_ratio );
+double Step_Controller_Next( struct Step_Controller *c, double h,
+                                                 double error, int *accept );
+void Step_Controller_Free( struct Step_Controller *c );
+int Gragg_Bulirsch_Stoer_System_Integrate(
+     void (*f)(double, double[], double[]), double y[], int n, double x0,
+     double x1, double h, double atol[], double rtol[],
+                        int rational_extrapolate, int family,
+                        struct Step_Controller *controller, int *rejections );
+
+static int failures = 0;
+static int evaluations;
+
+static void van_der_Pol(double x, double y[], double dy[]) {
+   (void) x;
+   evaluations++;
+   dy[0] = y[1];
+   dy[1] = 5.0 * (1.0 - y[0] * y[0]) * y[1] - y[0];
+}
+
+static void Check( int passed, const char *what ) {
+   printf("%s  %s\n", passed ? "pass" : "FAIL", what);
+   if (!passed) failures++;
+}
+
+// Integrate the van der Pol equation with the controller of the given type,
+// or with none if type < 0, set y1 to y(20) and return the number of rejected
+// steps, or -1 on failure.
+
+static int Van_der_Pol( int type, double *y1 ) {
+   struct Step_Controller *c = NULL;
+   double y[2] = { 2.0, 0.0 };
+   double atol[2] = { 1.e-8, 1.e-8 }, rtol[2] = { 1.e-8, 1.e-8 };
+   int err, rejections;
+
+   if (type >= 0 && (c = Step_Controller_Create( type, 5.0 )) == NULL)
+      return -1;
+   evaluations = 0;
+   err = Gragg_Bulirsch_Stoer_System_Integrate( van_der_Pol, y, 2, 0.0, 20.0,
+                                  0.01, atol, rtol, 0, -1, c, &rejections );
+   if (c != NULL) Step_Controller_Free( c );
+   *y1 = y[0];
+   return (err == 0) ? rejections : -1;
+}
+
+int main()
+{
+   const char *name[] = { "I", "PI", "PID", "predictive" };
+   struct Step_Controller *c;
+   double e, h, h_next, ratio, low = 1.0, high = 1.0, y, y_ref, diff;
+   unsigned seed = 12345;
+   int i, accept, previous_accept = 1, retry_ok = 1, growth_ok = 1;
+   int rejections[4];
+   char line[100];
+
+   c = Step_Controller_Create( 0, 5.0 );
+   h_next = (c != NULL) ? Step_Controller_Next( c, 0.1, 1.e-2, &accept ) : 0.0;
+   e = 0.1 * 0.9 * pow(1.e-2, -0.2);
+   sprintf(line, "I controller: next step %.15le, expected %.15le", h_next, e);
+   Check( c != NULL && accept && fabs(h_next - e) < 1.e-15 * e, line );
+   Step_Controller_Free( c );
+
+          // A linear congruential sequence of log10(e) in [-12, 0.5). //
+
+   c = Step_Controller_Create( 3, 5.0 );
+   if (c != NULL) {
+      Step_Controller_Set_Limits( c, 0.9, 0.5, 2.0 );
+      h = 0.1;
+      for (i = 0; i < 1000; i++) {
+         seed = 1103515245u * seed + 12345u;
+         e = pow(10.0, -12.0 + 12.5 * (double) (seed >> 8) / 16777216.0);
+         h_next = Step_Controller_Next( c, h, e, &accept );
+         ratio = h_next / h;
+         if (ratio < low) low = ratio;
+         if (ratio > high) high = ratio;
+         if (!accept && ratio > 0.9 * (1.0 + 1.e-15)) retry_ok = 0;
+         if (accept && !previous_accept && ratio > 1.0 + 1.e-15) growth_ok = 0;
+         previous_accept = accept;
+         h = h_next;
+      }
+      Step_Controller_Free( c );
+   }
+   sprintf(line, "predictive controller: ratios in [%.4lf, %.4lf]", low, high);
+   Check( c != NULL && low >= 0.5 * (1.0 - 1.e-15)
+                                   && high <= 2.0 * (1.0 + 1.e-15), line );
+   Check( c != NULL && retry_ok,
+                  "predictive controller: retries at most the safety factor" );
+   Check( c != NULL && growth_ok,
+                  "predictive controller: no growth after a rejected step" );
+
+   i = Van_der_Pol( -1, &y_ref );
+   sprintf(line, "van der Pol, no controller: %d evaluations, %d rejections,"
+                               " y(20) = %.10lf", evaluations, i, y_ref);
+   Check( i >= 0, line );
+   for (i = 0; i < 4; i++) {
+      rejections[i] = Van_der_Pol( i, &y );
+      diff = fabs(y - y_ref);
+      sprintf(line, "van der Pol, %s: %d evaluations, %d rejections, "
+                      "difference %.2le", name[i], evaluations, rejections[i],
+                                                                        diff);
+      Check( rejections[i] >= 0 && diff < 1.e-5, line );
+   }
+   Check( rejections[1] < rejections[0],
+                                    "van der Pol: PI rejects fewer than I" );
+   Check( rejections[2] < rejections[0],
+                                   "van der Pol: PID rejects fewer than I" );
+
+   printf("%d failures\n", failures);
+   return failures;
+}
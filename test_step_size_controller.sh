@@ -0,0 +1,27 @@
+#  Test the step size controllers in the file step_size_controller.c
+#
+#  Dependent on: bulirsch_stoer.c, weighted_rms_norm.c, step_profile_cache.c
+#
+#  After downloading change permissions: chmod 744 test_step_size_controller.sh
+#  Execute as ./test_step_size_controller.sh (unless your profile has a PATH
+#                                             set to this directory)
+#
+#
+# Change! if step_size_controller.c is in a different directory.
+gcc -c -o x1.o step_size_controller.c
+
+# Change! if bulirsch_stoer.c, weighted_rms_norm.c or step_profile_cache.c
+# are in a different directory.
+gcc -c -o x2.o bulirsch_stoer.c
+gcc -c -o x3.o weighted_rms_norm.c
+gcc -c -o x4.o step_profile_cache.c
+
+# Change! if test_step_size_controller.c is in a different directory.
+gcc -o scvers test_step_size_controller.c x1.o x2.o x3.o x4.o -lm
+
+# Change! if you profile has a PATH set to this directory.
+./scvers
+
+# Delete temporary files.
+rm scvers
+rm x1.o x2.o x3.o x4.o
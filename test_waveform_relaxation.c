@@ -0,0 +1,136 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: test_waveform_relaxation.c                                           //
+// Purpose:                                                                   //
+//    Test the waveform relaxation in the file waveform_relaxation.c against  //
+//    a monolithic integration of the whole system.                           //
+//                                                                            //
+// Two oscillators coupled by a spring,                                       //
+//                                                                            //
+//            u'' = -u + 0.5 (v - u),   v'' = -2 v + 0.5 (u - v),             //
+//                                                                            //
+// u(0) = 1, u'(0) = 0, v(0) = 0, v'(0) = 1, are integrated from 0 to 2 as    //
+// two subsystems over 20 windows of length 0.1 by the Jacobi and the         //
+// Gauss-Seidel schemes, each subsystem by Runge_Kutta_Verner_System() with   //
+// 20 steps per window, both to a tolerance of 1.e-13 and with 12 pipelined   //
+// sweeps.  The solutions at x = 2 must agree with that of                    //
+// Runge_Kutta_Verner_System() applied to the whole system with the same step //
+// size.  With 3 pipelined sweeps the Gauss-Seidel scheme must be closer to   //
+// it than the Jacobi scheme, and a tolerance with a single sweep must be     //
+// rejected.  The program prints each check and returns the number of         //
+// checks which failed.                                                       //
+////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <math.h>
+
+struct Waveform_Relaxation;
+struct Waveform_Relaxation* Waveform_Relaxation_Create( int subsystems,
+                                             int n[], int scheme, int *err );
+int Waveform_Relaxation_Set_Subsystem( struct Waveform_Relaxation *w, int k,
+                         int (*step)(double, double, double[], int, void*),
+                                               void *context, int steps );
+void Waveform_Relaxation_Value( int k, double x, double v[] );
+int Waveform_Relaxation_Integrate( struct Waveform_Relaxation *w,
+                   double y[], double x0, double h, int number_of_windows,
+                                           int sweeps, double tolerance );
+void Waveform_Relaxation_Free( struct Waveform_Relaxation *w );
+void Runge_Kutta_Verner_System( void (*f)(double, double[], double[]),
+                 double y[], int n, double x0, double h, int number_of_steps,
+                                                             double work[] );
+void Thread_Pool_Shutdown( void );
+
+static int failures = 0;
+
+static void Coupled(double x, double y[], double dy[]) {
+   (void) x;
+   dy[0] = y[1];
+   dy[1] = -y[0] + 0.5 * (y[2] - y[0]);
+   dy[2] = y[3];
+   dy[3] = -2.0 * y[2] + 0.5 * (y[0] - y[2]);
+}
+
+static void f0(double x, double y[], double dy[]) {
+   double v[2];
+
+   Waveform_Relaxation_Value( 1, x, v );
+   dy[0] = y[1];
+   dy[1] = -y[0] + 0.5 * (v[0] - y[0]);
+}
+
+static void f1(double x, double y[], double dy[]) {
+   double u[2];
+
+   Waveform_Relaxation_Value( 0, x, u );
+   dy[0] = y[1];
+   dy[1] = -2.0 * y[0] + 0.5 * (u[0] - y[0]);
+}
+
+static int Step(double x, double h, double y[], int n, void *f) {
+   double work[16];
+
+   Runge_Kutta_Verner_System( (void (*)(double, double[], double[])) f, y,
+                                                          n, x, h, 1, work );
+   return 0;
+}
+
+static void Check( int passed, const char *what ) {
+   printf("%s  %s\n", passed ? "pass" : "FAIL", what);
+   if (!passed) failures++;
+}
+
+// Integrate the coupled oscillators by the scheme with the given sweeps and
+// tolerance, set *err to the value returned and return the largest
+// difference at x = 2 from the monolithic solution y_ref[].
+
+static double Relaxation( int scheme, int sweeps, double tolerance,
+                                             double y_ref[], int *err ) {
+   struct Waveform_Relaxation *w;
+   double y[4] = { 1.0, 0.0, 0.0, 1.0 };
+   double difference = 0.0;
+   int n[2] = { 2, 2 };
+   int i;
+
+   w = Waveform_Relaxation_Create( 2, n, scheme, err );
+   if (w == NULL) return 1.e10;
+   Waveform_Relaxation_Set_Subsystem( w, 0, Step, (void*) f0, 20 );
+   Waveform_Relaxation_Set_Subsystem( w, 1, Step, (void*) f1, 20 );
+   *err = Waveform_Relaxation_Integrate( w, y, 0.0, 0.1, 20, sweeps,
+                                                                 tolerance );
+   Waveform_Relaxation_Free( w );
+   for (i = 0; i < 4; i++)
+      difference = fmax(difference, fabs(y[i] - y_ref[i]));
+   return difference;
+}
+
+int main()
+{
+   const char *name[] = { "Jacobi", "Gauss-Seidel" };
+   double y_ref[4] = { 1.0, 0.0, 0.0, 1.0 };
+   double work[32];
+   double difference, d3[2];
+   int scheme, err;
+   char line[100];
+
+   Runge_Kutta_Verner_System( Coupled, y_ref, 4, 0.0, 0.005, 400, work );
+
+   for (scheme = 0; scheme < 2; scheme++) {
+      difference = Relaxation( scheme, 30, 1.e-13, y_ref, &err );
+      sprintf(line, "%s, tolerance 1.e-13: difference from monolithic %.2le",
+                                                    name[scheme], difference);
+      Check( err == 0 && difference < 1.e-9, line );
+      difference = Relaxation( scheme, 12, 0.0, y_ref, &err );
+      sprintf(line, "%s, 12 pipelined sweeps: difference from monolithic "
+                                            "%.2le", name[scheme], difference);
+      Check( err == 0 && difference < 1.e-9, line );
+      d3[scheme] = Relaxation( scheme, 3, 0.0, y_ref, &err );
+   }
+   sprintf(line, "3 pipelined sweeps: Jacobi %.2le, Gauss-Seidel %.2le",
+                                                           d3[0], d3[1]);
+   Check( d3[1] < d3[0], line );
+
+   Relaxation( 0, 1, 1.e-13, y_ref, &err );
+   Check( err == -3, "a tolerance with a single sweep is rejected" );
+
+   Thread_Pool_Shutdown();
+   printf("%d failures\n", failures);
+   return failures;
+}
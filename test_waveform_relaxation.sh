@@ -0,0 +1,33 @@
+#  Test the waveform relaxation in the file waveform_relaxation.c
+#
+#  Dependent on: thread_pool.c, runge_kutta_verner.c, vector_kernels.c,
+#                richardson_adaptive.c, step_size_controller.c
+#
+#  After downloading change permissions:
+#                                 chmod 744 test_waveform_relaxation.sh
+#  Execute as ./test_waveform_relaxation.sh (unless your profile has a PATH
+#                                           set to this directory)
+#
+#
+# Change! if waveform_relaxation.c is in a different directory.
+gcc -c -pthread -o x1.o waveform_relaxation.c
+
+# Change! if thread_pool.c, runge_kutta_verner.c, vector_kernels.c,
+# richardson_adaptive.c or step_size_controller.c are in a different
+# directory.
+gcc -c -pthread -o x2.o thread_pool.c
+gcc -c -o x3.o runge_kutta_verner.c
+gcc -c -o x4.o vector_kernels.c
+gcc -c -o x5.o richardson_adaptive.c
+gcc -c -o x6.o step_size_controller.c
+
+# Change! if test_waveform_relaxation.c is in a different directory.
+gcc -pthread -o wrvers test_waveform_relaxation.c x1.o x2.o x3.o x4.o x5.o \
+                                                                   x6.o -lm
+
+# Change! if you profile has a PATH set to this directory.
+./wrvers
+
+# Delete temporary files.
+rm wrvers
+rm x1.o x2.o x3.o x4.o x5.o x6.o
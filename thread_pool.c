@@ -0,0 +1,620 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: thread_pool.c                                                        //
+// Routines:                                                                  //
+//    Thread_Pool_Init                                                        //
+//    Thread_Pool_Shutdown                                                    //
+//    Thread_Pool_Set_Executor                                                //
+//    Thread_Pool_Concurrency                                                 //
+//    Thread_Pool_In_Parallel                                                 //
+//    Thread_Pool_Fork_Join                                                   //
+//    Thread_Pool_Parallel_For                                                //
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Description:                                                              //
+//     A single thread pool shared by all the parallel routines of the        //
+//     library, so that nested or concurrent parallel routines do not each    //
+//     start their own threads and oversubscribe the processors.              //
+//                                                                            //
+//     Every parallel operation is a job of m items, the tasks of             //
+//     Thread_Pool_Fork_Join() or the chunks of Thread_Pool_Parallel_For().   //
+//     The calling thread offers the job to up to m - 1 helpers and then      //
+//     works on the job itself.  Each participant claims the next unclaimed   //
+//     item with an atomic increment until none are left, so the caller       //
+//     never waits for a helper which has not started, and a helper which     //
+//     starts after the items are exhausted returns at once.  The job is      //
+//     reference counted so that it may outlive the call.                     //
+//                                                                            //
+//     The helpers are offered to the worker threads through work-stealing    //
+//     deques (Chase and Lev, "Dynamic circular work-stealing deque", SPAA    //
+//     2005, with the C11 memory orderings of Le, Pop, Cohen and Zappa        //
+//     Nardelli, PPoPP 2013).  A worker pushes and pops at the bottom of its  //
+//     own deque without locking, idle workers steal from the top of the      //
+//     deques of the others, and threads outside the pool push to a shared    //
+//     deque whose owner side is protected by a mutex.  Idle workers spin     //
+//     briefly and then sleep until new work is offered.  If compiled with    //
+//     _GNU_SOURCE on Linux the workers may be pinned to the cores 1, 2, ...  //
+//     in order.                                                              //
+//                                                                            //
+//     A task run by Thread_Pool_Fork_Join() may itself call                  //
+//     Thread_Pool_Fork_Join(), the nested tasks being stolen by idle         //
+//     workers.  Inside a body of Thread_Pool_Parallel_For(), or inside an    //
+//     OpenMP parallel region, Thread_Pool_Parallel_For() runs serially, and  //
+//     the OpenMP loops of vector_kernels.c, cumulative_quadrature.c,         //
+//     gauss_quadrature_rules.c and adams_20_steps.c test                     //
+//     Thread_Pool_In_Parallel() to run serially as well.                     //
+//                                                                            //
+//     Instead of the internal workers an application may supply its own      //
+//     executor by Thread_Pool_Set_Executor(); the helpers are then submitted //
+//     to it.  Since the caller always completes the items no helper has      //
+//     claimed, an executor which runs its tasks late, or serially, cannot    //
+//     cause a deadlock.                                                      //
+//                                                                            //
+//     Compile with -pthread.                                                 //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE                        // for pthread_attr_setaffinity_np()
+#endif
+#include <stdlib.h>                             // required for malloc()
+#include <stdatomic.h>                          // required for atomic_int
+#include <pthread.h>                            // required for pthread_create()
+#include <sched.h>                              // required for sched_yield()
+#include <unistd.h>                             // required for sysconf()
+#ifdef _OPENMP
+#include <omp.h>                              // required for omp_in_parallel()
+#endif
+
+#define MAX_POOL_THREADS 256
+#define DEQUE_CAPACITY 1024                     // a power of 2
+#define SPIN_ROUNDS 2048
+
+struct Pool_Job {
+   int m;                                       // the number of items
+   atomic_int next;                             // the next unclaimed item
+   atomic_int done;                             // the number of finished items
+   atomic_int references;
+   void (**task)(void*);                        // Thread_Pool_Fork_Join()
+   void **arg;
+   void (*body)(int, int, void*);               // Thread_Pool_Parallel_For()
+   void *body_arg;
+   int first;
+   int last;
+   int grain;
+};
+
+struct Deque {
+   atomic_long top;
+   atomic_long bottom;
+   struct Pool_Job * _Atomic buffer[DEQUE_CAPACITY];
+};
+
+static struct {
+   int workers;
+   atomic_int running;
+   atomic_int stop;
+   atomic_int sleepers;
+   atomic_uint epoch;
+   pthread_t thread[MAX_POOL_THREADS];
+   struct Deque *deque;                 // deque[workers] is the shared deque
+   pthread_mutex_t shared_lock;
+   pthread_mutex_t sleep_lock;
+   pthread_cond_t wake;
+   void (*submit)(void (*)(void*), void*, void*);
+   int executor_concurrency;
+   void *executor_context;
+} pool = { 0, 0, 0, 0, 0, {0}, NULL, PTHREAD_MUTEX_INITIALIZER,
+           PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, 0, NULL };
+
+static pthread_mutex_t init_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread int worker_id = -1;     // the index of a worker thread
+static __thread int region_depth = 0;   // > 0 inside Parallel_For bodies
+
+static void *Worker( void *p );
+static void Run_Job( struct Pool_Job *job );
+static void Release_Job( struct Pool_Job *job );
+static void Executor_Helper( void *p );
+static int Push( struct Deque *d, struct Pool_Job *job );
+static struct Pool_Job *Pop( struct Deque *d );
+static struct Pool_Job *Steal( struct Deque *d );
+static struct Pool_Job *Find_Work( int self, unsigned *seed );
+static void Offer( struct Pool_Job *job, int helpers );
+static void Run_Parallel( struct Pool_Job *job );
+static void Stop_Workers( int threads );
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Thread_Pool_Init( int threads, int pin )                              //
+//                                                                            //
+//  Description:                                                              //
+//     Starts the pool with 'threads' worker threads in addition to the       //
+//     calling threads, or with one less than the number of online            //
+//     processors if threads < 0.  If the pool is not started explicitly it   //
+//     is started with the default size by the first parallel call.           //
+//                                                                            //
+//  Arguments:                                                                //
+//     int threads  The number of worker threads, at most MAX_POOL_THREADS.   //
+//     int pin      If nonzero, worker i is pinned to core i + 1.             //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -1 if the pool is already running and -2 if memory or //
+//     threads could not be allocated.                                        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Thread_Pool_Init( int threads, int pin ) {
+
+   long cpus = sysconf( _SC_NPROCESSORS_ONLN );
+   pthread_attr_t attr;
+   pthread_attr_t *attributes;
+   int i, err;
+
+   pthread_mutex_lock( &init_lock );
+   if (pool.running) { pthread_mutex_unlock( &init_lock ); return -1; }
+   if (threads < 0) threads = (cpus > 1) ? (int) cpus - 1 : 0;
+   if (threads > MAX_POOL_THREADS) threads = MAX_POOL_THREADS;
+   pool.deque = (struct Deque*) calloc( threads + 1, sizeof(struct Deque) );
+   if (pool.deque == NULL) { pthread_mutex_unlock( &init_lock ); return -2; }
+   atomic_store( &pool.stop, 0 );
+   pool.workers = threads;
+   for (i = 0; i < threads; i++) {
+
+          // The affinity is set in the attributes, so that a pinned worker //
+          // never runs a job on another core.  Pinning is best effort: if  //
+          // the thread can not be created pinned it is created unpinned.   //
+
+      attributes = NULL;
+#if defined(__linux__) && defined(CPU_SET)
+      if (pin && cpus > 0 && pthread_attr_init( &attr ) == 0) {
+         cpu_set_t set;
+         CPU_ZERO( &set );
+         CPU_SET( (i + 1) % cpus, &set );
+         if ( pthread_attr_setaffinity_np( &attr, sizeof(set), &set ) == 0 )
+            attributes = &attr;
+         else pthread_attr_destroy( &attr );
+      }
+#endif
+      err = pthread_create( &pool.thread[i], attributes, Worker,
+                                                           (void*) (long) i );
+      if (attributes != NULL) {
+         pthread_attr_destroy( attributes );
+         if (err != 0) err = pthread_create( &pool.thread[i], NULL, Worker,
+                                                           (void*) (long) i );
+      }
+      if (err != 0) {
+         Stop_Workers( i );
+         pthread_mutex_unlock( &init_lock );
+         return -2;
+      }
+   }
+   pool.running = 1;
+   pthread_mutex_unlock( &init_lock );
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Thread_Pool_Shutdown( void )                                         //
+//                                                                            //
+//  Description:                                                              //
+//     Stops the worker threads and releases the pool.  No parallel call may  //
+//     be in progress.  Helpers still queued in the deques are released.      //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Thread_Pool_Shutdown( void ) {
+
+   pthread_mutex_lock( &init_lock );
+   if (pool.running) {
+      Stop_Workers( pool.workers );
+      pool.running = 0;
+   }
+   pthread_mutex_unlock( &init_lock );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static void Stop_Workers( int threads )                                   //
+//                                                                            //
+//  Description:                                                              //
+//     Stops and joins the first 'threads' workers, drops the references of   //
+//     the helpers left in the deques, whose items the callers have already   //
+//     completed, and releases the deques.                                    //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static void Stop_Workers( int threads ) {
+
+   struct Pool_Job *job;
+   int i;
+
+   atomic_store( &pool.stop, 1 );
+   pthread_mutex_lock( &pool.sleep_lock );
+   atomic_fetch_add( &pool.epoch, 1 );
+   pthread_cond_broadcast( &pool.wake );
+   pthread_mutex_unlock( &pool.sleep_lock );
+   for (i = 0; i < threads; i++) pthread_join( pool.thread[i], NULL );
+   for (i = 0; i <= pool.workers; i++)
+      while ( (job = Pop( &pool.deque[i] )) != NULL ) Release_Job( job );
+   free(pool.deque);
+   pool.deque = NULL;
+   pool.workers = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Thread_Pool_Set_Executor(                                            //
+//           void (*submit)(void (*task)(void*), void *arg, void *context),   //
+//                                          int concurrency, void *context )  //
+//                                                                            //
+//  Description:                                                              //
+//     Directs the helpers of subsequent parallel calls to the caller's       //
+//     executor: submit(task, arg, context) must arrange for task(arg) to be  //
+//     run once by some thread.  At most concurrency - 1 helpers are          //
+//     submitted per call.  If submit is NULL, the internal pool is used      //
+//     again.  Must not be called while a parallel call is in progress.       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Thread_Pool_Set_Executor(
+            void (*submit)(void (*task)(void*), void *arg, void *context),
+                                          int concurrency, void *context ) {
+
+   pool.submit = submit;
+   pool.executor_concurrency = (concurrency > 1) ? concurrency : 1;
+   pool.executor_context = context;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Thread_Pool_Concurrency( void )                                       //
+//                                                                            //
+//  Description:                                                              //
+//     Returns the number of threads which may work on a parallel call, the   //
+//     caller included, starting the pool if necessary.                       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Thread_Pool_Concurrency( void ) {
+
+   if (pool.submit != NULL) return pool.executor_concurrency;
+   if (!pool.running) Thread_Pool_Init( -1, 0 );
+   return pool.workers + 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Thread_Pool_In_Parallel( void )                                       //
+//                                                                            //
+//  Description:                                                              //
+//     Returns nonzero if called from a body of Thread_Pool_Parallel_For() or //
+//     from an active OpenMP parallel region, in which case parallel loops    //
+//     run serially.                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Thread_Pool_In_Parallel( void ) {
+
+#ifdef _OPENMP
+   if ( omp_in_parallel() ) return 1;
+#endif
+   return region_depth > 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Thread_Pool_Fork_Join( void (*task[])(void*), void *arg[], int m )    //
+//                                                                            //
+//  Description:                                                              //
+//     Runs task[i](arg[i]), i = 0,...,m-1, in parallel and returns when all  //
+//     have finished.                                                         //
+//                                                                            //
+//  Arguments:                                                                //
+//     void (*task[])(void*)  The tasks.                                      //
+//     void *arg[]            Their arguments.                                //
+//     int  m                 The number of tasks.                            //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if the tasks ran in parallel, 1 if they ran serially, in particular  //
+//     if memory could not be allocated.                                      //
+//                                                                            //
+//  Example:                                                                  //
+//     void (*task[2])(void*) = { Sort_Half, Sort_Half };                     //
+//     void *arg[2] = { &lower, &upper };                                     //
+//                                                                            //
+//     Thread_Pool_Fork_Join( task, arg, 2 );                                 //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Thread_Pool_Fork_Join( void (*task[])(void*), void *arg[], int m ) {
+
+   struct Pool_Job *job = NULL;
+   int i;
+
+   if (m > 1 && Thread_Pool_Concurrency() > 1)
+      job = (struct Pool_Job*) malloc( sizeof(struct Pool_Job) );
+   if (job == NULL) {
+      for (i = 0; i < m; i++) (*task[i])(arg[i]);
+      return 1;
+   }
+   job->m = m;
+   job->task = task;
+   job->arg = arg;
+   job->body = NULL;
+   Run_Parallel( job );
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Thread_Pool_Parallel_For( int first, int last, int grain,             //
+//                     void (*body)(int lo, int hi, void *arg), void *arg )   //
+//                                                                            //
+//  Description:                                                              //
+//     Divides the range first <= i < last into chunks of grain indices and   //
+//     calls body(lo, hi, arg) for each chunk lo <= i < hi, in parallel       //
+//     unless called from a parallel region.  Returns when all chunks have    //
+//     been processed.                                                        //
+//                                                                            //
+//  Arguments:                                                                //
+//     int first, last  The range of indices.                                 //
+//     int grain        The number of indices per chunk; if grain < 1 the     //
+//                      range is divided into 4 chunks per thread.            //
+//     void *body       The loop body.                                        //
+//     void *arg        Its argument.                                         //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if the chunks ran in parallel, 1 if they ran serially.               //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Thread_Pool_Parallel_For( int first, int last, int grain,
+                        void (*body)(int lo, int hi, void *arg), void *arg ) {
+
+   struct Pool_Job *job = NULL;
+   int threads, m;
+
+   if (last <= first) return 1;
+   if ( !Thread_Pool_In_Parallel() ) {
+      threads = Thread_Pool_Concurrency();
+      if (grain < 1) grain = (last - first + 4 * threads - 1) / (4 * threads);
+      if (grain < 1) grain = 1;
+      m = (last - first - 1) / grain + 1;
+      if (threads > 1 && m > 1)
+         job = (struct Pool_Job*) malloc( sizeof(struct Pool_Job) );
+   }
+   if (job == NULL) {
+      region_depth++;
+      (*body)(first, last, arg);
+      region_depth--;
+      return 1;
+   }
+   job->m = m;
+   job->body = body;
+   job->body_arg = arg;
+   job->first = first;
+   job->last = last;
+   job->grain = grain;
+   Run_Parallel( job );
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static void Run_Parallel( struct Pool_Job *job )                          //
+//                                                                            //
+//  Description:                                                              //
+//     Offers the job to the helpers, works on it and waits until all items   //
+//     are done, meanwhile running helpers from its own deque.                //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static void Run_Parallel( struct Pool_Job *job ) {
+
+   struct Pool_Job *other;
+   int helpers = Thread_Pool_Concurrency() - 1;
+
+   if (helpers > job->m - 1) helpers = job->m - 1;
+   atomic_init( &job->next, 0 );
+   atomic_init( &job->done, 0 );
+   atomic_init( &job->references, 1 );
+   Offer( job, helpers );
+   Run_Job( job );
+   while ( atomic_load_explicit( &job->done, memory_order_acquire ) < job->m ) {
+      if ( worker_id >= 0
+                   && (other = Pop( &pool.deque[worker_id] )) != NULL ) {
+         Run_Job( other );
+         Release_Job( other );
+      }
+      else sched_yield();
+   }
+   Release_Job( job );
+}
+
+
+static void Offer( struct Pool_Job *job, int helpers ) {
+
+   int i, full = 0;
+
+   if (helpers <= 0) return;
+   atomic_fetch_add( &job->references, helpers );
+   if (pool.submit != NULL) {
+      for (i = 0; i < helpers; i++)
+         (*pool.submit)( Executor_Helper, job, pool.executor_context );
+      return;
+   }
+   for (i = 0; i < helpers && !full; i++) {
+      if (worker_id >= 0) full = Push( &pool.deque[worker_id], job );
+      else {
+         pthread_mutex_lock( &pool.shared_lock );
+         full = Push( &pool.deque[pool.workers], job );
+         pthread_mutex_unlock( &pool.shared_lock );
+      }
+   }
+   if (full) atomic_fetch_sub( &job->references, helpers - i + 1 );
+
+            // Wake the sleeping workers.  A worker announces itself in  //
+            // sleepers before it checks the epoch under sleep_lock.     //
+
+   atomic_fetch_add( &pool.epoch, 1 );
+   if ( atomic_load( &pool.sleepers ) > 0 ) {
+      pthread_mutex_lock( &pool.sleep_lock );
+      pthread_cond_broadcast( &pool.wake );
+      pthread_mutex_unlock( &pool.sleep_lock );
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static void Run_Job( struct Pool_Job *job )                               //
+//                                                                            //
+//  Description:                                                              //
+//     Claims and runs items of the job until none are left.                  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static void Run_Job( struct Pool_Job *job ) {
+
+   int i, lo, hi;
+
+   while ( (i = atomic_fetch_add( &job->next, 1 )) < job->m ) {
+      if (job->body == NULL) (*job->task[i])(job->arg[i]);
+      else {
+         lo = job->first + i * job->grain;
+         hi = (job->last - lo > job->grain) ? lo + job->grain : job->last;
+         region_depth++;
+         (*job->body)(lo, hi, job->body_arg);
+         region_depth--;
+      }
+      atomic_fetch_add_explicit( &job->done, 1, memory_order_release );
+   }
+}
+
+
+static void Release_Job( struct Pool_Job *job ) {
+
+   if ( atomic_fetch_sub( &job->references, 1 ) == 1 ) free(job);
+}
+
+
+static void Executor_Helper( void *p ) {
+
+   Run_Job( (struct Pool_Job*) p );
+   Release_Job( (struct Pool_Job*) p );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static void *Worker( void *p )                                            //
+//                                                                            //
+//  Description:                                                              //
+//     The loop of a worker thread: run helpers from its own deque, else      //
+//     steal, else spin for a while and then sleep until work is offered.     //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static void *Worker( void *p ) {
+
+   struct Pool_Job *job;
+   unsigned seed;
+   unsigned epoch;
+   int spins = 0;
+
+   worker_id = (int) (long) p;
+   seed = 2654435761u * (unsigned) (worker_id + 1);
+   while ( !atomic_load( &pool.stop ) ) {
+      epoch = atomic_load( &pool.epoch );
+      if ( (job = Find_Work( worker_id, &seed )) != NULL ) {
+         Run_Job( job );
+         Release_Job( job );
+         spins = 0;
+         continue;
+      }
+      if (++spins < SPIN_ROUNDS) { sched_yield(); continue; }
+      atomic_fetch_add( &pool.sleepers, 1 );
+      pthread_mutex_lock( &pool.sleep_lock );
+      while ( atomic_load( &pool.epoch ) == epoch
+                                            && !atomic_load( &pool.stop ) )
+         pthread_cond_wait( &pool.wake, &pool.sleep_lock );
+      pthread_mutex_unlock( &pool.sleep_lock );
+      atomic_fetch_sub( &pool.sleepers, 1 );
+      spins = 0;
+   }
+   return NULL;
+}
+
+
+static struct Pool_Job *Find_Work( int self, unsigned *seed ) {
+
+   struct Pool_Job *job;
+   int k, victim;
+   int deques = pool.workers + 1;
+
+   if ( (job = Pop( &pool.deque[self] )) != NULL ) return job;
+   if ( (job = Steal( &pool.deque[pool.workers] )) != NULL ) return job;
+   victim = (int) ((*seed = *seed * 1103515245u + 12345u) >> 16) % deques;
+   for (k = 0; k < deques; k++, victim = (victim + 1) % deques)
+      if (victim != self && (job = Steal( &pool.deque[victim] )) != NULL)
+         return job;
+   return NULL;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  The Chase-Lev deque.  Push() and Pop() are called by the owner only,      //
+//  Steal() by any thread.  Push() returns -1 if the deque is full.           //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static int Push( struct Deque *d, struct Pool_Job *job ) {
+
+   long b = atomic_load_explicit( &d->bottom, memory_order_relaxed );
+   long t = atomic_load_explicit( &d->top, memory_order_acquire );
+
+   if (b - t >= DEQUE_CAPACITY) return -1;
+   atomic_store_explicit( &d->buffer[b & (DEQUE_CAPACITY - 1)], job,
+                                                      memory_order_relaxed );
+   atomic_thread_fence( memory_order_release );
+   atomic_store_explicit( &d->bottom, b + 1, memory_order_relaxed );
+   return 0;
+}
+
+
+static struct Pool_Job *Pop( struct Deque *d ) {
+
+   long b = atomic_load_explicit( &d->bottom, memory_order_relaxed ) - 1;
+   long t;
+   struct Pool_Job *job = NULL;
+
+   atomic_store_explicit( &d->bottom, b, memory_order_relaxed );
+   atomic_thread_fence( memory_order_seq_cst );
+   t = atomic_load_explicit( &d->top, memory_order_relaxed );
+   if (t <= b) {
+      job = atomic_load_explicit( &d->buffer[b & (DEQUE_CAPACITY - 1)],
+                                                      memory_order_relaxed );
+      if (t == b) {
+         if ( !atomic_compare_exchange_strong_explicit( &d->top, &t, t + 1,
+                             memory_order_seq_cst, memory_order_relaxed ) )
+            job = NULL;
+         atomic_store_explicit( &d->bottom, b + 1, memory_order_relaxed );
+      }
+   }
+   else atomic_store_explicit( &d->bottom, b + 1, memory_order_relaxed );
+   return job;
+}
+
+
+static struct Pool_Job *Steal( struct Deque *d ) {
+
+   long t = atomic_load_explicit( &d->top, memory_order_acquire );
+   long b;
+   struct Pool_Job *job;
+
+   atomic_thread_fence( memory_order_seq_cst );
+   b = atomic_load_explicit( &d->bottom, memory_order_acquire );
+   if (t >= b) return NULL;
+   job = atomic_load_explicit( &d->buffer[t & (DEQUE_CAPACITY - 1)],
+                                                      memory_order_relaxed );
+   if ( !atomic_compare_exchange_strong_explicit( &d->top, &t, t + 1,
+                             memory_order_seq_cst, memory_order_relaxed ) )
+      return NULL;
+   return job;
+}
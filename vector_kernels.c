@@ -0,0 +1,280 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: vector_kernels.c                                                     //
+// Routines:                                                                  //
+//    Vector_Alloc                                                            //
+//    Vector_Free                                                             //
+//    Vector_Copy                                                             //
+//    Vector_Scale_Add                                                        //
+//    Vector_Linear_Combination                                               //
+//    Vector_Kernel_Bytes                                                     //
+//    Vector_Kernel_Reset_Bytes                                               //
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Description:                                                              //
+//     Vector operations for the system versions of the Runge-Kutta and the   //
+//     Adams methods when the state vector is so large that each stage        //
+//     combination is limited by memory bandwidth rather than by arithmetic.  //
+//                                                                            //
+//     If compiled with OpenMP (e.g. gcc -fopenmp) each loop is divided into  //
+//     equal contiguous blocks, one per thread, using the static schedule.    //
+//     Vector_Alloc() initializes the vector using the same schedule so that  //
+//     on a NUMA machine each page is first touched, and hence placed, on     //
+//     the node of the thread which will later read and write it.  Vectors    //
+//     with fewer than PARALLEL_THRESHOLD elements are processed by the       //
+//     calling thread alone, and so are all vectors if the routine is called  //
+//     from a body of Thread_Pool_Parallel_For(), see thread_pool.c, e.g. by  //
+//     the steppers of operator_splitting.c, whose threads would otherwise    //
+//     each start an OpenMP team.  Without OpenMP the pragmas are ignored and //
+//     the routines are serial.                                               //
+//                                                                            //
+//     Vector_Linear_Combination() forms z = y + a[0]*v[0] + ... + a[m-1]*    //
+//     v[m-1] in a single pass, reading each vector once and writing z once,  //
+//     rather than m separate passes through memory.  The vectors are         //
+//     processed in blocks of BLOCK_SIZE elements: the block of the sum is    //
+//     accumulated in a small array which stays in the level 1 cache while    //
+//     four vectors at a time are added to it, so that only a few memory      //
+//     streams are active however many terms there are.  If z is longer than  //
+//     NONTEMPORAL_THRESHOLD elements and aligned on a 16 byte boundary, the  //
+//     completed block is written with non-temporal (streaming) stores when   //
+//     compiled for SSE2, so that z does not evict the vectors still to be    //
+//     read from the cache.                                                   //
+//                                                                            //
+//     The number of bytes read and written by the routines is accumulated so //
+//     that a benchmark can report the bandwidth achieved.  The count is kept //
+//     per thread, so that the routines may be called concurrently, e.g. by   //
+//     the Verner steppers of the cells of operator_splitting.c, and counts   //
+//     the calls made by the calling thread only.                             //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>                      // required for posix_memalign(), free()
+#include <stdint.h>                      // required for uintptr_t
+#ifdef __SSE2__
+#include <emmintrin.h>                   // required for _mm_stream_pd()
+#endif
+
+#define PARALLEL_THRESHOLD 32768
+#define PARALLEL(n) ((n) >= PARALLEL_THRESHOLD && !Thread_Pool_In_Parallel())
+#define NONTEMPORAL_THRESHOLD 1048576
+#define BLOCK_SIZE 512
+#define ALIGNMENT 64
+
+static __thread double bytes_moved = 0.0;  // per thread, see above
+
+int Thread_Pool_In_Parallel( void );
+static void Block_Combination( double * restrict acc, double y[], double a[],
+                                      double *v[], int m, int lo, int len );
+
+////////////////////////////////////////////////////////////////////////////////
+//  double* Vector_Alloc( int n )                                             //
+//                                                                            //
+//  Description:                                                              //
+//     Allocates a vector of n doubles aligned on a 64 byte boundary and sets //
+//     it to zero using the same division of work among threads as the other  //
+//     routines of this file.                                                 //
+//                                                                            //
+//  Arguments:                                                                //
+//     int n  The number of elements.                                         //
+//                                                                            //
+//  Return Values:                                                            //
+//     A pointer to the vector or NULL if memory could not be allocated.      //
+//     The vector must be released with Vector_Free().                        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double* Vector_Alloc( int n ) {
+
+   void *p;
+   double *v;
+   int i;
+
+   if ( posix_memalign(&p, ALIGNMENT, (size_t) n * sizeof(double)) )
+      return NULL;
+   v = (double*) p;
+
+   #pragma omp parallel for schedule(static) if (PARALLEL(n))
+   for (i = 0; i < n; i++) v[i] = 0.0;
+
+   return v;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Vector_Free( double v[] )                                            //
+//                                                                            //
+//  Description:                                                              //
+//     Releases a vector allocated by Vector_Alloc().                         //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Vector_Free( double v[] ) {
+
+   free(v);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Vector_Copy( double z[], double y[], int n )                         //
+//                                                                            //
+//  Description:                                                              //
+//     Sets z[i] = y[i], i = 0,...,n-1.                                       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Vector_Copy( double z[], double y[], int n ) {
+
+   int i;
+
+   #pragma omp parallel for schedule(static) if (PARALLEL(n))
+   for (i = 0; i < n; i++) z[i] = y[i];
+
+   bytes_moved += 2.0 * sizeof(double) * n;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Vector_Scale_Add( double y[], double a, double v[], int n )          //
+//                                                                            //
+//  Description:                                                              //
+//     Sets y[i] = y[i] + a * v[i], i = 0,...,n-1.                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Vector_Scale_Add( double y[], double a, double v[], int n ) {
+
+   int i;
+
+   #pragma omp parallel for schedule(static) if (PARALLEL(n))
+   for (i = 0; i < n; i++) y[i] += a * v[i];
+
+   bytes_moved += 3.0 * sizeof(double) * n;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Vector_Linear_Combination( double z[], double y[], double a[],       //
+//                                                double *v[], int m, int n ) //
+//                                                                            //
+//  Description:                                                              //
+//     Sets z[i] = y[i] + a[0] * v[0][i] + ... + a[m-1] * v[m-1][i],          //
+//     i = 0,...,n-1, in a single pass.                                       //
+//                                                                            //
+//  Arguments:                                                                //
+//     double z[]   The result.  z[] may be the same array as y[] but must    //
+//                  not be one of the v[k].                                   //
+//     double y[]   The base vector.                                          //
+//     double a[]   The m coefficients.                                       //
+//     double *v[]  The m vectors.                                            //
+//     int    m     The number of terms, m >= 0.                              //
+//     int    n     The dimension of the vectors.                             //
+//                                                                            //
+//  Return Values:                                                            //
+//     none                                                                   //
+//                                                                            //
+//  Example:                                                                  //
+//     double *v[2] = { k1, k2 };                                             //
+//     double a[2] = { 0.25 * h, 0.25 * h };                                  //
+//                                                                            //
+//     Vector_Linear_Combination( ytmp, y, a, v, 2, n );                      //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Vector_Linear_Combination( double z[], double y[], double a[],
+                                                  double *v[], int m, int n ) {
+
+   double acc[BLOCK_SIZE];
+   int nblocks = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+   int streaming = 0;
+   int b, i, lo, len;
+
+#ifdef __SSE2__
+   streaming = (n >= NONTEMPORAL_THRESHOLD) && ( ((uintptr_t) z & 15) == 0 );
+#endif
+
+   #pragma omp parallel for schedule(static) private(acc, i, lo, len) \
+                                                               if (PARALLEL(n))
+   for (b = 0; b < nblocks; b++) {
+      lo = b * BLOCK_SIZE;
+      len = (n - lo < BLOCK_SIZE) ? n - lo : BLOCK_SIZE;
+      Block_Combination( acc, y, a, v, m, lo, len );
+#ifdef __SSE2__
+      if (streaming) {
+         for (i = 0; i + 1 < len; i += 2)
+            _mm_stream_pd( &z[lo+i], _mm_loadu_pd(&acc[i]) );
+         for (; i < len; i++) z[lo+i] = acc[i];
+         continue;
+      }
+#endif
+      for (i = 0; i < len; i++) z[lo+i] = acc[i];
+   }
+#ifdef __SSE2__
+   if (streaming) _mm_sfence();
+#endif
+
+   bytes_moved += (double) (m + 2) * sizeof(double) * n;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static void Block_Combination( double *acc, double y[], double a[],       //
+//                              double *v[], int m, int lo, int len )         //
+//                                                                            //
+//  Description:                                                              //
+//     Sets acc[i] = y[lo+i] + a[0] * v[0][lo+i] + ... + a[m-1] * v[m-1][lo+i]//
+//     for i = 0,...,len-1, adding four vectors per pass through acc[].       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static void Block_Combination( double * restrict acc, double y[], double a[],
+                                       double *v[], int m, int lo, int len ) {
+
+   const double *v0, *v1, *v2, *v3;
+   double a0, a1, a2, a3;
+   int i, k;
+
+   for (i = 0; i < len; i++) acc[i] = y[lo+i];
+
+   for (k = 0; k + 3 < m; k += 4) {
+      v0 = v[k] + lo; v1 = v[k+1] + lo; v2 = v[k+2] + lo; v3 = v[k+3] + lo;
+      a0 = a[k]; a1 = a[k+1]; a2 = a[k+2]; a3 = a[k+3];
+      #pragma omp simd
+      for (i = 0; i < len; i++)
+         acc[i] += a0 * v0[i] + a1 * v1[i] + a2 * v2[i] + a3 * v3[i];
+   }
+   for (; k < m; k++) {
+      v0 = v[k] + lo;
+      a0 = a[k];
+      #pragma omp simd
+      for (i = 0; i < len; i++) acc[i] += a0 * v0[i];
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  double Vector_Kernel_Bytes( void )                                        //
+//                                                                            //
+//  Description:                                                              //
+//     Returns the number of bytes read and written by the vector routines    //
+//     called by this thread since its last call to                           //
+//     Vector_Kernel_Reset_Bytes().                                           //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double Vector_Kernel_Bytes( void ) {
+
+   return bytes_moved;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Vector_Kernel_Reset_Bytes( void )                                    //
+//                                                                            //
+//  Description:                                                              //
+//     Resets the count of bytes read and written by this thread to zero.     //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Vector_Kernel_Reset_Bytes( void ) {
+
+   bytes_moved = 0.0;
+}
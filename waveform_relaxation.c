@@ -0,0 +1,543 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: waveform_relaxation.c                                                //
+// Routines:                                                                  //
+//    Waveform_Relaxation_Create                                              //
+//    Waveform_Relaxation_Set_Subsystem                                       //
+//    Waveform_Relaxation_Value                                               //
+//    Waveform_Relaxation_Integrate                                           //
+//    Waveform_Relaxation_Free                                                //
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Description:                                                              //
+//     A system y' = f(x,y) which consists of p subsystems                    //
+//                                                                            //
+//                  y[k]' = f[k](x, y[0], ..., y[p-1]),  k = 0,...,p-1,       //
+//                                                                            //
+//     each weakly coupled to the others, may be solved by waveform           //
+//     relaxation.  The interval of integration is divided into windows, and  //
+//     on each window every subsystem is integrated by its own method and     //
+//     step size with the other subsystems replaced by their approximations,  //
+//     the waveforms, from the previous sweep; the sweeps are repeated until  //
+//     the waveforms converge.  The first sweep takes the other subsystems    //
+//     to be constant on the window.  In the Jacobi scheme all subsystems of  //
+//     a sweep use the waveforms of the previous sweep and are integrated in  //
+//     parallel.  In the Gauss-Seidel scheme subsystem k uses the waveforms   //
+//     of the current sweep for the subsystems 0,...,k-1, which converges     //
+//     faster but integrates the subsystems of a window one after the other.  //
+//                                                                            //
+//     A subsystem is integrated by a user supplied stepper, e.g. a single    //
+//     step of Runge_Kutta_Verner_System() or Gragg_Bulirsch_Stoer(), whose   //
+//     right hand side obtains the value of another subsystem at x by         //
+//     Waveform_Relaxation_Value().  The waveforms are interpolated by cubic  //
+//     polynomials through the four nearest steps of the subsystem.           //
+//                                                                            //
+//     If a tolerance is given the windows are integrated one after the       //
+//     other, each until the largest change of the waveforms between two      //
+//     sweeps is at most the tolerance.  Otherwise a fixed number of sweeps   //
+//     s is made on every window and the windows are pipelined: sweep j of    //
+//     a window starts from the end of sweep j of the previous window, so     //
+//     that sweep j of window i and sweep j + 1 of window i - 1 are made      //
+//     simultaneously and up to s windows are in progress, multiplying the    //
+//     parallelism by up to s.  In the Gauss-Seidel scheme the subsystems of  //
+//     the windows in progress are then also integrated in parallel.  The     //
+//     subsystems and windows are distributed among the threads by            //
+//     Thread_Pool_Parallel_For(), see thread_pool.c, so that the steppers    //
+//     must be safe to call concurrently.                                     //
+//                                                                            //
+//     Compile with -pthread.                                                 //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>                             // required for malloc()
+#include <string.h>                             // required for memcpy()
+#include <math.h>                               // required for fabs()
+
+int Thread_Pool_Parallel_For( int first, int last, int grain,
+                        void (*body)(int lo, int hi, void *arg), void *arg );
+
+struct Subsystem {
+   int (*step)(double, double, double[], int, void*);
+   void *context;
+   int n;                          // the number of components
+   int steps;                      // the number of steps per window
+   int offset;                     // of the components in y[]
+   int samples;                    // of the waveform in a window buffer
+};
+
+struct Waveform_Relaxation {
+   int subsystems;
+   int scheme;                     // 0 Jacobi, 1 Gauss-Seidel
+   int n;                          // the total number of components
+   struct Subsystem *sub;
+};
+
+struct WR_Job {
+   struct Waveform_Relaxation *w;
+   double *waveform[2];            // of the window, by the parity of the sweep
+   double *start;                  // the initial values of the window
+   double x;                       // the start of the window
+   double h;                       // the length of the window
+   int sweep;
+   int k;                          // the subsystem
+   double change;                  // the largest change of its waveform
+   int err;
+};
+
+struct WR_Tick {
+   struct WR_Job *job;
+   int first_subsystem;            // the jobs are job[i * p + k],
+   int subsystems;                 // first_subsystem <= k < first + subsystems
+};
+
+static __thread struct WR_Job *current_job = NULL;
+
+static void Run_Jobs( int lo, int hi, void *arg );
+static void Integrate_Subsystem( struct WR_Job *job );
+static int Sweep( struct Waveform_Relaxation *w, struct WR_Job job[],
+                                                              int windows );
+static void Start_Window( struct Waveform_Relaxation *w, struct WR_Job *job,
+                                        double x, double h, int sweep,
+                                        double *waveform[], double *start,
+                                        double *y_start, int initial_guess );
+void Waveform_Relaxation_Free( struct Waveform_Relaxation *w );
+
+////////////////////////////////////////////////////////////////////////////////
+//  struct Waveform_Relaxation* Waveform_Relaxation_Create( int subsystems,   //
+//                                     int n[], int scheme, int *err )        //
+//                                                                            //
+//  Description:                                                              //
+//     Creates a waveform relaxation of a system of the given number of       //
+//     subsystems, whose steppers are then defined by                         //
+//     Waveform_Relaxation_Set_Subsystem().  The components of subsystem k    //
+//     follow those of subsystem k - 1 in y[].                                //
+//                                                                            //
+//  Arguments:                                                                //
+//     int    subsystems  The number of subsystems p, at least 1.             //
+//     int    n[]         n[k] is the number of components of subsystem k.    //
+//     int    scheme      0 for Jacobi, 1 for Gauss-Seidel sweeps.            //
+//     int    *err        0 if successful, -2 if memory could not be          //
+//                        allocated and -3 if an argument is invalid.         //
+//                                                                            //
+//  Return Values:                                                            //
+//     A pointer to the waveform relaxation, which must be released with      //
+//     Waveform_Relaxation_Free(), or NULL if an error occurred.              //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+struct Waveform_Relaxation* Waveform_Relaxation_Create( int subsystems,
+                                             int n[], int scheme, int *err ) {
+
+   struct Waveform_Relaxation *w;
+   int k;
+
+   *err = -3;
+   if (subsystems < 1 || scheme < 0 || scheme > 1) return NULL;
+   for (k = 0; k < subsystems; k++) if (n[k] < 1) return NULL;
+   *err = -2;
+   w = (struct Waveform_Relaxation*)
+                               malloc( sizeof(struct Waveform_Relaxation) );
+   if (w == NULL) return NULL;
+   w->sub = (struct Subsystem*) malloc( subsystems * sizeof(struct Subsystem) );
+   if (w->sub == NULL) { free(w); return NULL; }
+   w->subsystems = subsystems;
+   w->scheme = scheme;
+   w->n = 0;
+   for (k = 0; k < subsystems; k++) {
+      w->sub[k].step = NULL;
+      w->sub[k].context = NULL;
+      w->sub[k].n = n[k];
+      w->sub[k].steps = 1;
+      w->sub[k].offset = w->n;
+      w->n += n[k];
+   }
+   *err = 0;
+   return w;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Waveform_Relaxation_Set_Subsystem( struct Waveform_Relaxation *w,     //
+//            int k, int (*step)(double x, double h, double y[], int n,       //
+//                              void *context), void *context, int steps )    //
+//                                                                            //
+//  Description:                                                              //
+//     Defines the stepper of subsystem k, which advances its components y[]  //
+//     from x to x + h by step(x, h, y, n, context), returning 0 if           //
+//     successful or a nonzero error code which is then returned by           //
+//     Waveform_Relaxation_Integrate().  Each window is covered in the given  //
+//     number of equal steps.                                                 //
+//                                                                            //
+//  Arguments:                                                                //
+//     struct Waveform_Relaxation *w  The waveform relaxation.                //
+//     int    k          The subsystem, 0 <= k < p.                           //
+//     int    (*step)()  The stepper.                                         //
+//     void   *context   Its last argument.                                   //
+//     int    steps      The number of steps per window, at least 1.          //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -3 if an argument is invalid.                         //
+//                                                                            //
+//  Example:                                                                  //
+//     Two pendulums coupled by a weak spring, each integrated by the         //
+//     Runge-Kutta-Verner method,                                             //
+//                                                                            //
+//     static void pendulum(double x, double y[], double dy[], int k) {       //
+//        double other[2];                                                    //
+//                                                                            //
+//        Waveform_Relaxation_Value( 1 - k, x, other );                       //
+//        dy[0] = y[1];                                                       //
+//        dy[1] = -sin(y[0]) + 0.01 * (other[0] - y[0]);                      //
+//     }                                                                      //
+//     static void f0(double x, double y[], double dy[]) {                    //
+//        pendulum(x, y, dy, 0);                                              //
+//     }                                                                      //
+//     static void f1(double x, double y[], double dy[]) {                    //
+//        pendulum(x, y, dy, 1);                                              //
+//     }                                                                      //
+//     static int step(double x, double h, double y[], int n, void *f) {      //
+//        double work[16];                                                    //
+//                                                                            //
+//        Runge_Kutta_Verner_System( f, y, n, x, h, 1, work );                //
+//        return 0;                                                           //
+//     }                                                                      //
+//                                                                            //
+//     int n[] = { 2, 2 };                                                    //
+//     w = Waveform_Relaxation_Create( 2, n, 0, &err );                       //
+//     Waveform_Relaxation_Set_Subsystem( w, 0, step, f0, 20 );               //
+//     Waveform_Relaxation_Set_Subsystem( w, 1, step, f1, 50 );               //
+//     err = Waveform_Relaxation_Integrate( w, y, 0.0, 1.0, 100, 4, 0.0 );    //
+//     Waveform_Relaxation_Free( w );                                         //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Waveform_Relaxation_Set_Subsystem( struct Waveform_Relaxation *w, int k,
+                         int (*step)(double, double, double[], int, void*),
+                                               void *context, int steps ) {
+
+   if (k < 0 || k >= w->subsystems || step == NULL || steps < 1) return -3;
+   w->sub[k].step = step;
+   w->sub[k].context = context;
+   w->sub[k].steps = steps;
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Waveform_Relaxation_Value( int k, double x, double v[] )             //
+//                                                                            //
+//  Description:                                                              //
+//     Sets v[] to the waveform of subsystem k at x, as seen by the subsystem //
+//     being integrated.  It may only be called from a right hand side        //
+//     evaluated by a stepper, on the thread which called the stepper, and x  //
+//     should lie in the current window; outside of it the waveform is        //
+//     extrapolated.                                                          //
+//                                                                            //
+//  Arguments:                                                                //
+//     int    k     The subsystem.                                            //
+//     double x     The value of the independent variable.                    //
+//     double v[]   On output the n[k] components of subsystem k at x.        //
+//                                                                            //
+//  Return Values:                                                            //
+//     The type is void.                                                      //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Waveform_Relaxation_Value( int k, double x, double v[] ) {
+
+   struct WR_Job *job = current_job;
+   struct Subsystem *sub = &job->w->sub[k];
+   double *u;
+   double weight[4];
+   double t;
+   int parity, first, points, i, j, c;
+
+   parity = (job->w->scheme == 1 && k < job->k) ? job->sweep & 1
+                                               : (job->sweep + 1) & 1;
+   u = job->waveform[parity] + sub->samples;
+
+             // Lagrange interpolation through the nearest points. //
+
+   t = (x - job->x) * sub->steps / job->h;
+   points = (sub->steps < 3) ? sub->steps + 1 : 4;
+   first = (int) floor(t) - 1;
+   if (first > sub->steps + 1 - points) first = sub->steps + 1 - points;
+   if (first < 0) first = 0;
+   for (i = 0; i < points; i++) {
+      weight[i] = 1.0;
+      for (j = 0; j < points; j++)
+         if (j != i) weight[i] *= (t - first - j) / (double) (i - j);
+   }
+   for (c = 0; c < sub->n; c++) {
+      v[c] = 0.0;
+      for (i = 0; i < points; i++)
+         v[c] += weight[i] * u[(first + i) * sub->n + c];
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  int Waveform_Relaxation_Integrate( struct Waveform_Relaxation *w,         //
+//               double y[], double x0, double h, int number_of_windows,      //
+//                                      int sweeps, double tolerance )        //
+//                                                                            //
+//  Description:                                                              //
+//     Integrates the system from x0 over number_of_windows windows of        //
+//     length h.  If tolerance > 0 each window is swept until the largest     //
+//     change of a waveform between two sweeps is at most the tolerance, at   //
+//     most sweeps times.  If tolerance <= 0 each window is swept exactly     //
+//     sweeps times and the windows are pipelined.                            //
+//                                                                            //
+//  Arguments:                                                                //
+//     struct Waveform_Relaxation *w  The waveform relaxation.                //
+//     double y[]   On input y(x0), on output y(x0 + number_of_windows * h),  //
+//                  the components of all subsystems.                         //
+//     double x0    The initial value of x.                                   //
+//     double h     The length of a window.                                   //
+//     int    number_of_windows  The number of windows.                       //
+//     int    sweeps     The (maximum) number of sweeps per window, at least  //
+//                       2 if tolerance > 0 since the change is measured      //
+//                       between two sweeps.                                  //
+//     double tolerance  The convergence tolerance, or 0.                     //
+//                                                                            //
+//  Return Values:                                                            //
+//     0 if successful, -1 if a window did not converge within the given      //
+//     number of sweeps, -2 if memory could not be allocated, -3 if a         //
+//     subsystem has not been set, sweeps < 1 or sweeps < 2 with a tolerance, //
+//     otherwise the first nonzero value returned by a stepper.  If -1 or an  //
+//     error of a stepper is returned with a tolerance, y[] is the solution   //
+//     at the beginning of the window which failed.                           //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+int Waveform_Relaxation_Integrate( struct Waveform_Relaxation *w,
+                   double y[], double x0, double h, int number_of_windows,
+                                           int sweeps, double tolerance ) {
+
+   struct WR_Job *job;
+   double *buffer, *waveform[2], *start, *previous;
+   double change;
+   int p = w->subsystems;
+   int slots = (tolerance > 0.0) ? 1 : sweeps;
+   int samples, slot_size, tick, i, j, k, s, first, last, err = 0;
+
+   if (sweeps < 1 || (tolerance > 0.0 && sweeps < 2)) return -3;
+   for (samples = 0, k = 0; k < p; k++) {
+      if (w->sub[k].step == NULL) return -3;
+      w->sub[k].samples = samples;
+      samples += (w->sub[k].steps + 1) * w->sub[k].n;
+   }
+   if (number_of_windows < 1) return 0;
+
+         // Each window in progress has two waveforms and its initial values. //
+
+   slot_size = 2 * samples + w->n;
+   buffer = (double*) malloc( slots * slot_size * sizeof(double) );
+   job = (struct WR_Job*) malloc( slots * p * sizeof(struct WR_Job) );
+   if (buffer == NULL || job == NULL) { free(buffer); free(job); return -2; }
+
+   if (tolerance > 0.0) {
+      waveform[0] = buffer;
+      waveform[1] = buffer + samples;
+      start = buffer + 2 * samples;
+      for (i = 0; i < number_of_windows; i++) {
+         for (s = 0; s < sweeps; s++) {
+            Start_Window( w, job, x0 + i * h, h, s, waveform, start, y,
+                                                                   s == 0 );
+            if ( (err = Sweep( w, job, 1 )) != 0 ) break;
+            for (change = 0.0, k = 0; k < p; k++)
+               if (job[k].change > change) change = job[k].change;
+            if (s > 0 && change <= tolerance) break;
+         }
+         if (err == 0 && s == sweeps) err = -1;
+         if (err != 0) break;
+         for (k = 0; k < p; k++)
+            memcpy( y + w->sub[k].offset, waveform[s & 1] + w->sub[k].samples
+                        + w->sub[k].steps * w->sub[k].n,
+                                             w->sub[k].n * sizeof(double) );
+      }
+      free(buffer);
+      free(job);
+      return err;
+   }
+
+                // Window i makes sweep s = tick - i at each tick. //
+
+   for (tick = 0; tick < number_of_windows + sweeps - 1; tick++) {
+      first = (tick < sweeps) ? 0 : tick - sweeps + 1;
+      last = (tick < number_of_windows) ? tick : number_of_windows - 1;
+      for (i = first; i <= last; i++) {
+         j = i % slots;
+         waveform[0] = buffer + j * slot_size;
+         waveform[1] = waveform[0] + samples;
+         start = waveform[0] + 2 * samples;
+         if (i == 0) previous = y;
+         else {
+            previous = buffer + ((i - 1) % slots) * slot_size
+                                          + ((tick - i) & 1) * samples;
+            for (k = 0; k < p; k++)
+               memcpy( start + w->sub[k].offset, previous + w->sub[k].samples
+                        + w->sub[k].steps * w->sub[k].n,
+                                             w->sub[k].n * sizeof(double) );
+            previous = start;
+         }
+         Start_Window( w, job + (i - first) * p, x0 + i * h, h, tick - i,
+                                 waveform, start, previous, tick == i );
+      }
+      if ( (err = Sweep( w, job, last - first + 1 )) != 0 ) break;
+   }
+   if (err == 0) {
+      waveform[0] = buffer + ((number_of_windows - 1) % slots) * slot_size
+                                                 + ((sweeps - 1) & 1) * samples;
+      for (k = 0; k < p; k++)
+         memcpy( y + w->sub[k].offset, waveform[0] + w->sub[k].samples
+                    + w->sub[k].steps * w->sub[k].n,
+                                             w->sub[k].n * sizeof(double) );
+   }
+   free(buffer);
+   free(job);
+   return err;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  void Waveform_Relaxation_Free( struct Waveform_Relaxation *w )            //
+//                                                                            //
+//  Description:                                                              //
+//     Releases a waveform relaxation created by                              //
+//     Waveform_Relaxation_Create().                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+void Waveform_Relaxation_Free( struct Waveform_Relaxation *w ) {
+
+   if (w == NULL) return;
+   free(w->sub);
+   free(w);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static void Start_Window( struct Waveform_Relaxation *w,                  //
+//        struct WR_Job *job, double x, double h, int sweep,                  //
+//        double *waveform[], double *start, double *y_start,                 //
+//                                                   int initial_guess )      //
+//                                                                            //
+//  Description:                                                              //
+//     Prepares the jobs of the p subsystems of a sweep of the window from x  //
+//     to x + h, whose initial values are y_start[].  If initial_guess is     //
+//     nonzero the waveforms of the previous sweep are set to the constant    //
+//     initial values.                                                        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static void Start_Window( struct Waveform_Relaxation *w, struct WR_Job *job,
+                                        double x, double h, int sweep,
+                                        double *waveform[], double *start,
+                                        double *y_start, int initial_guess ) {
+
+   struct Subsystem *sub;
+   double *u;
+   int i, k;
+
+   if (start != y_start) memcpy( start, y_start, w->n * sizeof(double) );
+   for (k = 0; k < w->subsystems; k++) {
+      job[k].w = w;
+      job[k].waveform[0] = waveform[0];
+      job[k].waveform[1] = waveform[1];
+      job[k].start = start;
+      job[k].x = x;
+      job[k].h = h;
+      job[k].sweep = sweep;
+      job[k].k = k;
+      if (initial_guess) {
+         sub = &w->sub[k];
+         u = waveform[(sweep + 1) & 1] + sub->samples;
+         for (i = 0; i <= sub->steps; i++)
+            memcpy( u + i * sub->n, start + sub->offset,
+                                                  sub->n * sizeof(double) );
+      }
+   }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static int Sweep( struct Waveform_Relaxation *w, struct WR_Job job[],     //
+//                                                            int windows )   //
+//                                                                            //
+//  Description:                                                              //
+//     Runs the jobs of the given number of windows, job[i * p + k] being     //
+//     subsystem k of the i-th window, and returns the first nonzero error    //
+//     of a stepper or 0.  For the Jacobi scheme all jobs run in parallel,    //
+//     for the Gauss-Seidel scheme the jobs of each subsystem in turn.        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static int Sweep( struct Waveform_Relaxation *w, struct WR_Job job[],
+                                                               int windows ) {
+
+   struct WR_Tick tick;
+   int p = w->subsystems;
+   int i;
+
+   tick.job = job;
+   if (w->scheme == 0) {
+      tick.first_subsystem = 0;
+      tick.subsystems = p;
+      Thread_Pool_Parallel_For( 0, windows * p, 1, Run_Jobs, &tick );
+   }
+   else
+      for (tick.subsystems = 1, i = 0; i < p; i++) {
+         tick.first_subsystem = i;
+         Thread_Pool_Parallel_For( 0, windows, 1, Run_Jobs, &tick );
+      }
+   for (i = 0; i < windows * p; i++) if (job[i].err) return job[i].err;
+   return 0;
+}
+
+
+static void Run_Jobs( int lo, int hi, void *arg ) {
+
+   struct WR_Tick *tick = (struct WR_Tick*) arg;
+   int p = tick->job[0].w->subsystems;
+   int i;
+
+   for (i = lo; i < hi; i++)
+      Integrate_Subsystem( tick->job + (i / tick->subsystems) * p
+                              + tick->first_subsystem + i % tick->subsystems );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  static void Integrate_Subsystem( struct WR_Job *job )                     //
+//                                                                            //
+//  Description:                                                              //
+//     Integrates a subsystem over its window, storing each step in the       //
+//     waveform of the current sweep and the largest change from the          //
+//     waveform of the previous sweep in job->change.                         //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+static void Integrate_Subsystem( struct WR_Job *job ) {
+
+   struct Subsystem *sub = &job->w->sub[job->k];
+   struct WR_Job *caller = current_job;
+   double *u = job->waveform[job->sweep & 1] + sub->samples;
+   double *old = job->waveform[(job->sweep + 1) & 1] + sub->samples;
+   double dx = job->h / sub->steps;
+   int n = sub->n;
+   int i;
+
+   current_job = job;
+   job->err = 0;
+   job->change = 0.0;
+   memcpy( u, job->start + sub->offset, n * sizeof(double) );
+   for (i = 0; i < sub->steps; i++) {
+      memcpy( u + (i + 1) * n, u + i * n, n * sizeof(double) );
+      job->err = (*sub->step)(job->x + i * dx, dx, u + (i + 1) * n, n,
+                                                                sub->context);
+      if (job->err) break;
+   }
+   for (i = 0; i < (sub->steps + 1) * n; i++)
+      if (fabs(u[i] - old[i]) > job->change) job->change = fabs(u[i] - old[i]);
+   current_job = caller;
+}
@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: weighted_rms_norm.c                                                  //
+// Routines:                                                                  //
+//    Weighted_RMS_Norm                                                       //
+//    Weighted_RMS_Error_Norm                                                 //
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Description:                                                              //
+//     The error control of an adaptive method for a system of differential   //
+//     equations y' = f(x,y), y an n-vector, compares an error estimate e[i]  //
+//     for each component with a per-component tolerance                      //
+//                tol[i] = atol[i] + rtol[i] * max( |y0[i]|, |y1[i]| ),       //
+//     where y0 is the solution at the start of the step and y1 the solution  //
+//     at the end of the step.  The weighted root-mean-square norm            //
+//                || e || = sqrt( (1/n) Sum (e[i] / tol[i])^2 )               //
+//     is then compared with 1; a step is acceptable if || e || <= 1.         //
+//                                                                            //
+//     A component for which only a loose tolerance is needed no longer       //
+//     forces the tightest tolerance on every other component.                //
+//                                                                            //
+//     The routines below compute the scale, the ratio and the sum of squares //
+//     in a single pass over the vectors with no intermediate arrays so that  //
+//     the loop can be vectorized by the compiler.                            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+#include <math.h>                               // required for sqrt(), fabs()
+
+////////////////////////////////////////////////////////////////////////////////
+//  double Weighted_RMS_Norm( double e[], double y0[], double y1[],           //
+//                                double atol[], double rtol[], int n )       //
+//                                                                            //
+//  Description:                                                              //
+//     Returns the weighted root-mean-square norm of the error estimate e[]   //
+//     as described above.                                                    //
+//                                                                            //
+//  Arguments:                                                                //
+//     double e[]     The error estimate of each component.                   //
+//     double y0[]    The solution at the start of the step.                  //
+//     double y1[]    The solution at the end of the step.                    //
+//     double atol[]  The absolute tolerance of each component.               //
+//     double rtol[]  The relative tolerance of each component.               //
+//     int    n       The number of components, n > 0.                        //
+//                                                                            //
+//  Return Values:                                                            //
+//     The weighted root-mean-square norm.  If for some component both        //
+//     atol[i] and rtol[i] * max(|y0[i]|,|y1[i]|) are zero, the result is     //
+//     infinite (or NaN if also e[i] = 0).                                    //
+//                                                                            //
+//  Example:                                                                  //
+//     #define N 3                                                            //
+//     double e[N], y0[N], y1[N];                                             //
+//     double atol[N] = {1.e-10, 1.e-10, 1.e-4};                              //
+//     double rtol[N] = {1.e-8, 1.e-8, 0.0};                                  //
+//                                                                            //
+//     (compute the step and its error estimate e[])                          //
+//     if ( Weighted_RMS_Norm(e, y0, y1, atol, rtol, N) <= 1.0 ) accept;      //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double Weighted_RMS_Norm( double e[], double y0[], double y1[], double atol[],
+                                                       double rtol[], int n ) {
+
+   double sum = 0.0;
+   double scale;
+   double ratio;
+   int i;
+
+   for (i = 0; i < n; i++) {
+      scale = atol[i] + rtol[i] * fmax( fabs(y0[i]), fabs(y1[i]) );
+      ratio = e[i] / scale;
+      sum += ratio * ratio;
+   }
+   return sqrt( sum / (double) n );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//  double Weighted_RMS_Error_Norm( double y_new[], double y_old[],           //
+//                double y0[], double atol[], double rtol[], int n )          //
+//                                                                            //
+//  Description:                                                              //
+//     Returns the weighted root-mean-square norm of the difference of two    //
+//     successive estimates y_new[] and y_old[] of the solution at the end of //
+//     a step starting from y0[].  The difference y_new[i] - y_old[i] is      //
+//     formed inside the same pass as the scale, so that an extrapolation     //
+//     method need not store the difference vector.                           //
+//                                                                            //
+//  Arguments:                                                                //
+//     double y_new[] The latest estimate of the solution at the end of the   //
+//                    step, this is the estimate used to form the scale.      //
+//     double y_old[] The previous estimate of the solution at the end of the //
+//                    step.                                                   //
+//     double y0[]    The solution at the start of the step.                  //
+//     double atol[]  The absolute tolerance of each component.               //
+//     double rtol[]  The relative tolerance of each component.               //
+//     int    n       The number of components, n > 0.                        //
+//                                                                            //
+//  Return Values:                                                            //
+//     The weighted root-mean-square norm of y_new[] - y_old[].               //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+double Weighted_RMS_Error_Norm( double y_new[], double y_old[], double y0[],
+                                   double atol[], double rtol[], int n ) {
+
+   double sum = 0.0;
+   double scale;
+   double ratio;
+   int i;
+
+   for (i = 0; i < n; i++) {
+      scale = atol[i] + rtol[i] * fmax( fabs(y0[i]), fabs(y_new[i]) );
+      ratio = (y_new[i] - y_old[i]) / scale;
+      sum += ratio * ratio;
+   }
+   return sqrt( sum / (double) n );
+}